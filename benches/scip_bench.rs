@@ -6,6 +6,7 @@
 /// - Full pipeline benchmarks at various scales
 /// - Mmap loading vs traditional read comparison
 /// - Parallel processing overhead measurement
+/// - Core scaling of the map-reduce ingest at 1-16 threads
 
 use criterion::{black_box, criterion_group, criterion_main, Criterion, BenchmarkId, Throughput};
 use std::fs::File;
@@ -136,6 +137,20 @@ fn bench_mmap_vs_read(c: &mut Criterion) {
         })
     });
 
+    // Benchmark the field-selective streaming decoder used by ingest
+    group.bench_function("mmap_stream", |b| {
+        b.iter(|| {
+            let file = File::open(&path).unwrap();
+            let mmap = unsafe { Mmap::map(&file) }.unwrap();
+            let mut occurrences = 0;
+            for document in mr_hedgehog::domain::scip_stream::documents(black_box(&mmap)) {
+                let view = mr_hedgehog::domain::scip_stream::DocumentView::decode(document.unwrap()).unwrap();
+                occurrences += view.occurrences.len();
+            }
+            occurrences
+        })
+    });
+
     group.finish();
 }
 
@@ -203,11 +218,49 @@ fn bench_reference_resolution(c: &mut Criterion) {
     group.finish();
 }
 
+// ═══════════════════════════════════════════════════════════════════════════
+// Thread Scaling Benchmarks
+// ═══════════════════════════════════════════════════════════════════════════
+
+fn bench_thread_scaling(c: &mut Criterion) {
+    let mut group = c.benchmark_group("scip_ingest/threads");
+    group.sample_size(20);
+
+    // Large enough that every thread gets many chunks of documents
+    let index = create_synthetic_scip_index(2000, 20, 40);
+    let (_dir, path) = write_scip_to_temp(&index);
+    group.throughput(Throughput::Elements(2000 * 20));
+
+    for threads in [1, 2, 4, 8, 16].iter() {
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(*threads)
+            .build()
+            .unwrap();
+
+        group.bench_with_input(
+            BenchmarkId::new("threads", threads),
+            &path,
+            |b, path| {
+                b.iter(|| {
+                    pool.install(|| {
+                        mr_hedgehog::domain::scip_ingest::ScipIngestor::ingest_and_build_graph(
+                            black_box(path)
+                        ).unwrap()
+                    })
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
 criterion_group!(
     benches, 
     bench_scip_full_pipeline, 
     bench_mmap_vs_read,
     bench_scaling,
-    bench_reference_resolution
+    bench_reference_resolution,
+    bench_thread_scaling
 );
 criterion_main!(benches);
@@ -0,0 +1,91 @@
+#include "daemonclient.h"
+
+#include <QJsonDocument>
+#include <QDebug>
+
+DaemonClient::DaemonClient(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QTcpSocket(this))
+{
+    connect(m_socket, &QTcpSocket::connected, this, &DaemonClient::connected);
+    connect(m_socket, &QTcpSocket::disconnected, this, [this]() {
+        // Outstanding requests will never be answered
+        m_pending.clear();
+        m_buffer.clear();
+        emit disconnected();
+    });
+    connect(m_socket, &QTcpSocket::readyRead, this, &DaemonClient::onReadyRead);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, &DaemonClient::onSocketError);
+}
+
+void DaemonClient::connectToDaemon(const QString &host, quint16 port)
+{
+    if (m_socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    m_socket->connectToHost(host, port);
+}
+
+bool DaemonClient::isConnected() const
+{
+    return m_socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void DaemonClient::disconnectFromDaemon()
+{
+    m_socket->disconnectFromHost();
+}
+
+void DaemonClient::send(const QString &command, const QJsonObject &params, ResponseHandler handler)
+{
+    QJsonObject request;
+    request["command"] = command;
+    if (!params.isEmpty()) {
+        request["params"] = params;
+    }
+
+    m_pending.enqueue(handler);
+    m_socket->write(QJsonDocument(request).toJson(QJsonDocument::Compact));
+    m_socket->write("\n");
+}
+
+void DaemonClient::onReadyRead()
+{
+    m_buffer.append(m_socket->readAll());
+
+    int newline;
+    while ((newline = m_buffer.indexOf('\n')) >= 0) {
+        QByteArray line = m_buffer.left(newline).trimmed();
+        m_buffer.remove(0, newline + 1);
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            qWarning() << "[Daemon] Malformed line:" << parseError.errorString();
+            continue;
+        }
+
+        QJsonObject obj = doc.object();
+        if (obj.contains("event")) {
+            emit eventReceived(obj);
+            continue;
+        }
+
+        if (m_pending.isEmpty()) {
+            qWarning() << "[Daemon] Unexpected response without a pending request";
+            continue;
+        }
+        ResponseHandler handler = m_pending.dequeue();
+        if (handler) {
+            handler(obj);
+        }
+    }
+}
+
+void DaemonClient::onSocketError(QAbstractSocket::SocketError)
+{
+    emit errorOccurred(m_socket->errorString());
+}
@@ -0,0 +1,48 @@
+#ifndef DAEMONCLIENT_H
+#define DAEMONCLIENT_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QQueue>
+#include <functional>
+
+// Line-delimited JSON client for the `mr_hedgehog --daemon` API.
+//
+// Requests are answered in order, so replies are matched to callbacks
+// through a FIFO. Lines carrying an "event" key are server pushes (e.g.
+// graph deltas from a watched workspace) and are emitted separately.
+class DaemonClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    using ResponseHandler = std::function<void(const QJsonObject &response)>;
+
+    explicit DaemonClient(QObject *parent = nullptr);
+
+    void connectToDaemon(const QString &host, quint16 port);
+    bool isConnected() const;
+    void disconnectFromDaemon();
+
+    // Send a command; `handler` receives the full {"status", "data"|"message"} reply
+    void send(const QString &command, const QJsonObject &params, ResponseHandler handler = nullptr);
+
+signals:
+    void connected();
+    void disconnected();
+    void errorOccurred(const QString &message);
+    void eventReceived(const QJsonObject &event);
+
+private slots:
+    void onReadyRead();
+    void onSocketError(QAbstractSocket::SocketError error);
+
+private:
+    QTcpSocket *m_socket;
+    QByteArray m_buffer;
+    QQueue<ResponseHandler> m_pending;
+};
+
+#endif // DAEMONCLIENT_H
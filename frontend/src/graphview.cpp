@@ -1,4 +1,5 @@
 #include "graphview.h"
+#include "daemonclient.h"
 
 #include <QFile>
 #include <QTextStream>
@@ -7,6 +8,12 @@
 #include <QRegularExpression>
 #include <QDebug>
 #include <QResizeEvent>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QFileInfo>
+#include <QDir>
+#include <QMenu>
+#include <QContextMenuEvent>
 #include <cmath>
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -111,6 +118,11 @@ GraphView::GraphView(QWidget *parent)
     : QGraphicsView(parent)
     , m_scene(nullptr)
     , m_placeholderText(nullptr)
+    , m_nextSlot(0)
+    , m_tileClient(nullptr)
+    , m_tileLevel(0)
+    , m_streamGeneration(0)
+    , m_tileTimer(nullptr)
     , m_animationTimer(nullptr)
 {
     setupScene();
@@ -129,6 +141,12 @@ GraphView::GraphView(QWidget *parent)
     // Frame style
     setFrameShape(QFrame::NoFrame);
     
+    // Coalesce pan/zoom bursts into one round of tile requests
+    m_tileTimer = new QTimer(this);
+    m_tileTimer->setSingleShot(true);
+    m_tileTimer->setInterval(50);
+    connect(m_tileTimer, &QTimer::timeout, this, &GraphView::requestVisibleTiles);
+    
     // Setup animation timer for hedgehogs (disabled)
     m_animationTimer = new QTimer(this);
     connect(m_animationTimer, &QTimer::timeout, this, &GraphView::updateHedgehogs);
@@ -191,6 +209,7 @@ void GraphView::updateHedgehogs()
 void GraphView::resizeEvent(QResizeEvent *event)
 {
     QGraphicsView::resizeEvent(event);
+    scheduleTileRequest();
     
     // Update hedgehog bounds when view resizes
     QRectF bounds = mapToScene(viewport()->rect()).boundingRect();
@@ -216,18 +235,7 @@ void GraphView::loadDotFile(const QString &filePath)
 
 void GraphView::parseDotFile(const QString &content)
 {
-    // Keep hedgehogs, clear everything else
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->removeItem(h);
-    }
-    m_scene->clear();
-    m_nodes.clear();
-    m_placeholderText = nullptr;
-    
-    // Re-add hedgehogs
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->addItem(h);
-    }
+    resetScene();
     
     // Parse DOT format
     QStringList lines = content.split('\n');
@@ -253,6 +261,250 @@ void GraphView::parseDotFile(const QString &content)
         }
     }
     
+    showGraph(edges);
+}
+
+void GraphView::loadGraph(const QJsonObject &graph)
+{
+    resetScene();
+    
+    for (const QJsonValue &value : graph["nodes"].toArray()) {
+        QJsonObject node = value.toObject();
+        createNode(node["id"].toString(), node["label"].toString());
+    }
+    
+    QList<QPair<QString, QString>> edges;
+    for (const QJsonValue &value : graph["edges"].toArray()) {
+        QJsonObject edge = value.toObject();
+        edges.append(qMakePair(edge["from"].toString(), edge["to"].toString()));
+    }
+    
+    showGraph(edges);
+}
+
+void GraphView::applyDelta(const QJsonObject &delta)
+{
+    // Removals first so re-added edges between surviving nodes are rebuilt
+    for (const QJsonValue &value : delta["removed_edges"].toArray()) {
+        QJsonObject edge = value.toObject();
+        removeEdge(edge["from"].toString(), edge["to"].toString());
+    }
+    for (const QJsonValue &value : delta["removed_nodes"].toArray()) {
+        removeNode(value.toString());
+    }
+    
+    // New nodes take the next free grid slots; existing nodes stay put
+    for (const QJsonValue &value : delta["added_nodes"].toArray()) {
+        QJsonObject node = value.toObject();
+        QString id = node["id"].toString();
+        if (m_nodes.contains(id)) {
+            continue;
+        }
+        if (m_placeholderText) {
+            resetScene();
+        }
+        QGraphicsEllipseItem *item = createNode(id, node["label"].toString());
+        item->setPos(gridPosition(m_nextSlot++));
+    }
+    
+    for (const QJsonValue &value : delta["added_edges"].toArray()) {
+        QJsonObject edge = value.toObject();
+        createEdge(edge["from"].toString(), edge["to"].toString());
+    }
+    
+    if (!m_nodes.isEmpty()) {
+        setSceneRect(m_scene->itemsBoundingRect().adjusted(-50, -50, 50, 50));
+    } else {
+        showPlaceholder("No nodes found in the call graph");
+    }
+}
+
+void GraphView::showDelta(const QJsonObject &delta)
+{
+    resetScene();
+    
+    auto edgeList = [](const QJsonValue &array) {
+        QList<QPair<QString, QString>> edges;
+        for (const QJsonValue &value : array.toArray()) {
+            QJsonObject edge = value.toObject();
+            edges.append(qMakePair(edge["from"].toString(), edge["to"].toString()));
+        }
+        return edges;
+    };
+    QList<QPair<QString, QString>> added = edgeList(delta["added_edges"]);
+    QList<QPair<QString, QString>> removed = edgeList(delta["removed_edges"]);
+    
+    // States first: createNode picks its pen from them
+    for (const QJsonValue &value : delta["added_nodes"].toArray()) {
+        QJsonObject node = value.toObject();
+        m_diffNodes.insert(node["id"].toString(), DiffState::Added);
+        createNode(node["id"].toString(), node["label"].toString());
+    }
+    for (const QJsonValue &value : delta["removed_nodes"].toArray()) {
+        m_diffNodes.insert(value.toString(), DiffState::Removed);
+        createNode(value.toString(), value.toString());
+    }
+    for (const auto &edge : added + removed) {
+        createNode(edge.first, edge.first);
+        createNode(edge.second, edge.second);
+    }
+    
+    showGraph(added + removed);
+    
+    for (const auto &edge : added) {
+        styleEdge(edge.first, edge.second, QColor("#a6e3a1"), false);
+    }
+    for (const auto &edge : removed) {
+        styleEdge(edge.first, edge.second, QColor("#f38ba8"), true);
+    }
+    
+    if (m_nodes.isEmpty()) {
+        showPlaceholder("No differences between the snapshots");
+    }
+}
+
+void GraphView::loadShardManifest(const QString &manifestPath)
+{
+    QFile file(manifestPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        showPlaceholder("Failed to open shard manifest:\n" + manifestPath);
+        return;
+    }
+    QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    
+    resetScene();
+    m_shardDir = QFileInfo(manifestPath).absolutePath();
+    
+    QJsonArray shards = manifest["shards"].toArray();
+    for (int i = 0; i < shards.size(); ++i) {
+        QJsonObject shard = shards[i].toObject();
+        m_shards.append(Shard{
+            shard["crate"].toString(),
+            shard["file"].toString(),
+            shard["nodes"].toInt(),
+            false
+        });
+        createNode(shardClusterId(i), QString("%1 (%2)").arg(m_shards[i].name).arg(m_shards[i].nodes));
+    }
+    for (const QJsonValue &value : manifest["cross_edges"].toArray()) {
+        QJsonObject link = value.toObject();
+        m_shardLinks.append(ShardLink{link["from"].toInt(), link["to"].toInt(), link["count"].toInt()});
+    }
+    
+    showGraph({});
+    rebuildShardEdges();
+}
+
+void GraphView::expandShard(int index)
+{
+    if (index < 0 || index >= m_shards.size() || m_shards[index].expanded) {
+        return;
+    }
+    
+    QFile file(QDir(m_shardDir).filePath(m_shards[index].file));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Failed to open shard" << file.fileName();
+        return;
+    }
+    
+    // Same line shapes as parseDotFile, plus the target shard on edges
+    QRegularExpression nodeRegex("\"([^\"]+)\"\\s*\\[label=\"([^\"]+)\"\\]");
+    QRegularExpression edgeRegex("\"([^\"]+)\"\\s*->\\s*\"([^\"]+)\"\\s*\\[shard=(-?\\d+)\\]");
+    
+    // The crate's functions replace its cluster
+    removeNode(shardClusterId(index));
+    m_shards[index].expanded = true;
+    
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        QRegularExpressionMatch edgeMatch = edgeRegex.match(line);
+        if (edgeMatch.hasMatch()) {
+            m_shardEdges.append(ShardEdge{
+                edgeMatch.captured(1),
+                edgeMatch.captured(2),
+                edgeMatch.captured(3).toInt()
+            });
+            continue;
+        }
+        QRegularExpressionMatch nodeMatch = nodeRegex.match(line);
+        if (nodeMatch.hasMatch()) {
+            QGraphicsEllipseItem *item = createNode(nodeMatch.captured(1), nodeMatch.captured(2));
+            item->setPos(gridPosition(m_nextSlot++));
+        }
+    }
+    
+    rebuildShardEdges();
+    setSceneRect(m_scene->itemsBoundingRect().adjusted(-50, -50, 50, 50));
+}
+
+void GraphView::rebuildShardEdges()
+{
+    for (auto it = m_edges.begin(); it != m_edges.end(); ++it) {
+        delete it->line;
+        delete it->arrow;
+    }
+    m_edges.clear();
+    
+    // Expanded crates draw their own calls, to the callee itself or, while
+    // the callee's crate is collapsed, to its cluster
+    for (const ShardEdge &edge : m_shardEdges) {
+        if (edge.toShard < 0 || edge.toShard >= m_shards.size()) {
+            continue;
+        }
+        createEdge(edge.from, m_shards[edge.toShard].expanded ? edge.to : shardClusterId(edge.toShard));
+    }
+    
+    // Between collapsed crates only the manifest totals are known
+    for (const ShardLink &link : m_shardLinks) {
+        if (link.from < m_shards.size() && link.to < m_shards.size()
+            && !m_shards[link.from].expanded && !m_shards[link.to].expanded) {
+            createEdge(shardClusterId(link.from), shardClusterId(link.to));
+        }
+    }
+}
+
+QString GraphView::shardClusterId(int index)
+{
+    return QString("shard:%1").arg(index);
+}
+
+void GraphView::resetScene()
+{
+    // Keep hedgehogs, clear everything else
+    for (Hedgehog *h : m_hedgehogs) {
+        m_scene->removeItem(h);
+    }
+    m_scene->clear();
+    m_nodes.clear();
+    m_edges.clear();
+    m_nextSlot = 0;
+    m_placeholderText = nullptr;
+    m_highlightTarget.clear();
+    m_highlightCallers.clear();
+    m_diffNodes.clear();
+    m_shardDir.clear();
+    m_shards.clear();
+    m_shardEdges.clear();
+    m_shardLinks.clear();
+    
+    // Any tiled session ends with the scene it populated
+    m_tileClient = nullptr;
+    m_tiles.clear();
+    m_pendingTiles.clear();
+    m_tileNodes.clear();
+    m_tileEdges.clear();
+    m_streamGeneration++;
+    
+    // Re-add hedgehogs
+    for (Hedgehog *h : m_hedgehogs) {
+        m_scene->addItem(h);
+    }
+}
+
+void GraphView::showGraph(const QList<QPair<QString, QString>> &edges)
+{
     layoutGraph();
     
     for (const auto &edge : edges) {
@@ -281,9 +533,10 @@ QGraphicsEllipseItem* GraphView::createNode(const QString &id, const QString &la
     
     QGraphicsEllipseItem *node = m_scene->addEllipse(
         0, 0, NODE_WIDTH, NODE_HEIGHT,
-        QPen(QColor("#89b4fa"), 2),
+        nodePen(id),
         QBrush(QColor("#313244"))
     );
+    node->setData(NODE_ID_KEY, id);
     
     QString displayLabel = label;
     if (displayLabel.length() > 20) {
@@ -305,11 +558,85 @@ QGraphicsEllipseItem* GraphView::createNode(const QString &id, const QString &la
     return node;
 }
 
+QPen GraphView::nodePen(const QString &id) const
+{
+    if (id == m_highlightTarget) {
+        return QPen(QColor("#f9e2af"), 4);
+    }
+    if (m_highlightCallers.contains(id)) {
+        return QPen(QColor("#a6e3a1"), 3);
+    }
+    if (id.startsWith("shard:")) {
+        return QPen(QColor("#cba6f7"), 3);
+    }
+    auto diff = m_diffNodes.constFind(id);
+    if (diff != m_diffNodes.constEnd()) {
+        return *diff == DiffState::Added
+            ? QPen(QColor("#a6e3a1"), 3)
+            : QPen(QColor("#f38ba8"), 3, Qt::DashLine);
+    }
+    return QPen(QColor("#89b4fa"), 2);
+}
+
+void GraphView::highlightCallers(const QString &id, const QStringList &callers)
+{
+    m_highlightTarget = id;
+    m_highlightCallers = QSet<QString>(callers.begin(), callers.end());
+    
+    for (auto it = m_nodes.begin(); it != m_nodes.end(); ++it) {
+        it.value()->setPen(nodePen(it.key()));
+    }
+}
+
+QString GraphView::nodeIdAt(const QPoint &viewPos) const
+{
+    // Labels are children of their node ellipse
+    for (QGraphicsItem *item = itemAt(viewPos); item; item = item->parentItem()) {
+        QString id = item->data(NODE_ID_KEY).toString();
+        if (!id.isEmpty()) {
+            return id;
+        }
+    }
+    return QString();
+}
+
+void GraphView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QString id = nodeIdAt(event->pos());
+    if (id.isEmpty()) {
+        QGraphicsView::contextMenuEvent(event);
+        return;
+    }
+    
+    QMenu menu(this);
+    if (id.startsWith("shard:")) {
+        QAction *expand = menu.addAction("Expand Crate");
+        if (menu.exec(event->globalPos()) == expand) {
+            expandShard(id.mid(6).toInt());
+        }
+        return;
+    }
+    
+    QAction *whoCalls = menu.addAction("Who Calls This?");
+    QAction *clearHighlight = menu.addAction("Clear Highlight");
+    clearHighlight->setEnabled(!m_highlightTarget.isEmpty());
+    
+    QAction *chosen = menu.exec(event->globalPos());
+    if (chosen == whoCalls) {
+        emit callersRequested(id);
+    } else if (chosen == clearHighlight) {
+        highlightCallers(QString(), QStringList());
+    }
+}
+
 void GraphView::createEdge(const QString &from, const QString &to)
 {
     if (!m_nodes.contains(from) || !m_nodes.contains(to)) {
         return;
     }
+    if (m_edges.contains(qMakePair(from, to))) {
+        return;
+    }
     
     QGraphicsEllipseItem *fromNode = m_nodes[from];
     QGraphicsEllipseItem *toNode = m_nodes[to];
@@ -317,14 +644,26 @@ void GraphView::createEdge(const QString &from, const QString &to)
     QPointF fromCenter = fromNode->pos() + QPointF(NODE_WIDTH / 2, NODE_HEIGHT);
     QPointF toCenter = toNode->pos() + QPointF(NODE_WIDTH / 2, 0);
     
-    QGraphicsLineItem *line = m_scene->addLine(
-        QLineF(fromCenter, toCenter),
-        QPen(QColor("#a6adc8"), 1.5)
-    );
+    m_edges.insert(qMakePair(from, to), addEdgeItems(fromCenter, toCenter, 1.5));
+}
+
+GraphView::EdgeItems GraphView::addEdgeItems(const QPointF &fromCenter, const QPointF &toCenter, qreal width)
+{
+    QPen pen(QColor("#a6adc8"), width);
+    if (m_tileClient) {
+        // Tiles are viewed at any zoom; keep strokes a constant screen width
+        pen.setCosmetic(true);
+    }
+    
+    QGraphicsLineItem *line = m_scene->addLine(QLineF(fromCenter, toCenter), pen);
     line->setZValue(-1);
     
     qreal angle = std::atan2(toCenter.y() - fromCenter.y(), toCenter.x() - fromCenter.x());
     qreal arrowSize = 10;
+    if (m_tileClient) {
+        // Keep arrowheads readable at the tile's zoom level
+        arrowSize /= std::pow(2.0, m_tileLevel);
+    }
     
     QPointF arrowP1 = toCenter - QPointF(
         std::cos(angle - M_PI / 6) * arrowSize,
@@ -344,40 +683,78 @@ void GraphView::createEdge(const QString &from, const QString &to)
         QBrush(QColor("#a6adc8"))
     );
     arrow->setZValue(-1);
+    
+    return EdgeItems{line, arrow};
+}
+
+void GraphView::styleEdge(const QString &from, const QString &to, const QColor &color, bool dashed)
+{
+    auto it = m_edges.find(qMakePair(from, to));
+    if (it == m_edges.end()) {
+        return;
+    }
+    QPen pen = it->line->pen();
+    pen.setColor(color);
+    pen.setStyle(dashed ? Qt::DashLine : Qt::SolidLine);
+    it->line->setPen(pen);
+    it->arrow->setPen(QPen(color));
+    it->arrow->setBrush(QBrush(color));
+}
+
+void GraphView::removeEdge(const QString &from, const QString &to)
+{
+    auto it = m_edges.find(qMakePair(from, to));
+    if (it == m_edges.end()) {
+        return;
+    }
+    delete it->line;
+    delete it->arrow;
+    m_edges.erase(it);
+}
+
+void GraphView::removeNode(const QString &id)
+{
+    auto nodeIt = m_nodes.find(id);
+    if (nodeIt == m_nodes.end()) {
+        return;
+    }
+    
+    // Drop any edge still attached to the node
+    for (auto it = m_edges.begin(); it != m_edges.end();) {
+        if (it.key().first == id || it.key().second == id) {
+            delete it->line;
+            delete it->arrow;
+            it = m_edges.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    delete nodeIt.value(); // Also deletes the child label
+    m_nodes.erase(nodeIt);
 }
 
 void GraphView::layoutGraph()
 {
     if (m_nodes.isEmpty()) return;
     
-    int row = 0;
-    int col = 0;
-    int maxCols = 5;
-    
+    int slot = 0;
     for (auto it = m_nodes.begin(); it != m_nodes.end(); ++it) {
-        it.value()->setPos(col * NODE_SPACING_X, row * NODE_SPACING_Y);
-        
-        col++;
-        if (col >= maxCols) {
-            col = 0;
-            row++;
-        }
+        it.value()->setPos(gridPosition(slot++));
     }
+    m_nextSlot = slot;
+}
+
+QPointF GraphView::gridPosition(int slot) const
+{
+    int row = slot / GRID_COLUMNS;
+    int col = slot % GRID_COLUMNS;
+    return QPointF(col * NODE_SPACING_X, row * NODE_SPACING_Y);
 }
 
 void GraphView::showPlaceholder(const QString &message)
 {
-    // Keep hedgehogs, clear everything else
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->removeItem(h);
-    }
-    m_scene->clear();
-    m_nodes.clear();
-    
-    // Re-add hedgehogs
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->addItem(h);
-    }
+    resetScene();
     
     m_placeholderText = m_scene->addText(message);
     m_placeholderText->setDefaultTextColor(QColor("#6c7086"));
@@ -399,18 +776,7 @@ void GraphView::showPlaceholder(const QString &message)
 
 void GraphView::clear()
 {
-    // Keep hedgehogs, clear everything else
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->removeItem(h);
-    }
-    m_scene->clear();
-    m_nodes.clear();
-    m_placeholderText = nullptr;
-    
-    // Re-add hedgehogs
-    for (Hedgehog *h : m_hedgehogs) {
-        m_scene->addItem(h);
-    }
+    resetScene();
 }
 
 void GraphView::wheelEvent(QWheelEvent *event)
@@ -422,6 +788,255 @@ void GraphView::wheelEvent(QWheelEvent *event)
     } else {
         scale(1 / scaleFactor, 1 / scaleFactor);
     }
+    scheduleTileRequest();
+}
+
+void GraphView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    scheduleTileRequest();
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// Tile Streaming
+// ═══════════════════════════════════════════════════════════════════════════
+
+void GraphView::streamFromDaemon(DaemonClient *client, const QString &workspace)
+{
+    resetScene();
+    m_tileClient = client;
+    m_tileWorkspace = workspace;
+    resetTransform();
+    m_tileLevel = 0;
+    
+    // A zero-area probe just to learn the layout bounds, then fit and tile
+    QJsonObject params;
+    params["path"] = workspace;
+    params["x0"] = 0;
+    params["y0"] = 0;
+    params["x1"] = 0;
+    params["y1"] = 0;
+    params["zoom"] = 1.0;
+    
+    int generation = m_streamGeneration;
+    client->send("VIEWPORT", params, [this, generation](const QJsonObject &response) {
+        if (generation != m_streamGeneration) {
+            return;
+        }
+        if (response["status"].toString() != "success") {
+            showPlaceholder("Viewport query failed:\n" + response["message"].toString());
+            return;
+        }
+        
+        QJsonArray bounds = response["data"].toObject()["bounds"].toArray();
+        if (bounds.size() != 4) {
+            showPlaceholder("No nodes found in the call graph");
+            return;
+        }
+        
+        QRectF extent(QPointF(bounds[0].toDouble(), bounds[1].toDouble()),
+                      QPointF(bounds[2].toDouble(), bounds[3].toDouble()));
+        setSceneRect(extent.adjusted(-200, -200, 200, 200));
+        fitInView(extent, Qt::KeepAspectRatio);
+        requestVisibleTiles();
+    });
+}
+
+void GraphView::stopStreaming()
+{
+    m_tileClient = nullptr;
+    m_pendingTiles.clear();
+    m_streamGeneration++;
+}
+
+void GraphView::scheduleTileRequest()
+{
+    if (m_tileClient) {
+        m_tileTimer->start();
+    }
+}
+
+void GraphView::requestVisibleTiles()
+{
+    if (!m_tileClient || !m_tileClient->isConnected()) {
+        return;
+    }
+    
+    // Tiles come in power-of-two zoom levels, like a map client
+    qreal zoom = transform().m11();
+    int level = qBound(-30, int(std::floor(std::log2(zoom))), 8);
+    if (level != m_tileLevel) {
+        const QList<TileKey> stale = m_tiles.keys();
+        for (const TileKey &key : stale) {
+            dropTile(key);
+        }
+        m_tileLevel = level;
+    }
+    
+    qreal levelZoom = std::pow(2.0, level);
+    qreal tileSize = TILE_PIXELS / levelZoom;
+    QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    
+    qint64 tx0 = qint64(std::floor(visible.left() / tileSize));
+    qint64 tx1 = qint64(std::floor(visible.right() / tileSize));
+    qint64 ty0 = qint64(std::floor(visible.top() / tileSize));
+    qint64 ty1 = qint64(std::floor(visible.bottom() / tileSize));
+    
+    for (qint64 ty = ty0; ty <= ty1; ++ty) {
+        for (qint64 tx = tx0; tx <= tx1; ++tx) {
+            TileKey key{level, tx, ty};
+            if (m_tiles.contains(key) || m_pendingTiles.contains(key)) {
+                continue;
+            }
+            requestTile(key, QRectF(tx * tileSize, ty * tileSize, tileSize, tileSize), levelZoom);
+        }
+    }
+    
+    // Evict tiles far from the view once the cache is full
+    if (m_tiles.size() > MAX_CACHED_TILES) {
+        const QList<TileKey> keys = m_tiles.keys();
+        for (const TileKey &key : keys) {
+            if (key.tx < tx0 - 1 || key.tx > tx1 + 1 || key.ty < ty0 - 1 || key.ty > ty1 + 1) {
+                dropTile(key);
+            }
+        }
+    }
+}
+
+void GraphView::requestTile(const TileKey &key, const QRectF &rect, qreal zoom)
+{
+    m_pendingTiles.insert(key);
+    
+    QJsonObject params;
+    params["path"] = m_tileWorkspace;
+    params["x0"] = rect.left();
+    params["y0"] = rect.top();
+    params["x1"] = rect.right();
+    params["y1"] = rect.bottom();
+    params["zoom"] = zoom;
+    
+    int generation = m_streamGeneration;
+    m_tileClient->send("VIEWPORT", params, [this, key, generation](const QJsonObject &response) {
+        if (generation != m_streamGeneration) {
+            return;
+        }
+        m_pendingTiles.remove(key);
+        if (response["status"].toString() != "success") {
+            qWarning() << "[Tiles] VIEWPORT failed:" << response["message"].toString();
+            return;
+        }
+        // Zoom level changed while the request was in flight
+        if (key.level != m_tileLevel) {
+            return;
+        }
+        addTile(key, response["data"].toObject());
+    });
+}
+
+void GraphView::addTile(const TileKey &key, const QJsonObject &viewport)
+{
+    Tile tile;
+    bool aggregated = viewport["aggregated"].toBool();
+    qreal cellSize = 64.0 / std::pow(2.0, key.level);
+    
+    // Nodes and edges can reach into several tiles; their items are
+    // created once and counted per tile that delivered them
+    for (const QJsonValue &value : viewport["nodes"].toArray()) {
+        QJsonObject node = value.toObject();
+        QString id = node["id"].toString();
+        tile.nodeIds.append(id);
+        auto shared = m_tileNodes.find(id);
+        if (shared != m_tileNodes.end()) {
+            shared->refs++;
+            continue;
+        }
+        
+        QPointF pos(node["x"].toDouble(), node["y"].toDouble());
+        QGraphicsItem *item = nullptr;
+        
+        if (aggregated) {
+            int count = node["count"].toInt();
+            qreal radius = cellSize * (0.15 + 0.3 * qMin(1.0, std::log10(qMax(count, 1)) / 4.0));
+            QPointF center = pos + QPointF(cellSize / 2, cellSize / 2);
+            
+            QGraphicsEllipseItem *cluster = m_scene->addEllipse(
+                -radius, -radius, 2 * radius, 2 * radius,
+                QPen(QColor("#89b4fa"), 0),
+                QBrush(QColor("#313244"))
+            );
+            cluster->setPos(center);
+            cluster->setToolTip(node["label"].toString());
+            
+            QGraphicsTextItem *text = m_scene->addText(QString::number(count));
+            text->setDefaultTextColor(QColor("#cdd6f4"));
+            text->setParentItem(cluster);
+            text->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+            item = cluster;
+        } else {
+            QGraphicsEllipseItem *ellipse = createNode(id, node["label"].toString());
+            ellipse->setPos(pos);
+            item = ellipse;
+        }
+        
+        m_tileNodes.insert(id, TileItem{{item}, 1});
+    }
+    
+    for (const QJsonValue &value : viewport["edges"].toArray()) {
+        QJsonObject edge = value.toObject();
+        QString edgeKey = edge["from"].toString() + "->" + edge["to"].toString();
+        tile.edgeKeys.append(edgeKey);
+        auto shared = m_tileEdges.find(edgeKey);
+        if (shared != m_tileEdges.end()) {
+            shared->refs++;
+            continue;
+        }
+        
+        QJsonArray fromPos = edge["from_pos"].toArray();
+        QJsonArray toPos = edge["to_pos"].toArray();
+        QPointF from(fromPos[0].toDouble(), fromPos[1].toDouble());
+        QPointF to(toPos[0].toDouble(), toPos[1].toDouble());
+        
+        qreal width = 1.5;
+        if (aggregated) {
+            from += QPointF(cellSize / 2, cellSize / 2);
+            to += QPointF(cellSize / 2, cellSize / 2);
+            width = 1.0 + std::log2(qMax(edge["count"].toInt(), 1));
+        } else {
+            from += QPointF(NODE_WIDTH / 2, NODE_HEIGHT);
+            to += QPointF(NODE_WIDTH / 2, 0);
+        }
+        
+        EdgeItems items = addEdgeItems(from, to, width);
+        m_tileEdges.insert(edgeKey, TileItem{{items.line, items.arrow}, 1});
+    }
+    
+    m_tiles.insert(key, tile);
+}
+
+void GraphView::dropTile(const TileKey &key)
+{
+    auto it = m_tiles.find(key);
+    if (it == m_tiles.end()) {
+        return;
+    }
+    
+    // Items still delivered by another loaded tile stay in the scene
+    for (const QString &edgeKey : it->edgeKeys) {
+        auto shared = m_tileEdges.find(edgeKey);
+        if (shared != m_tileEdges.end() && --shared->refs == 0) {
+            qDeleteAll(shared->items);
+            m_tileEdges.erase(shared);
+        }
+    }
+    for (const QString &id : it->nodeIds) {
+        auto shared = m_tileNodes.find(id);
+        if (shared != m_tileNodes.end() && --shared->refs == 0) {
+            m_nodes.remove(id);
+            qDeleteAll(shared->items); // Child labels go with their nodes
+            m_tileNodes.erase(shared);
+        }
+    }
+    m_tiles.erase(it);
 }
 
 void GraphView::drawBackground(QPainter *painter, const QRectF &rect)
@@ -12,9 +12,31 @@
 #include <QTimer>
 #include <QRandomGenerator>
 #include <QVector>
+#include <QPair>
+#include <QJsonObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 
 // Forward declaration
 class Hedgehog;
+class DaemonClient;
+
+// One map-style tile of a daemon-laid-out graph: zoom level plus grid cell
+struct TileKey {
+    int level;
+    qint64 tx;
+    qint64 ty;
+
+    bool operator==(const TileKey &other) const {
+        return level == other.level && tx == other.tx && ty == other.ty;
+    }
+};
+
+inline size_t qHash(const TileKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.level, key.tx, key.ty);
+}
 
 class GraphView : public QGraphicsView
 {
@@ -25,28 +47,138 @@ public:
     ~GraphView();
 
     void loadDotFile(const QString &filePath);
+    // Load a daemon GraphDto ({"nodes": [...], "edges": [...]})
+    void loadGraph(const QJsonObject &graph);
+    // Patch the current scene with a daemon GraphDeltaDto, keeping positions
+    void applyDelta(const QJsonObject &delta);
+    // Show a daemon DIFF result on its own: added nodes and edges green,
+    // removed ones red and dashed, unchanged endpoints of changed edges
+    // plain. Only the delta is loaded, never either full graph.
+    void showDelta(const QJsonObject &delta);
+    // Tiled mode: fetch only the visible part of the daemon's layout via
+    // VIEWPORT requests as the user pans and zooms
+    void streamFromDaemon(DaemonClient *client, const QString &workspace);
+    // Sharded output (--mode shards): one cluster per crate from the
+    // manifest; a crate's shard file is read only when its cluster is expanded
+    void loadShardManifest(const QString &manifestPath);
+    void stopStreaming();
     void showPlaceholder(const QString &message);
     void clear();
+    // Outline `id` and the nodes that call it; nodes loaded later (tiles,
+    // deltas) pick the highlight up too. An empty id clears it.
+    void highlightCallers(const QString &id, const QStringList &callers);
+
+signals:
+    // Context menu "Who Calls This?" on a node
+    void callersRequested(const QString &id);
 
 protected:
     void wheelEvent(QWheelEvent *event) override;
     void drawBackground(QPainter *painter, const QRectF &rect) override;
     void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
 
 private slots:
     void updateHedgehogs();
+    void requestVisibleTiles();
 
 private:
+    struct EdgeItems {
+        QGraphicsLineItem *line;
+        QGraphicsPolygonItem *arrow;
+    };
+
+    // One crate of a sharded graph
+    struct Shard {
+        QString name;
+        QString file;
+        int nodes;
+        bool expanded;
+    };
+    
+    // Call loaded from an expanded shard; toShard is -1 for external callees
+    struct ShardEdge {
+        QString from;
+        QString to;
+        int toShard;
+    };
+    
+    // Manifest total of calls between two crates
+    struct ShardLink {
+        int from;
+        int to;
+        int count;
+    };
+    
+    // Ids delivered by one loaded tile
+    struct Tile {
+        QStringList nodeIds;
+        QStringList edgeKeys;
+    };
+    
+    // Scene items of a node or edge, shared by every loaded tile that
+    // delivered it and removed with the last of them
+    struct TileItem {
+        QList<QGraphicsItem*> items;
+        int refs;
+    };
+
     void setupScene();
     void parseDotFile(const QString &content);
+    void resetScene();
+    void showGraph(const QList<QPair<QString, QString>> &edges);
     void layoutGraph();
+    QPointF gridPosition(int slot) const;
     QGraphicsEllipseItem* createNode(const QString &id, const QString &label);
     void createEdge(const QString &from, const QString &to);
+    void removeEdge(const QString &from, const QString &to);
+    void styleEdge(const QString &from, const QString &to, const QColor &color, bool dashed);
+    void removeNode(const QString &id);
+    EdgeItems addEdgeItems(const QPointF &fromCenter, const QPointF &toCenter, qreal width);
+    void scheduleTileRequest();
+    void requestTile(const TileKey &key, const QRectF &rect, qreal zoom);
+    void addTile(const TileKey &key, const QJsonObject &viewport);
+    void dropTile(const TileKey &key);
+    void expandShard(int index);
+    void rebuildShardEdges();
+    static QString shardClusterId(int index);
     void spawnHedgehogs();
+    QString nodeIdAt(const QPoint &viewPos) const;
+    QPen nodePen(const QString &id) const;
 
     QGraphicsScene *m_scene;
     QMap<QString, QGraphicsEllipseItem*> m_nodes;
     QGraphicsTextItem *m_placeholderText;
+
+    // Edge items by (from, to), so deltas can remove them individually
+    QMap<QPair<QString, QString>, EdgeItems> m_edges;
+    int m_nextSlot;
+
+    // Node states of a displayed diff (empty outside showDelta)
+    enum class DiffState { Added, Removed };
+    QHash<QString, DiffState> m_diffNodes;
+
+    // "Who calls this" highlight
+    QString m_highlightTarget;
+    QSet<QString> m_highlightCallers;
+
+    // Sharded graph state
+    QString m_shardDir;
+    QVector<Shard> m_shards;
+    QVector<ShardEdge> m_shardEdges;
+    QVector<ShardLink> m_shardLinks;
+    
+    // Tile streaming state
+    DaemonClient *m_tileClient;
+    QString m_tileWorkspace;
+    QHash<TileKey, Tile> m_tiles;
+    QSet<TileKey> m_pendingTiles;
+    QHash<QString, TileItem> m_tileNodes;
+    QHash<QString, TileItem> m_tileEdges;
+    int m_tileLevel;
+    int m_streamGeneration;
+    QTimer *m_tileTimer;
     
     // Hedgehog animation
     QTimer *m_animationTimer;
@@ -57,6 +189,10 @@ private:
     static constexpr qreal NODE_HEIGHT = 40;
     static constexpr qreal NODE_SPACING_X = 200;
     static constexpr qreal NODE_SPACING_Y = 80;
+    static constexpr int GRID_COLUMNS = 5;
+    static constexpr qreal TILE_PIXELS = 512;
+    static constexpr int MAX_CACHED_TILES = 256;
+    static constexpr int NODE_ID_KEY = 0; // QGraphicsItem::data key holding the node id
 };
 
 // Animated hedgehog character
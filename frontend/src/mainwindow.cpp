@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "graphview.h"
+#include "daemonclient.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -13,10 +14,17 @@
 #include <QGroupBox>
 #include <QTextEdit>
 #include <QDir>
+#include <QTimer>
+#include <QJsonArray>
+#include <QFileInfo>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_analysisProcess(nullptr)
+    , m_daemon(nullptr)
+    , m_daemonProcess(nullptr)
+    , m_watchAction(nullptr)
+    , m_daemonStartAttempted(false)
 {
     setWindowTitle("Mr. Hedgehog - Rust Call Graph Analyzer");
     setMinimumSize(1200, 800);
@@ -146,6 +154,39 @@ MainWindow::MainWindow(QWidget *parent)
     
     setupUI();
     loadSettings();
+    
+    m_daemon = new DaemonClient(this);
+    connect(m_daemon, &DaemonClient::eventReceived, this, &MainWindow::onDaemonEvent);
+    connect(m_daemon, &DaemonClient::connected, this, [this]() {
+        if (m_onDaemonReady) {
+            auto onReady = std::move(m_onDaemonReady);
+            m_onDaemonReady = nullptr;
+            onReady();
+        }
+    });
+    connect(m_daemon, &DaemonClient::errorOccurred, this, [this](const QString &message) {
+        if (!m_onDaemonReady) {
+            return;
+        }
+        // No daemon listening yet: launch one and retry once it has bound
+        if (!m_daemonStartAttempted) {
+            m_daemonStartAttempted = true;
+            QString backendPath = findBackend();
+            if (!backendPath.isEmpty()) {
+                m_daemonProcess = new QProcess(this);
+                m_daemonProcess->start(backendPath,
+                    {"--daemon", "--port", QString::number(DAEMON_PORT)});
+                m_statusLabel->setText("Starting analysis daemon...");
+                QTimer::singleShot(1000, this, [this]() {
+                    m_daemon->connectToDaemon("127.0.0.1", DAEMON_PORT);
+                });
+                return;
+            }
+        }
+        m_onDaemonReady = nullptr;
+        m_statusLabel->setText("Daemon unavailable: " + message);
+        stopWatching();
+    });
 }
 
 MainWindow::~MainWindow()
@@ -155,6 +196,10 @@ MainWindow::~MainWindow()
         m_analysisProcess->kill();
         delete m_analysisProcess;
     }
+    if (m_daemonProcess) {
+        m_daemonProcess->kill();
+        m_daemonProcess->waitForFinished(1000);
+    }
 }
 
 void MainWindow::setupUI()
@@ -177,6 +222,9 @@ void MainWindow::setupMenuBar()
     openAction->setShortcut(QKeySequence::Open);
     connect(openAction, &QAction::triggered, this, &MainWindow::selectFolder);
     
+    QAction *openShardsAction = fileMenu->addAction("Open &Sharded Graph...");
+    connect(openShardsAction, &QAction::triggered, this, &MainWindow::openShardManifest);
+    
     fileMenu->addSeparator();
     
     QAction *exitAction = fileMenu->addAction("E&xit");
@@ -193,6 +241,19 @@ void MainWindow::setupMenuBar()
     QAction *clearAction = analysisMenu->addAction("&Clear Results");
     connect(clearAction, &QAction::triggered, this, &MainWindow::clearResults);
     
+    analysisMenu->addSeparator();
+    
+    m_watchAction = analysisMenu->addAction("&Watch for Changes");
+    m_watchAction->setCheckable(true);
+    m_watchAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_W));
+    connect(m_watchAction, &QAction::triggered, this, &MainWindow::toggleWatch);
+    
+    QAction *exploreAction = analysisMenu->addAction("&Explore Large Graph");
+    connect(exploreAction, &QAction::triggered, this, &MainWindow::exploreLargeGraph);
+    
+    QAction *compareAction = analysisMenu->addAction("Co&mpare Snapshots...");
+    connect(compareAction, &QAction::triggered, this, &MainWindow::compareSnapshots);
+    
     // Help menu
     QMenu *helpMenu = menuBar->addMenu("&Help");
     
@@ -210,6 +271,7 @@ void MainWindow::setupToolBar()
     m_toolbar->addAction("▶️ Analyze", this, &MainWindow::runAnalysis);
     m_toolbar->addAction("🗑️ Clear", this, &MainWindow::clearResults);
     m_toolbar->addSeparator();
+    m_toolbar->addAction(m_watchAction);
 }
 
 void MainWindow::setupSidebar()
@@ -277,6 +339,7 @@ void MainWindow::setupCentralWidget()
 {
     m_graphView = new GraphView(this);
     setCentralWidget(m_graphView);
+    connect(m_graphView, &GraphView::callersRequested, this, &MainWindow::showCallers);
 }
 
 void MainWindow::setupStatusBar()
@@ -337,14 +400,8 @@ void MainWindow::runAnalysis()
     m_statusLabel->setText("Running analysis...");
     m_analyzeBtn->setEnabled(false);
     
-    // Find backend executable
-    QString backendPath = QApplication::applicationDirPath() + "/mr_hedgehog";
-    if (!QFile::exists(backendPath)) {
-        // Try relative path during development
-        backendPath = QDir::currentPath() + "/target/release/mr_hedgehog";
-    }
-    
-    if (!QFile::exists(backendPath)) {
+    QString backendPath = findBackend();
+    if (backendPath.isEmpty()) {
         m_graphView->showPlaceholder("Backend not found.\nPlease ensure 'mr_hedgehog' is built.");
         m_statusLabel->setText("Error: Backend not found");
         m_analyzeBtn->setEnabled(true);
@@ -366,6 +423,16 @@ void MainWindow::runAnalysis()
     m_analysisProcess->start(backendPath, args);
 }
 
+QString MainWindow::findBackend() const
+{
+    QString backendPath = QApplication::applicationDirPath() + "/mr_hedgehog";
+    if (!QFile::exists(backendPath)) {
+        // Try relative path during development
+        backendPath = QDir::currentPath() + "/target/release/mr_hedgehog";
+    }
+    return QFile::exists(backendPath) ? backendPath : QString();
+}
+
 void MainWindow::onAnalysisOutput()
 {
     QString output = m_analysisProcess->readAllStandardOutput();
@@ -402,6 +469,224 @@ void MainWindow::clearResults()
     m_statusLabel->setText("Results cleared");
 }
 
+void MainWindow::toggleWatch()
+{
+    if (m_watchedFolder.isEmpty()) {
+        startWatching();
+    } else {
+        stopWatching();
+        m_statusLabel->setText("Stopped watching");
+    }
+}
+
+void MainWindow::startWatching()
+{
+    if (m_currentFolder.isEmpty()) {
+        QMessageBox::warning(this, "No Folder Selected",
+            "Please select a Rust project folder first.");
+        m_watchAction->setChecked(false);
+        return;
+    }
+    
+    m_watchedFolder = m_currentFolder;
+    m_watchAction->setChecked(true);
+    withDaemon([this]() { subscribeWorkspace(); });
+}
+
+void MainWindow::withDaemon(std::function<void()> onReady)
+{
+    if (m_daemon->isConnected()) {
+        onReady();
+        return;
+    }
+    m_onDaemonReady = std::move(onReady);
+    m_statusLabel->setText("Connecting to analysis daemon...");
+    m_daemon->connectToDaemon("127.0.0.1", DAEMON_PORT);
+}
+
+void MainWindow::exploreLargeGraph()
+{
+    if (m_currentFolder.isEmpty()) {
+        QMessageBox::warning(this, "No Folder Selected",
+            "Please select a Rust project folder first.");
+        return;
+    }
+    
+    // The daemon keeps the graph and its layout; only visible tiles are fetched
+    stopWatching();
+    QString folder = m_currentFolder;
+    withDaemon([this, folder]() {
+        m_statusLabel->setText("Analyzing " + folder + "...");
+        
+        QJsonObject params;
+        params["path"] = folder;
+        params["lang"] = "rust";
+        params["include_graph"] = false;
+        m_daemon->send("ANALYZE", params, [this, folder](const QJsonObject &response) {
+            if (response["status"].toString() != "success") {
+                m_graphView->showPlaceholder("Analysis failed:\n" + response["message"].toString());
+                m_statusLabel->setText("Analysis failed");
+                return;
+            }
+            QJsonObject stats = response["data"].toObject();
+            m_graphView->streamFromDaemon(m_daemon, folder);
+            m_statusLabel->setText(QString("Exploring %1 (%2 nodes, %3 edges)")
+                .arg(folder)
+                .arg(stats["node_count"].toInt())
+                .arg(stats["edge_count"].toInt()));
+        });
+    });
+}
+
+void MainWindow::openShardManifest()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Open Shard Manifest", m_currentFolder,
+        "Shard Manifest (manifest.json);;All Files (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    stopWatching();
+    m_graphView->loadShardManifest(path);
+    m_statusLabel->setText("Sharded graph: right-click a crate to expand it");
+}
+
+void MainWindow::compareSnapshots()
+{
+    const QString filter = "Graph Snapshots (*.graph *.snapshot);;All Files (*)";
+    QString oldPath = QFileDialog::getOpenFileName(this, "Select Old Snapshot", m_currentFolder, filter);
+    if (oldPath.isEmpty()) {
+        return;
+    }
+    QString newPath = QFileDialog::getOpenFileName(this, "Select New Snapshot",
+        QFileInfo(oldPath).absolutePath(), filter);
+    if (newPath.isEmpty()) {
+        return;
+    }
+    
+    // Live deltas would patch the diff view; stop them first
+    stopWatching();
+    withDaemon([this, oldPath, newPath]() {
+        m_statusLabel->setText("Comparing snapshots...");
+        
+        QJsonObject params;
+        params["old"] = oldPath;
+        params["new"] = newPath;
+        m_daemon->send("DIFF", params, [this](const QJsonObject &response) {
+            if (response["status"].toString() != "success") {
+                m_graphView->showPlaceholder("Diff failed:\n" + response["message"].toString());
+                m_statusLabel->setText("Diff failed");
+                return;
+            }
+            QJsonObject delta = response["data"].toObject();
+            m_graphView->showDelta(delta);
+            m_statusLabel->setText(QString("Diff: +%1/-%2 nodes, +%3/-%4 edges")
+                .arg(delta["added_nodes"].toArray().size())
+                .arg(delta["removed_nodes"].toArray().size())
+                .arg(delta["added_edges"].toArray().size())
+                .arg(delta["removed_edges"].toArray().size()));
+        });
+    });
+}
+
+void MainWindow::stopWatching()
+{
+    if (!m_watchedFolder.isEmpty() && m_daemon->isConnected()) {
+        QJsonObject params;
+        params["path"] = m_watchedFolder;
+        m_daemon->send("UNSUBSCRIBE", params);
+    }
+    m_watchedFolder.clear();
+    m_watchAction->setChecked(false);
+}
+
+void MainWindow::subscribeWorkspace()
+{
+    if (m_watchedFolder.isEmpty()) {
+        return;
+    }
+    
+    m_statusLabel->setText("Analyzing " + m_watchedFolder + "...");
+    
+    QJsonObject params;
+    params["path"] = m_watchedFolder;
+    params["lang"] = "rust";
+    m_daemon->send("SUBSCRIBE", params, [this](const QJsonObject &response) {
+        if (response["status"].toString() != "success") {
+            m_graphView->showPlaceholder("Watch failed:\n" + response["message"].toString());
+            m_statusLabel->setText("Watch failed");
+            stopWatching();
+            return;
+        }
+        m_graphView->loadGraph(response["data"].toObject()["graph"].toObject());
+        m_statusLabel->setText("Watching " + m_watchedFolder);
+    });
+}
+
+void MainWindow::onDaemonEvent(const QJsonObject &event)
+{
+    if (event["event"].toString() != "graph_delta") {
+        return;
+    }
+    
+    QJsonObject delta = event["data"].toObject();
+    m_graphView->applyDelta(delta);
+    
+    int changedFiles = event["changed_files"].toArray().size();
+    m_statusLabel->setText(QString("Updated: +%1/-%2 nodes, +%3/-%4 edges (%5 file(s) changed)")
+        .arg(delta["added_nodes"].toArray().size())
+        .arg(delta["removed_nodes"].toArray().size())
+        .arg(delta["added_edges"].toArray().size())
+        .arg(delta["removed_edges"].toArray().size())
+        .arg(changedFiles));
+}
+
+void MainWindow::showCallers(const QString &id)
+{
+    QString folder = m_watchedFolder.isEmpty() ? m_currentFolder : m_watchedFolder;
+    if (folder.isEmpty()) {
+        return;
+    }
+    withDaemon([this, folder, id]() { requestCallers(folder, id, true); });
+}
+
+void MainWindow::requestCallers(const QString &folder, const QString &id, bool analyzeIfNeeded)
+{
+    QJsonObject params;
+    params["path"] = folder;
+    params["lang"] = "rust";
+    params["id"] = id;
+    m_daemon->send("CALLERS", params, [this, folder, id, analyzeIfNeeded](const QJsonObject &response) {
+        if (response["status"].toString() != "success") {
+            QString message = response["message"].toString();
+            // Graph came from a one-shot CLI run: have the daemon index it once
+            if (analyzeIfNeeded && message.contains("not analyzed")) {
+                m_statusLabel->setText("Analyzing " + folder + "...");
+                QJsonObject analyze;
+                analyze["path"] = folder;
+                analyze["lang"] = "rust";
+                analyze["include_graph"] = false;
+                m_daemon->send("ANALYZE", analyze, [this, folder, id](const QJsonObject &) {
+                    requestCallers(folder, id, false);
+                });
+                return;
+            }
+            m_statusLabel->setText("Callers query failed: " + message);
+            return;
+        }
+        
+        QJsonArray levels = response["data"].toObject()["levels"].toArray();
+        QStringList callers;
+        if (!levels.isEmpty()) {
+            for (const QJsonValue &caller : levels[0].toArray()) {
+                callers.append(caller.toString());
+            }
+        }
+        m_graphView->highlightCallers(id, callers);
+        m_statusLabel->setText(QString("%1 direct caller(s) of %2").arg(callers.size()).arg(id));
+    });
+}
+
 void MainWindow::showAbout()
 {
     QMessageBox::about(this, "About Mr. Hedgehog",
@@ -11,8 +11,11 @@
 #include <QPushButton>
 #include <QProcess>
 #include <QSettings>
+#include <QJsonObject>
+#include <functional>
 
 class GraphView;
+class DaemonClient;
 
 class MainWindow : public QMainWindow
 {
@@ -29,6 +32,12 @@ private slots:
     void onAnalysisOutput();
     void clearResults();
     void showAbout();
+    void toggleWatch();
+    void exploreLargeGraph();
+    void compareSnapshots();
+    void openShardManifest();
+    void onDaemonEvent(const QJsonObject &event);
+    void showCallers(const QString &id);
 
 private:
     void setupUI();
@@ -40,6 +49,12 @@ private:
     void loadSettings();
     void saveSettings();
     void updateAnalyzeButton();
+    QString findBackend() const;
+    void startWatching();
+    void stopWatching();
+    void subscribeWorkspace();
+    void withDaemon(std::function<void()> onReady);
+    void requestCallers(const QString &folder, const QString &id, bool analyzeIfNeeded);
 
     // UI Components
     QToolBar *m_toolbar;
@@ -56,6 +71,16 @@ private:
     QProcess *m_analysisProcess;
     QString m_currentFolder;
     QString m_backendPath;
+
+    // Live mode: daemon connection pushing graph deltas for m_watchedFolder
+    DaemonClient *m_daemon;
+    QProcess *m_daemonProcess;
+    QAction *m_watchAction;
+    QString m_watchedFolder;
+    bool m_daemonStartAttempted;
+    std::function<void()> m_onDaemonReady;
+
+    static constexpr quint16 DAEMON_PORT = 4545;
 };
 
 #endif // MAINWINDOW_H
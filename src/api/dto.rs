@@ -1,5 +1,6 @@
 use serde::{Serialize, Deserialize};
 use crate::domain::callgraph::CallGraph;
+use crate::domain::delta::GraphDelta;
 
 #[derive(Debug, Serialize, Deserialize)]
 pub struct GraphDto {
@@ -22,28 +23,209 @@ pub struct EdgeDto {
     pub label: Option<String>,
 }
 
+/// Incremental update pushed to subscribed clients.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct GraphDeltaDto {
+    pub added_nodes: Vec<NodeDto>,
+    pub removed_nodes: Vec<String>,
+    pub added_edges: Vec<EdgeDto>,
+    pub removed_edges: Vec<EdgeDto>,
+}
+
+/// Direct callers and callees of one node.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct NeighborsDto {
+    pub id: String,
+    pub callers: Vec<String>,
+    pub callees: Vec<String>,
+}
+
+/// Transitive callers of one node: `levels[0]` calls it directly,
+/// `levels[1]` calls those, and so on. Each caller appears once, at its
+/// nearest level.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct CallersDto {
+    pub id: String,
+    pub levels: Vec<Vec<String>>,
+}
+
+/// One step of a call path.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct TraceStepDto {
+    pub id: String,
+    pub location: Option<String>,
+    pub depth: usize,
+    pub note: Option<String>,
+}
+
+/// Call paths enumerated from `root`, bounded by the request's limits.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct TraceDto {
+    pub root: String,
+    pub paths: Vec<Vec<TraceStepDto>>,
+}
+
+/// How exposed one node is: call paths reaching it from the entry set,
+/// counted on the SCC-condensed graph (recursive groups count once).
+#[derive(Debug, Serialize, Deserialize)]
+pub struct PathStatsDto {
+    pub id: String,
+    pub entries: Vec<String>,
+    pub reachable: bool,
+    /// Saturates at `u64::MAX`; `saturated` is then set
+    pub path_count: u64,
+    pub saturated: bool,
+    pub min_depth: Option<u32>,
+    pub max_depth: Option<u32>,
+    pub recursive: bool,
+    /// Nodes reachable from the entries in the whole graph
+    pub reachable_nodes: usize,
+}
+
+/// Chokepoints of one node: `dominators` lie on every call path from the
+/// entries to it (outermost first), `post_dominators` on every path from
+/// it down to a leaf (nearest first).
+#[derive(Debug, Serialize, Deserialize)]
+pub struct DominatorsDto {
+    pub id: String,
+    pub entries: Vec<String>,
+    pub reachable: bool,
+    pub dominators: Vec<String>,
+    pub post_dominators: Vec<String>,
+}
+
+/// Whether `from` can transitively call `to`. `by_index` is set when the
+/// reachability labels settled it without a graph search.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct ReachableDto {
+    pub from: String,
+    pub to: String,
+    pub reachable: bool,
+    pub by_index: bool,
+}
+
+/// Functions no entry point reaches, grouped by crate and file.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct UnreachableDto {
+    pub entries: Vec<String>,
+    pub reachable: usize,
+    pub total: usize,
+    pub groups: Vec<UnreachableGroupDto>,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+pub struct UnreachableGroupDto {
+    #[serde(rename = "crate")]
+    pub crate_name: String,
+    pub file: String,
+    pub functions: Vec<String>,
+}
+
+/// Flowchart of the resident graph from an entry set, up to `max_depth`.
+/// `complete` is set when no calls lie deeper.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct FlowchartDto {
+    pub entries: Vec<String>,
+    pub max_depth: usize,
+    pub complete: bool,
+    pub nodes: Vec<FlowNodeDto>,
+    pub edges: Vec<FlowEdgeDto>,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+pub struct FlowNodeDto {
+    pub id: String,
+    pub label: String,
+    /// `Entry`, `Call`, `Branch`, `Loop`, `Return` or `External`
+    pub kind: String,
+    pub depth: usize,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+pub struct FlowEdgeDto {
+    pub from: String,
+    pub to: String,
+    pub sequence: usize,
+}
+
+/// Nodes and edges visible in one viewport request.
+///
+/// When `aggregated` is set, nodes are clusters (`count` > 1 possible) and
+/// edges carry the number of calls between clusters.
+#[derive(Debug, Serialize, Deserialize)]
+pub struct ViewportDto {
+    pub aggregated: bool,
+    /// Extent of the whole layout as `[x0, y0, x1, y1]`
+    pub bounds: Option<[f64; 4]>,
+    pub nodes: Vec<ViewportNodeDto>,
+    pub edges: Vec<ViewportEdgeDto>,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+pub struct ViewportNodeDto {
+    pub id: String,
+    pub label: String,
+    pub x: f64,
+    pub y: f64,
+    pub count: usize,
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+pub struct ViewportEdgeDto {
+    pub from: String,
+    pub to: String,
+    pub from_pos: [f64; 2],
+    pub to_pos: [f64; 2],
+    pub count: usize,
+}
+
 impl From<CallGraph> for GraphDto {
     fn from(cg: CallGraph) -> Self {
-        let nodes = cg.nodes.iter().map(|n| {
+        GraphDto::from(&cg)
+    }
+}
+
+impl From<&CallGraph> for GraphDto {
+    fn from(cg: &CallGraph) -> Self {
+        let nodes = cg.nodes().map(|n| {
             NodeDto {
-                id: n.id.clone(),
-                label: n.label.clone().unwrap_or_else(|| n.id.clone()),
+                id: cg.id(n).to_string(),
+                label: cg.display_label(n).to_string(),
                 package: None, // Mr. Hedgehog domain doesn't reliably store package yet
-                location: None, // Location info is deep in SourceManager, optional for now.
+                location: cg.location(n).map(|l| l.to_string()),
             }
         }).collect();
 
-        let mut edges = Vec::new();
-        for node in &cg.nodes {
-            for callee in &node.callees {
-                edges.push(EdgeDto {
-                    from: node.id.clone(),
-                    to: callee.clone(),
-                    label: Some("call".to_string()),
-                });
+        let edges = cg.edges().map(|(from, to)| {
+            EdgeDto {
+                from: cg.id(from).to_string(),
+                to: cg.id(to).to_string(),
+                label: Some("call".to_string()),
             }
-        }
+        }).collect();
 
         GraphDto { nodes, edges }
     }
 }
+
+impl From<&GraphDelta> for GraphDeltaDto {
+    fn from(delta: &GraphDelta) -> Self {
+        let edge = |(from, to): &(String, String)| EdgeDto {
+            from: from.clone(),
+            to: to.clone(),
+            label: Some("call".to_string()),
+        };
+
+        GraphDeltaDto {
+            added_nodes: delta.added_nodes.iter().map(|(id, label)| NodeDto {
+                id: id.clone(),
+                label: label.clone().unwrap_or_else(|| id.clone()),
+                package: None,
+                location: None,
+            }).collect(),
+            removed_nodes: delta.removed_nodes.clone(),
+            added_edges: delta.added_edges.iter().map(edge).collect(),
+            removed_edges: delta.removed_edges.iter().map(edge).collect(),
+        }
+    }
+}
@@ -1,2 +1,3 @@
 pub mod dto;
 pub mod server;
+pub mod session;
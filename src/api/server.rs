@@ -1,11 +1,19 @@
 use std::io::{BufRead, BufReader, Write};
 use std::net::{TcpListener, TcpStream};
+use std::sync::{Arc, Mutex};
 use std::thread;
 use anyhow::{Context, Result};
 use serde::Deserialize;
 use serde_json::json;
-use crate::infrastructure::scip_runner;
+use crate::api::dto::GraphDeltaDto;
+use crate::api::session::{ClientWriter, DaemonState};
+use crate::domain::delta::GraphDelta;
 use crate::domain::language::Language;
+use crate::domain::spatial::Rect;
+use crate::domain::trace::{self, TraceLimits};
+use crate::infrastructure::profiler;
+use crate::infrastructure::scheduler::{Priority, Scheduler};
+use crate::infrastructure::snapshot::GraphSnapshot;
 use std::path::PathBuf;
 
 #[derive(Debug, Deserialize)]
@@ -21,11 +29,14 @@ pub fn start_server(port: u16) -> Result<()> {
 
     println!("TraceCraft Daemon listening on {}", address);
 
+    let state = Arc::new(DaemonState::default());
+
     for stream in listener.incoming() {
         match stream {
             Ok(stream) => {
+                let state = state.clone();
                 thread::spawn(move || {
-                    if let Err(e) = handle_connection(stream) {
+                    if let Err(e) = handle_connection(stream, &state) {
                         eprintln!("[API] Connection error: {}", e);
                     }
                 });
@@ -37,14 +48,26 @@ pub fn start_server(port: u16) -> Result<()> {
     Ok(())
 }
 
-fn handle_connection(mut stream: TcpStream) -> Result<()> {
-    // Clone stream for reading/writing
+fn handle_connection(stream: TcpStream, state: &DaemonState) -> Result<()> {
+    // Clone stream for reading/writing; the writer is shared with push notifications
     let mut reader = BufReader::new(stream.try_clone()?);
+    let writer: ClientWriter = Arc::new(Mutex::new(stream));
     let mut line = String::new();
 
+    let result = serve_requests(&mut reader, &writer, &mut line, state);
+    state.disconnect(&writer);
+    result
+}
+
+fn serve_requests(
+    reader: &mut BufReader<TcpStream>,
+    writer: &ClientWriter,
+    line: &mut String,
+    state: &DaemonState,
+) -> Result<()> {
     loop {
         line.clear();
-        let bytes_read = reader.read_line(&mut line)?;
+        let bytes_read = reader.read_line(line)?;
         if bytes_read == 0 {
             break; // Connection closed
         }
@@ -54,7 +77,7 @@ fn handle_connection(mut stream: TcpStream) -> Result<()> {
             continue;
         }
 
-        let response = match process_command(trimmed) {
+        let response = match process_command(trimmed, state, writer) {
             Ok(data) => json!({
                 "status": "success",
                 "data": data
@@ -66,8 +89,11 @@ fn handle_connection(mut stream: TcpStream) -> Result<()> {
         };
 
         let response_str = serde_json::to_string(&response)?;
-        stream.write_all(response_str.as_bytes())?;
-        stream.write_all(b"\n")?;
+        {
+            let mut stream = writer.lock().unwrap();
+            stream.write_all(response_str.as_bytes())?;
+            stream.write_all(b"\n")?;
+        }
         
         // Handle SHUTDOWN specially to break loop? 
         // Or client closes connection.
@@ -82,26 +108,55 @@ fn handle_connection(mut stream: TcpStream) -> Result<()> {
     Ok(())
 }
 
-fn process_command(json_str: &str) -> Result<serde_json::Value> {
+fn process_command(json_str: &str, state: &DaemonState, client: &ClientWriter) -> Result<serde_json::Value> {
     let req: CommandReq = serde_json::from_str(json_str)
         .context("Invalid JSON format")?;
 
     match req.command.as_str() {
         "PING" => Ok(json!("PONG")),
-        "ANALYZE" => handle_analyze(req.params),
+        "ANALYZE" => handle_analyze(req.params, state),
+        "SUBSCRIBE" => handle_subscribe(req.params, state, client),
+        "UNSUBSCRIBE" => handle_unsubscribe(req.params, state, client),
+        "NEIGHBORS" => handle_neighbors(req.params, state),
+        "CALLERS" => handle_callers(req.params, state),
+        "TRACE" => handle_trace(req.params, state),
+        "PATH_STATS" => handle_path_stats(req.params, state),
+        "FLOWCHART" => handle_flowchart(req.params, state),
+        "DOMINATORS" => handle_dominators(req.params, state),
+        "REACHABLE" => handle_reachable(req.params, state),
+        "UNREACHABLE" => handle_unreachable(req.params, state),
+        "DIFF" => handle_diff(req.params, state),
+        "EXPORT" => handle_export(req.params, state, client),
+        "VIEWPORT" => handle_viewport(req.params, state),
+        "PROFILE" => handle_profile(req.params),
         "SHUTDOWN" => Ok(json!("Shutting down...")),
         _ => anyhow::bail!("Unknown command: {}", req.command),
     }
 }
 
-fn handle_analyze(params: Option<serde_json::Value>) -> Result<serde_json::Value> {
-    let params = params.ok_or_else(|| anyhow::anyhow!("Missing params for ANALYZE"))?;
-    
+/// Workspace path and language shared by workspace-scoped commands.
+fn workspace_params(params: &Option<serde_json::Value>, command: &str) -> Result<(PathBuf, Language)> {
+    let params = params.as_ref().ok_or_else(|| anyhow::anyhow!("Missing params for {}", command))?;
+
     let path_str = params.get("path")
         .and_then(|v| v.as_str())
         .ok_or_else(|| anyhow::anyhow!("Missing 'path' param"))?;
 
-    let engine_str = params.get("engine")
+    let workspace_path = PathBuf::from(path_str);
+    if !workspace_path.exists() {
+         anyhow::bail!("Workspace path not found: {}", path_str);
+    }
+
+    // Assume Rust unless told otherwise
+    let lang_str = params.get("lang").and_then(|v| v.as_str()).unwrap_or("rust");
+    let lang = Language::from_str(lang_str).unwrap_or(Language::Rust);
+
+    Ok((workspace_path, lang))
+}
+
+fn handle_analyze(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let engine_str = params.as_ref()
+        .and_then(|p| p.get("engine"))
         .and_then(|v| v.as_str())
         .unwrap_or("scip");
 
@@ -110,33 +165,395 @@ fn handle_analyze(params: Option<serde_json::Value>) -> Result<serde_json::Value
         anyhow::bail!("Only 'scip' engine is supported in daemon mode");
     }
 
-    let workspace_path = PathBuf::from(path_str);
-    if !workspace_path.exists() {
-         anyhow::bail!("Workspace path not found: {}", path_str);
+    let (workspace_path, lang) = workspace_params(&params, "ANALYZE")?;
+
+    println!("[API] Analyzing: {}", workspace_path.display());
+
+    // Full re-analysis; the result becomes the workspace's resident graph
+    // Large graphs can be explored through VIEWPORT instead of shipped whole
+    let include_graph = params.as_ref()
+        .and_then(|p| p.get("include_graph"))
+        .and_then(|v| v.as_bool())
+        .unwrap_or(true);
+
+    let session = state.session(&workspace_path, lang);
+    session.analyze()?;
+
+    if !include_graph {
+        let (node_count, edge_count) = session.graph_stats().unwrap_or((0, 0));
+        return Ok(json!({
+            "node_count": node_count,
+            "edge_count": edge_count,
+        }));
     }
-    
-    println!("[API] Analyzing: {}", path_str);
-    
-    // 1. Generate SCIP index
-    // Assume Rust for now, or infer from params
-    let lang_str = params.get("lang").and_then(|v| v.as_str()).unwrap_or("rust");
-    let lang = match lang_str {
-        "python" => Language::Python,
-        _ => Language::Rust,
+    Ok(serde_json::to_value(session.graph_dto()?)?)
+}
+
+/// Start pushing `graph_delta` events for a workspace to this connection.
+/// Replies with the current graph so the client has a base to patch.
+fn handle_subscribe(params: Option<serde_json::Value>, state: &DaemonState, client: &ClientWriter) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "SUBSCRIBE")?;
+
+    println!("[API] Subscribing to: {}", workspace_path.display());
+
+    let session = state.session(&workspace_path, lang);
+    let graph_dto = session.graph_dto()?;
+    session.subscribe(client.clone())?;
+
+    Ok(json!({
+        "path": session.root().display().to_string(),
+        "graph": graph_dto,
+    }))
+}
+
+fn handle_unsubscribe(params: Option<serde_json::Value>, state: &DaemonState, client: &ClientWriter) -> Result<serde_json::Value> {
+    let (workspace_path, _) = workspace_params(&params, "UNSUBSCRIBE")?;
+
+    if let Some(session) = state.existing_session(&workspace_path) {
+        session.unsubscribe(client);
+    }
+    Ok(json!("Unsubscribed"))
+}
+
+/// Direct callers/callees of a node. Runs on the interactive pool so it is
+/// answered promptly even while a background reindex is running.
+fn handle_neighbors(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "NEIGHBORS")?;
+
+    let id = params.as_ref()
+        .and_then(|p| p.get("id"))
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'id' param"))?;
+
+    let session = state.session(&workspace_path, lang);
+    let neighbors = Scheduler::global().run(Priority::Interactive, || session.neighbors(id))?;
+
+    Ok(serde_json::to_value(neighbors)?)
+}
+
+/// Deepest accepted CALLERS walk.
+const MAX_CALLERS_DEPTH: u64 = 64;
+
+/// Transitive callers of a node ("who calls this"), `depth` hops deep
+/// (default 1). Interactive, like NEIGHBORS.
+fn handle_callers(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "CALLERS")?;
+
+    let id = params.as_ref()
+        .and_then(|p| p.get("id"))
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'id' param"))?;
+
+    let depth = params.as_ref()
+        .and_then(|p| p.get("depth"))
+        .and_then(|v| v.as_u64())
+        .unwrap_or(1);
+    if depth == 0 || depth > MAX_CALLERS_DEPTH {
+        anyhow::bail!("'depth' must be in [1, {}]", MAX_CALLERS_DEPTH);
+    }
+
+    let session = state.session(&workspace_path, lang);
+    let callers = Scheduler::global().run(Priority::Interactive, || session.callers(id, depth as usize))?;
+
+    Ok(serde_json::to_value(callers)?)
+}
+
+/// Largest accepted TRACE limits.
+const MAX_TRACE_PATHS: usize = 10_000;
+const MAX_TRACE_DEPTH: usize = 256;
+
+/// Call paths from `id` (default: main), bounded by `max_paths` and
+/// `max_depth`.
+fn handle_trace(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "TRACE")?;
+
+    let root = params.as_ref()
+        .and_then(|p| p.get("id"))
+        .and_then(|v| v.as_str());
+
+    let limit = |key: &str, default: usize, max: usize| -> Result<usize> {
+        let value = params.as_ref()
+            .and_then(|p| p.get(key))
+            .and_then(|v| v.as_u64())
+            .map(|v| v as usize)
+            .unwrap_or(default);
+        if value == 0 || value > max {
+            anyhow::bail!("'{}' must be in [1, {}]", key, max);
+        }
+        Ok(value)
+    };
+    let limits = TraceLimits {
+        max_paths: limit("max_paths", trace::DEFAULT_MAX_PATHS, MAX_TRACE_PATHS)?,
+        max_depth: limit("max_depth", trace::DEFAULT_TRACE_DEPTH, MAX_TRACE_DEPTH)?,
+    };
+
+    let session = state.session(&workspace_path, lang);
+    let traced = Scheduler::global().run(Priority::Interactive, || session.trace(root, limits))?;
+
+    Ok(serde_json::to_value(traced)?)
+}
+
+/// Number of call paths and min/max depth from the entry set to a node,
+/// without listing the paths. Interactive.
+fn handle_path_stats(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "PATH_STATS")?;
+
+    let id = params.as_ref()
+        .and_then(|p| p.get("id"))
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'id' param"))?;
+
+    let entries: Vec<String> = params.as_ref()
+        .and_then(|p| p.get("entries"))
+        .and_then(|v| v.as_array())
+        .map(|a| a.iter().filter_map(|e| e.as_str().map(String::from)).collect())
+        .unwrap_or_default();
+
+    let session = state.session(&workspace_path, lang);
+    let stats = Scheduler::global().run(Priority::Interactive, || session.path_stats(id, &entries))?;
+
+    Ok(serde_json::to_value(stats)?)
+}
+
+/// Deepest accepted FLOWCHART expansion.
+const MAX_FLOWCHART_DEPTH: u64 = 256;
+
+/// Flowchart from the entry set to `depth` (default 10, like the CLI's
+/// `--max-depth`). Depth changes on the same entries are incremental.
+fn handle_flowchart(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "FLOWCHART")?;
+
+    let entries: Vec<String> = params.as_ref()
+        .and_then(|p| p.get("entries"))
+        .and_then(|v| v.as_array())
+        .map(|a| a.iter().filter_map(|e| e.as_str().map(String::from)).collect())
+        .unwrap_or_default();
+
+    let depth = params.as_ref()
+        .and_then(|p| p.get("depth"))
+        .and_then(|v| v.as_u64())
+        .unwrap_or(10);
+    if depth > MAX_FLOWCHART_DEPTH {
+        anyhow::bail!("'depth' must be in [0, {}]", MAX_FLOWCHART_DEPTH);
+    }
+
+    let session = state.session(&workspace_path, lang);
+    let chart = Scheduler::global().run(Priority::Interactive, || session.flowchart(&entries, depth as usize))?;
+
+    Ok(serde_json::to_value(chart)?)
+}
+
+/// Chokepoints on the way into and out of a node. Interactive; trees are
+/// cached by the session.
+fn handle_dominators(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "DOMINATORS")?;
+
+    let id = params.as_ref()
+        .and_then(|p| p.get("id"))
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'id' param"))?;
+
+    let entries: Vec<String> = params.as_ref()
+        .and_then(|p| p.get("entries"))
+        .and_then(|v| v.as_array())
+        .map(|a| a.iter().filter_map(|e| e.as_str().map(String::from)).collect())
+        .unwrap_or_default();
+
+    let session = state.session(&workspace_path, lang);
+    let dominators = Scheduler::global().run(Priority::Interactive, || session.dominators(id, &entries))?;
+
+    Ok(serde_json::to_value(dominators)?)
+}
+
+fn handle_reachable(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "REACHABLE")?;
+
+    let node = |key: &str| -> Result<&str> {
+        params.as_ref()
+            .and_then(|p| p.get(key))
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| anyhow::anyhow!("Missing '{}' param", key))
+    };
+    let (from, to) = (node("from")?, node("to")?);
+
+    let session = state.session(&workspace_path, lang);
+    let answer = Scheduler::global().run(Priority::Interactive, || session.reachable(from, to))?;
+
+    Ok(serde_json::to_value(answer)?)
+}
+
+fn handle_unreachable(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "UNREACHABLE")?;
+
+    let entries: Vec<String> = params.as_ref()
+        .and_then(|p| p.get("entries"))
+        .and_then(|v| v.as_array())
+        .map(|a| a.iter().filter_map(|e| e.as_str().map(String::from)).collect())
+        .unwrap_or_default();
+
+    let session = state.session(&workspace_path, lang);
+    let report = Scheduler::global().run(Priority::Interactive, || session.unreachable(&entries))?;
+
+    Ok(serde_json::to_value(report)?)
+}
+
+/// Delta from the `old` snapshot to the `new` one, or to the resident
+/// graph of `path` when no `new` snapshot is given.
+fn handle_diff(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let param = |key: &str| params.as_ref().and_then(|p| p.get(key)).and_then(|v| v.as_str());
+    let old_path = param("old").ok_or_else(|| anyhow::anyhow!("Missing 'old' param"))?;
+
+    // Loads and compares whole snapshots: background work, so it yields to
+    // interactive queries instead of holding them off
+    let delta = Scheduler::global().run(Priority::Background, || -> Result<GraphDelta> {
+        let old = GraphSnapshot::load(old_path.as_ref())?;
+        match param("new") {
+            Some(new_path) => {
+                let new = GraphSnapshot::load(new_path.as_ref())?;
+                Ok(GraphDelta::between(&old.graph, &new.graph))
+            }
+            None => {
+                let (workspace_path, lang) = workspace_params(&params, "DIFF")?;
+                state.session(&workspace_path, lang).diff_from(&old.graph)
+            }
+        }
+    })?;
+
+    Ok(serde_json::to_value(GraphDeltaDto::from(&delta))?)
+}
+
+/// Approximate payload of one `export_chunk` event.
+const EXPORT_CHUNK_BYTES: usize = 64 * 1024;
+
+/// Write the resident graph as DOT straight to this client as
+/// `export_chunk` events sent ahead of the reply, never holding the whole
+/// document in memory. The daemon writes no files on a client's behalf.
+fn handle_export(params: Option<serde_json::Value>, state: &DaemonState, client: &ClientWriter) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "EXPORT")?;
+    let format = params.as_ref().and_then(|p| p.get("format")).and_then(|v| v.as_str()).unwrap_or("dot");
+    if format != "dot" {
+        anyhow::bail!("Unsupported export format: {} (only dot)", format);
+    }
+
+    let session = state.session(&workspace_path, lang);
+    let mut stream = EventStream::new(client, &workspace_path);
+    Scheduler::global().run(Priority::Background, || session.export_dot(&mut stream))?;
+    Ok(json!({ "format": format, "chunks": stream.chunks, "bytes": stream.bytes }))
+}
+
+/// `io::Write` that forwards output to a client as `export_chunk` event
+/// lines, cut at line ends so every chunk is valid UTF-8.
+struct EventStream<'a> {
+    client: &'a ClientWriter,
+    path: String,
+    buf: Vec<u8>,
+    chunks: usize,
+    bytes: usize,
+}
+
+impl<'a> EventStream<'a> {
+    fn new(client: &'a ClientWriter, path: &std::path::Path) -> Self {
+        Self {
+            client,
+            path: path.display().to_string(),
+            buf: Vec::with_capacity(EXPORT_CHUNK_BYTES * 2),
+            chunks: 0,
+            bytes: 0,
+        }
+    }
+
+    fn send(&mut self, chunk: Vec<u8>) -> std::io::Result<()> {
+        let text = String::from_utf8(chunk)
+            .map_err(|e| std::io::Error::new(std::io::ErrorKind::InvalidData, e))?;
+        let line = serde_json::to_string(&json!({
+            "event": "export_chunk",
+            "path": self.path,
+            "data": text,
+        }))?;
+        let mut stream = self.client.lock().unwrap();
+        stream.write_all(line.as_bytes())?;
+        stream.write_all(b"\n")?;
+        self.chunks += 1;
+        Ok(())
+    }
+}
+
+impl Write for EventStream<'_> {
+    fn write(&mut self, data: &[u8]) -> std::io::Result<usize> {
+        self.buf.extend_from_slice(data);
+        self.bytes += data.len();
+        if self.buf.len() >= EXPORT_CHUNK_BYTES {
+            if let Some(end) = self.buf.iter().rposition(|&b| b == b'\n') {
+                let rest = self.buf.split_off(end + 1);
+                let chunk = std::mem::replace(&mut self.buf, rest);
+                self.send(chunk)?;
+            }
+        }
+        Ok(data.len())
+    }
+
+    fn flush(&mut self) -> std::io::Result<()> {
+        if !self.buf.is_empty() {
+            let chunk = std::mem::take(&mut self.buf);
+            self.send(chunk)?;
+        }
+        Ok(())
+    }
+}
+
+/// Visible slice of the laid-out graph for `x0 y0 x1 y1` at `zoom`.
+fn handle_viewport(params: Option<serde_json::Value>, state: &DaemonState) -> Result<serde_json::Value> {
+    let (workspace_path, lang) = workspace_params(&params, "VIEWPORT")?;
+
+    let number = |key: &str| -> Result<f64> {
+        params.as_ref()
+            .and_then(|p| p.get(key))
+            .and_then(|v| v.as_f64())
+            .ok_or_else(|| anyhow::anyhow!("Missing '{}' param", key))
     };
-    
-    let index_path = scip_runner::generate_scip_index_for_language(
-        &workspace_path, 
-        lang,
-        &[] // No specific file filtering yet
-    )?;
-
-    // 2. Ingest
-    let callgraph = crate::domain::scip_ingest::ScipIngestor::ingest_and_build_graph(&index_path)
-        .context("Failed to ingest SCIP index")?;
-
-    // 3. Convert to DTO
-    let graph_dto = crate::api::dto::GraphDto::from(callgraph);
-    
-    Ok(serde_json::to_value(graph_dto)?)
+    let window = Rect::new(number("x0")?, number("y0")?, number("x1")?, number("y1")?);
+    let zoom = number("zoom").unwrap_or(1.0);
+
+    let session = state.session(&workspace_path, lang);
+    let viewport = Scheduler::global().run(Priority::Interactive, || session.viewport(&window, zoom))?;
+
+    Ok(serde_json::to_value(viewport)?)
+}
+
+/// Longest accepted PROFILE session.
+const MAX_PROFILE_SECONDS: f64 = 60.0;
+
+/// Sample the daemon's own threads and return folded stacks.
+///
+/// Blocks only this connection; other clients keep being served (and
+/// sampled) while the profile is collected.
+fn handle_profile(params: Option<serde_json::Value>) -> Result<serde_json::Value> {
+    let seconds = params.as_ref()
+        .and_then(|p| p.get("seconds"))
+        .and_then(|v| v.as_f64())
+        .unwrap_or(5.0);
+    if !(seconds > 0.0 && seconds <= MAX_PROFILE_SECONDS) {
+        anyhow::bail!("'seconds' must be in (0, {}]", MAX_PROFILE_SECONDS);
+    }
+
+    let frequency = params.as_ref()
+        .and_then(|p| p.get("frequency"))
+        .and_then(|v| v.as_u64())
+        .unwrap_or(profiler::DEFAULT_FREQUENCY_HZ as u64);
+    if !(1..=profiler::MAX_FREQUENCY_HZ as u64).contains(&frequency) {
+        anyhow::bail!("'frequency' must be in [1, {}]", profiler::MAX_FREQUENCY_HZ);
+    }
+    let frequency = frequency as u32;
+
+    let profile = profiler::profile(std::time::Duration::from_secs_f64(seconds), frequency)?;
+    let folded = profile.to_folded();
+
+    Ok(json!({
+        "samples": profile.samples,
+        "dropped": profile.dropped,
+        "duration_ms": profile.duration.as_millis() as u64,
+        "frequency_hz": profile.frequency_hz,
+        "format": "folded",
+        "folded": folded,
+    }))
 }
@@ -0,0 +1,786 @@
+/// Daemon Workspace Sessions.
+///
+/// Keeps one resident call graph per analyzed workspace so that repeated
+/// requests and file-change notifications do not start from scratch, and
+/// fans graph deltas out to every subscribed connection.
+
+use std::collections::HashMap;
+use std::io::Write;
+use std::net::TcpStream;
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Mutex, RwLock, Weak};
+use anyhow::{Context, Result};
+use serde_json::json;
+
+use crate::api::dto::{CallersDto, DominatorsDto, FlowEdgeDto, FlowNodeDto, FlowchartDto, GraphDeltaDto, GraphDto, NeighborsDto, PathStatsDto, ReachableDto, TraceDto, TraceStepDto, UnreachableDto, UnreachableGroupDto, ViewportDto, ViewportEdgeDto, ViewportNodeDto};
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use crate::domain::condense::{Condensation, PathStats};
+use crate::domain::delta::GraphDelta;
+use crate::domain::dominators::Dominators;
+use crate::domain::entry_point::{EntryPoint, EntryPointDetector, EntryPointKind};
+use crate::domain::flowgraph::FlowExpansion;
+use crate::domain::language::Language;
+use crate::domain::reachability::ReachabilityIndex;
+use crate::domain::scip_ingest::IncrementalIngestor;
+use crate::domain::spatial::Rect;
+use crate::domain::trace::{self, TraceGenerator, TraceLimits};
+use crate::domain::unreachable::{self, UnreachableReport};
+use crate::domain::viewport::{ViewportIndex, ViewportItem};
+use crate::infrastructure::DotExporter;
+use crate::infrastructure::scip_cache::ScipCache;
+use crate::infrastructure::scheduler::{Priority, Scheduler};
+use crate::infrastructure::scip_runner;
+use crate::infrastructure::snapshot::GraphSnapshot;
+use crate::infrastructure::source_manager::SourceManager;
+use crate::infrastructure::watcher::{self, WorkspaceWatcher};
+use crate::ports::OutputExporter;
+
+/// Write half of a client connection, shared between the request loop and
+/// push notifications so lines are never interleaved.
+pub type ClientWriter = Arc<Mutex<TcpStream>>;
+
+/// Process-wide daemon state shared by all connections.
+#[derive(Default)]
+pub struct DaemonState {
+    sessions: Mutex<HashMap<PathBuf, Arc<WorkspaceSession>>>,
+}
+
+impl DaemonState {
+    /// Get the session for a workspace, creating an empty one if needed.
+    pub fn session(&self, root: &Path, language: Language) -> Arc<WorkspaceSession> {
+        let key = root.canonicalize().unwrap_or_else(|_| root.to_path_buf());
+        let mut sessions = self.sessions.lock().unwrap();
+        sessions
+            .entry(key.clone())
+            .or_insert_with(|| Arc::new(WorkspaceSession::new(key, language)))
+            .clone()
+    }
+
+    /// Look up an existing session without creating one.
+    pub fn existing_session(&self, root: &Path) -> Option<Arc<WorkspaceSession>> {
+        let key = root.canonicalize().unwrap_or_else(|_| root.to_path_buf());
+        self.sessions.lock().unwrap().get(&key).cloned()
+    }
+
+    /// Drop a closed connection from every session it subscribed to.
+    pub fn disconnect(&self, client: &ClientWriter) {
+        let sessions: Vec<Arc<WorkspaceSession>> =
+            self.sessions.lock().unwrap().values().cloned().collect();
+        for session in sessions {
+            session.unsubscribe(client);
+        }
+    }
+}
+
+/// A value derived from one resident graph, remembered with the graph it
+/// was built from. Lookups with any other graph miss, so a value finished
+/// after its graph was replaced is never served for the successor; the
+/// weak key does not keep a replaced graph alive.
+struct PerGraph<T> {
+    slot: Mutex<Option<(Weak<CallGraph>, T)>>,
+}
+
+impl<T: Clone> PerGraph<T> {
+    fn new() -> Self {
+        Self { slot: Mutex::new(None) }
+    }
+
+    fn get(&self, graph: &Arc<CallGraph>) -> Option<T> {
+        match self.slot.lock().unwrap().as_ref() {
+            Some((built_for, value)) if built_for.as_ptr() == Arc::as_ptr(graph) => Some(value.clone()),
+            _ => None,
+        }
+    }
+
+    /// The cached value for `graph`, else `build()` run without any lock
+    /// held and then cached.
+    fn get_or_build(&self, graph: &Arc<CallGraph>, build: impl FnOnce() -> T) -> T {
+        if let Some(value) = self.get(graph) {
+            return value;
+        }
+        let value = build();
+        *self.slot.lock().unwrap() = Some((Arc::downgrade(graph), value.clone()));
+        value
+    }
+
+    fn clear(&self) {
+        *self.slot.lock().unwrap() = None;
+    }
+}
+
+/// A workspace with a resident graph, its subscribers and its file watcher.
+pub struct WorkspaceSession {
+    root: PathBuf,
+    language: Language,
+    /// Shared so long readers (exports) can work from a snapshot without
+    /// holding the lock
+    graph: RwLock<Option<Arc<CallGraph>>>,
+    /// Layout and spatial index for the resident graph, replaced with it
+    viewport: RwLock<Option<Arc<ViewportIndex>>>,
+    /// SCC condensation of the resident graph, built on first use
+    condensation: PerGraph<Arc<Condensation>>,
+    /// Flowchart expansion, the graph it expands and the entry ids it was
+    /// started from, kept so depth changes only compute new layers
+    flow: Mutex<Option<(Weak<CallGraph>, Vec<String>, FlowExpansion)>>,
+    /// Dominator trees of the resident graph by entry set, built on first use
+    dominators: PerGraph<Arc<Mutex<HashMap<Vec<NodeIdx>, Arc<Dominators>>>>>,
+    post_dominators: PerGraph<Arc<Dominators>>,
+    /// Reachability labels of the resident graph, built alongside the layout
+    reachability: RwLock<Option<Arc<ReachabilityIndex>>>,
+    /// Entry points detected in the sources, resolved against the graph
+    /// they were found for; scanned on first use, not per request
+    entry_roots: PerGraph<Arc<Vec<(NodeIdx, EntryPointKind)>>>,
+    subscribers: Mutex<Vec<ClientWriter>>,
+    watcher: Mutex<Option<WorkspaceWatcher>>,
+    /// Per-document SCIP contributions, so a file change re-ingests only
+    /// the documents whose content changed; seeded by `analyze`, or by the
+    /// first change when the graph came from a snapshot
+    ingest: Mutex<IncrementalIngestor>,
+    /// Serializes re-analysis so watcher batches and ANALYZE never overlap
+    analysis_lock: Mutex<()>,
+}
+
+impl WorkspaceSession {
+    fn new(root: PathBuf, language: Language) -> Self {
+        Self {
+            root,
+            language,
+            graph: RwLock::new(None),
+            viewport: RwLock::new(None),
+            condensation: PerGraph::new(),
+            flow: Mutex::new(None),
+            dominators: PerGraph::new(),
+            post_dominators: PerGraph::new(),
+            reachability: RwLock::new(None),
+            entry_roots: PerGraph::new(),
+            subscribers: Mutex::new(Vec::new()),
+            watcher: Mutex::new(None),
+            ingest: Mutex::new(IncrementalIngestor::new()),
+            analysis_lock: Mutex::new(()),
+        }
+    }
+
+    pub fn root(&self) -> &Path {
+        &self.root
+    }
+
+    /// Run a full analysis, replace the resident graph and notify
+    /// subscribers of what changed. A snapshot at least as new as the SCIP
+    /// index is loaded instead of re-ingesting.
+    pub fn analyze(&self) -> Result<()> {
+        let _guard = self.analysis_lock.lock().unwrap();
+
+        let (graph, reachability, snapshot_path) = Scheduler::global().run(Priority::Background, || -> Result<_> {
+            let index_path = scip_runner::generate_scip_index_for_language(&self.root, self.language, &[])?;
+            let snapshot_path = GraphSnapshot::path_for_index(&index_path);
+            if let Some(snapshot) = GraphSnapshot::load_if_current(&snapshot_path, &index_path) {
+                return Ok((snapshot.graph, snapshot.reachability, snapshot_path));
+            }
+            // Through the incremental ingestor, so it is seeded and the
+            // first file change re-ingests only what changed
+            let (graph, _) = self.ingest.lock().unwrap().update(&index_path)
+                .context("Failed to ingest SCIP index")?;
+            Ok((graph, None, snapshot_path))
+        })?;
+
+        self.replace_graph(graph, reachability, Some(&snapshot_path), &[]);
+        Ok(())
+    }
+
+    /// Return the resident graph, analyzing first if there is none yet.
+    pub fn graph_dto(&self) -> Result<GraphDto> {
+        if self.graph.read().unwrap().is_none() {
+            self.analyze()?;
+        }
+        let graph = self.graph.read().unwrap();
+        graph.as_deref()
+            .map(GraphDto::from)
+            .ok_or_else(|| anyhow::anyhow!("Analysis produced no graph"))
+    }
+
+    /// The resident graph, shared. Long computations work from this
+    /// snapshot so they never hold the lock a replacement needs.
+    fn resident(&self) -> Result<Arc<CallGraph>> {
+        self.graph.read().unwrap().clone().ok_or_else(|| {
+            anyhow::anyhow!("Workspace not analyzed yet: {} (send ANALYZE or SUBSCRIBE first)", self.root.display())
+        })
+    }
+
+    /// `(nodes, edges)` of the resident graph, if analyzed.
+    pub fn graph_stats(&self) -> Option<(usize, usize)> {
+        self.graph.read().unwrap().as_ref().map(|g| {
+            (g.node_count(), g.edge_count())
+        })
+    }
+
+    /// Direct callers and callees of `id` in the resident graph.
+    ///
+    /// Interactive: never triggers an analysis, so it cannot queue behind one.
+    pub fn neighbors(&self, id: &str) -> Result<NeighborsDto> {
+        let graph = self.graph.read().unwrap();
+        let graph = graph.as_deref().ok_or_else(|| {
+            anyhow::anyhow!("Workspace not analyzed yet: {} (send ANALYZE or SUBSCRIBE first)", self.root.display())
+        })?;
+
+        let node = graph
+            .idx_of(id)
+            .filter(|&n| graph.is_defined(n))
+            .ok_or_else(|| anyhow::anyhow!("Node not found: {}", id))?;
+
+        let callers = graph
+            .callers(node)
+            .iter()
+            .map(|&n| graph.id(n).to_string())
+            .collect();
+
+        Ok(NeighborsDto {
+            id: id.to_string(),
+            callers,
+            callees: graph.callees(node).iter().map(|&c| graph.id(c).to_string()).collect(),
+        })
+    }
+
+    /// Transitive callers of `id` up to `depth` hops, one list per hop.
+    ///
+    /// Walks the graph's reverse index, so each hop costs the in-degree of
+    /// the frontier. Unlike `neighbors`, external callees may be queried.
+    pub fn callers(&self, id: &str, depth: usize) -> Result<CallersDto> {
+        let graph = self.graph.read().unwrap();
+        let graph = graph.as_deref().ok_or_else(|| {
+            anyhow::anyhow!("Workspace not analyzed yet: {} (send ANALYZE or SUBSCRIBE first)", self.root.display())
+        })?;
+
+        let target = graph
+            .idx_of(id)
+            .ok_or_else(|| anyhow::anyhow!("Node not found: {}", id))?;
+
+        let mut seen = vec![false; graph.vertex_count()];
+        seen[target as usize] = true;
+        let mut frontier = vec![target];
+        let mut levels = Vec::new();
+        for _ in 0..depth {
+            let mut next = Vec::new();
+            for &node in &frontier {
+                for &caller in graph.callers(node) {
+                    if !seen[caller as usize] {
+                        seen[caller as usize] = true;
+                        next.push(caller);
+                    }
+                }
+            }
+            if next.is_empty() {
+                break;
+            }
+            levels.push(next.iter().map(|&n| graph.id(n).to_string()).collect());
+            frontier = next;
+        }
+
+        Ok(CallersDto { id: id.to_string(), levels })
+    }
+
+    /// Call paths from `root` (default: the workspace's `main`) within
+    /// `limits`. Sources are not kept resident, so steps carry locations
+    /// but no snippets. Enumerates from a snapshot of the graph, so a long
+    /// enumeration does not hold up a graph replacement.
+    pub fn trace(&self, root: Option<&str>, limits: TraceLimits) -> Result<TraceDto> {
+        let graph = self.resident()?;
+        let graph = &*graph;
+
+        let root = match root {
+            Some(id) => graph.idx_of(id).ok_or_else(|| anyhow::anyhow!("Node not found: {}", id))?,
+            None => trace::find_main(graph)
+                .ok_or_else(|| anyhow::anyhow!("No main() found; pass 'id' to choose a root"))?,
+        };
+        let root_id = graph.id(root);
+
+        let sources = SourceManager::new(&[]);
+        let paths = TraceGenerator::with_limits(graph, &sources, limits).enumerate(root_id);
+
+        Ok(TraceDto {
+            root: root_id.to_string(),
+            paths: paths.iter().map(|path| {
+                path.steps().iter().map(|step| TraceStepDto {
+                    id: step.id().to_string(),
+                    location: step.location(),
+                    depth: step.depth(),
+                    note: step.note().map(str::to_string),
+                }).collect()
+            }).collect(),
+        })
+    }
+
+    /// Path count and min/max depth of `id` from `entries` (default: the
+    /// workspace's `main`), by one DP pass over the condensed graph. Works
+    /// from a snapshot of the graph, so neither the condensation nor the
+    /// DP holds the graph lock.
+    pub fn path_stats(&self, id: &str, entries: &[String]) -> Result<PathStatsDto> {
+        let snapshot = self.resident()?;
+        let graph = &*snapshot;
+
+        let target = graph.idx_of(id).ok_or_else(|| anyhow::anyhow!("Node not found: {}", id))?;
+        let entries = if entries.is_empty() {
+            vec![trace::find_main(graph)
+                .ok_or_else(|| anyhow::anyhow!("No main() found; pass 'entries' to choose roots"))?]
+        } else {
+            entries.iter()
+                .map(|e| graph.idx_of(e).ok_or_else(|| anyhow::anyhow!("Node not found: {}", e)))
+                .collect::<Result<Vec<_>>>()?
+        };
+
+        let condensation = self.condensation(&snapshot);
+        let stats = PathStats::compute(&condensation, &entries);
+        let node = stats.node(target);
+
+        Ok(PathStatsDto {
+            id: id.to_string(),
+            entries: entries.iter().map(|&e| graph.id(e).to_string()).collect(),
+            reachable: node.is_some(),
+            path_count: node.map_or(0, |n| n.paths),
+            saturated: node.map_or(false, |n| n.saturated()),
+            min_depth: node.map(|n| n.min_depth),
+            max_depth: node.map(|n| n.max_depth),
+            recursive: condensation.is_cyclic(condensation.component(target)),
+            reachable_nodes: stats.reachable_count(),
+        })
+    }
+
+    /// Flowchart from `entries` (default: the entry points detected in the
+    /// workspace sources, else `main`) to `max_depth`. Repeating the
+    /// request with another depth reuses the saved expansion: deeper
+    /// continues from its frontier, shallower only cuts it off. Expands a
+    /// snapshot of the graph with no lock held.
+    pub fn flowchart(&self, entries: &[String], max_depth: usize) -> Result<FlowchartDto> {
+        let snapshot = self.resident()?;
+        let graph = &*snapshot;
+
+        let roots: Vec<(NodeIdx, EntryPointKind)> = if entries.is_empty() {
+            let detected = self.entry_roots(&snapshot);
+            if detected.is_empty() {
+                let main = trace::find_main(graph)
+                    .ok_or_else(|| anyhow::anyhow!("No entry points found; pass 'entries' to choose roots"))?;
+                vec![(main, EntryPointKind::Main)]
+            } else {
+                detected.to_vec()
+            }
+        } else {
+            entries.iter()
+                .map(|e| graph.idx_of(e)
+                    .map(|r| (r, EntryPointKind::ExportedFunction))
+                    .ok_or_else(|| anyhow::anyhow!("Node not found: {}", e)))
+                .collect::<Result<Vec<_>>>()?
+        };
+        let ids: Vec<String> = roots.iter().map(|&(r, _)| graph.id(r).to_string()).collect();
+
+        // Take the saved expansion out if it belongs to this graph and these
+        // entries; it goes back once this request has extended it
+        let saved = self.flow.lock().unwrap().take().filter(|(built_for, cached, _)| {
+            built_for.as_ptr() == Arc::as_ptr(&snapshot) && *cached == ids
+        });
+        let mut expansion = match saved {
+            Some((_, _, expansion)) => expansion,
+            None => {
+                let entry_points = roots.iter().map(|(r, kind)| {
+                    let location = graph.location(*r);
+                    EntryPoint {
+                        id: graph.id(*r).to_string(),
+                        name: graph.display_label(*r).to_string(),
+                        kind: kind.clone(),
+                        file_path: location.map(|l| l.file().to_string()).unwrap_or_default(),
+                        line: location.map(|l| l.line as usize),
+                    }
+                }).collect();
+                FlowExpansion::new(graph, entry_points)
+            }
+        };
+        expansion.set_max_depth(graph, max_depth);
+        let chart = expansion.flow_graph(graph);
+        let complete = expansion.is_complete();
+        *self.flow.lock().unwrap() = Some((Arc::downgrade(&snapshot), ids.clone(), expansion));
+
+        Ok(FlowchartDto {
+            entries: ids,
+            max_depth,
+            complete,
+            nodes: chart.nodes.into_iter().map(|n| FlowNodeDto {
+                id: n.id,
+                label: n.label,
+                kind: format!("{:?}", n.node_type),
+                depth: n.depth,
+            }).collect(),
+            edges: chart.edges.into_iter().map(|e| FlowEdgeDto {
+                from: e.from,
+                to: e.to,
+                sequence: e.sequence,
+            }).collect(),
+        })
+    }
+
+    /// Functions every call path from `entries` (default: the entry points
+    /// detected in the workspace sources, else `main`) to `id` must pass
+    /// through, and those every path from `id` to a leaf must pass
+    /// through. Dominator trees are built from a snapshot of the graph, with
+    /// no lock held, and cached per entry set until the graph is replaced.
+    pub fn dominators(&self, id: &str, entries: &[String]) -> Result<DominatorsDto> {
+        let snapshot = self.resident()?;
+        let graph = &*snapshot;
+
+        let target = graph.idx_of(id).ok_or_else(|| anyhow::anyhow!("Node not found: {}", id))?;
+        let mut roots = if entries.is_empty() {
+            let detected = self.entry_roots(&snapshot);
+            if detected.is_empty() {
+                vec![trace::find_main(graph)
+                    .ok_or_else(|| anyhow::anyhow!("No entry points found; pass 'entries' to choose roots"))?]
+            } else {
+                detected.iter().map(|&(v, _)| v).collect()
+            }
+        } else {
+            entries.iter()
+                .map(|e| graph.idx_of(e).ok_or_else(|| anyhow::anyhow!("Node not found: {}", e)))
+                .collect::<Result<Vec<_>>>()?
+        };
+        roots.sort_unstable();
+        roots.dedup();
+
+        let trees = self.dominators.get_or_build(&snapshot, Default::default);
+        let cached = trees.lock().unwrap().get(&roots).cloned();
+        let dom = match cached {
+            Some(dom) => dom,
+            None => {
+                let built = Arc::new(Dominators::compute(graph, &roots));
+                trees.lock().unwrap().insert(roots.clone(), built.clone());
+                built
+            }
+        };
+        let post = self.post_dominators.get_or_build(&snapshot, || Arc::new(Dominators::compute_post(graph)));
+
+        let names = |nodes: Vec<NodeIdx>| nodes.into_iter().map(|n| graph.id(n).to_string()).collect();
+        let mut exits = post.dominators(target);
+        exits.reverse();
+
+        Ok(DominatorsDto {
+            id: id.to_string(),
+            entries: names(roots),
+            reachable: dom.is_reachable(target),
+            dominators: names(dom.dominators(target)),
+            post_dominators: names(exits),
+        })
+    }
+
+    /// Whether `from` transitively calls `to`, answered from the
+    /// reachability index built with the resident graph.
+    pub fn reachable(&self, from: &str, to: &str) -> Result<ReachableDto> {
+        let graph = self.graph.read().unwrap();
+        let graph = graph.as_deref().ok_or_else(|| {
+            anyhow::anyhow!("Workspace not analyzed yet: {} (send ANALYZE or SUBSCRIBE first)", self.root.display())
+        })?;
+        let index = self.reachability.read().unwrap().clone()
+            .ok_or_else(|| anyhow::anyhow!("Reachability index not ready for {}", self.root.display()))?;
+
+        let a = graph.idx_of(from).ok_or_else(|| anyhow::anyhow!("Node not found: {}", from))?;
+        let b = graph.idx_of(to).ok_or_else(|| anyhow::anyhow!("Node not found: {}", to))?;
+        let answer = index.query(a, b);
+
+        Ok(ReachableDto {
+            from: from.to_string(),
+            to: to.to_string(),
+            reachable: answer.reachable,
+            by_index: answer.by_index,
+        })
+    }
+
+    /// Stream the resident graph as DOT into `out`. Writes from a snapshot
+    /// taken under a short lock, so a slow client cannot hold up a graph
+    /// replacement or the queries queued behind it.
+    pub fn export_dot(&self, out: &mut dyn Write) -> Result<()> {
+        let graph = self.resident()?;
+        DotExporter.write(&graph, out)?;
+        out.flush()?;
+        Ok(())
+    }
+
+    /// Delta that turns `old` into the resident graph.
+    pub fn diff_from(&self, old: &CallGraph) -> Result<GraphDelta> {
+        let graph = self.resident()?;
+        Ok(GraphDelta::between(old, &graph))
+    }
+
+    /// Defined functions that no entry reaches. Without explicit `entries`
+    /// the roots are the entry points (main, tests, routes) detected in the
+    /// workspace sources.
+    pub fn unreachable(&self, entries: &[String]) -> Result<UnreachableDto> {
+        // A snapshot, so the source scan below never runs under the lock
+        let graph = self.resident()?;
+        let detected = if entries.is_empty() { Some(self.entry_roots(&graph)) } else { None };
+        let graph = &*graph;
+
+        let roots = if let Some(detected) = detected {
+            if detected.is_empty() {
+                vec![trace::find_main(graph)
+                    .ok_or_else(|| anyhow::anyhow!("No entry points found; pass 'entries' to choose roots"))?]
+            } else {
+                detected.iter().map(|&(v, _)| v).collect()
+            }
+        } else {
+            entries.iter()
+                .map(|e| graph.idx_of(e).ok_or_else(|| anyhow::anyhow!("Node not found: {}", e)))
+                .collect::<Result<Vec<_>>>()?
+        };
+
+        let report = UnreachableReport::compute(graph, &roots);
+        let names = |nodes: &[NodeIdx]| nodes.iter().map(|&n| graph.id(n).to_string()).collect();
+
+        Ok(UnreachableDto {
+            entries: names(&report.roots),
+            reachable: report.reachable,
+            total: report.total,
+            groups: report.groups.iter().map(|g| UnreachableGroupDto {
+                crate_name: g.crate_name.clone(),
+                file: g.file.clone(),
+                functions: names(&g.functions),
+            }).collect(),
+        })
+    }
+
+    /// Detected entry points of `graph`, scanning the sources only the
+    /// first time they are asked for with this graph.
+    fn entry_roots(&self, graph: &Arc<CallGraph>) -> Arc<Vec<(NodeIdx, EntryPointKind)>> {
+        self.entry_roots.get_or_build(graph, || {
+            let detected = self.detect_entry_points();
+            Arc::new(
+                unreachable::resolve_entry_points(graph, &detected)
+                    .into_iter()
+                    .map(|(v, entry)| (v, entry.kind.clone()))
+                    .collect(),
+            )
+        })
+    }
+
+    /// Run the entry point detector over the workspace's source files.
+    fn detect_entry_points(&self) -> Vec<EntryPoint> {
+        let detector = EntryPointDetector::new(self.language);
+        let mut entries = Vec::new();
+        let mut dirs = vec![self.root.clone()];
+        while let Some(dir) = dirs.pop() {
+            let listing = match std::fs::read_dir(&dir) {
+                Ok(listing) => listing,
+                Err(_) => continue,
+            };
+            for path in listing.filter_map(|e| e.ok()).map(|e| e.path()) {
+                if path.is_dir() {
+                    if !path.ends_with("target") && !path.ends_with(".git") {
+                        dirs.push(path);
+                    }
+                } else if watcher::is_relevant(&self.root, &path, self.language.extensions()) {
+                    if let Ok(source) = std::fs::read_to_string(&path) {
+                        entries.extend(detector.detect(&path.display().to_string(), &source));
+                    }
+                }
+            }
+        }
+        entries
+    }
+
+    /// Condensation of `graph`, cached until the graph is replaced.
+    fn condensation(&self, graph: &Arc<CallGraph>) -> Arc<Condensation> {
+        self.condensation.get_or_build(graph, || Arc::new(Condensation::build(graph)))
+    }
+
+    /// Nodes and edges of the laid-out resident graph inside `window`.
+    pub fn viewport(&self, window: &Rect, zoom: f64) -> Result<ViewportDto> {
+        let graph = self.graph.read().unwrap();
+        let graph = graph.as_deref().ok_or_else(|| {
+            anyhow::anyhow!("Workspace not analyzed yet: {} (send ANALYZE or SUBSCRIBE first)", self.root.display())
+        })?;
+        let index = self.viewport.read().unwrap().clone()
+            .ok_or_else(|| anyhow::anyhow!("Layout not ready for {}", self.root.display()))?;
+
+        let view = index.query(window, zoom);
+
+        let item_id = |item: &ViewportItem| match *item {
+            ViewportItem::Node(i) => graph.id(i).to_string(),
+            ViewportItem::Cluster { level, cell: (cx, cy) } => format!("cluster:{}:{}:{}", level, cx, cy),
+        };
+
+        let nodes = view.nodes.iter().map(|n| {
+            let label = match n.item {
+                ViewportItem::Node(i) => graph.display_label(i).to_string(),
+                ViewportItem::Cluster { .. } => format!("{} functions", n.count),
+            };
+            ViewportNodeDto { id: item_id(&n.item), label, x: n.x, y: n.y, count: n.count }
+        }).collect();
+
+        let edges = view.edges.iter().map(|e| ViewportEdgeDto {
+            from: item_id(&e.from),
+            to: item_id(&e.to),
+            from_pos: [e.from_pos.0, e.from_pos.1],
+            to_pos: [e.to_pos.0, e.to_pos.1],
+            count: e.count,
+        }).collect();
+
+        Ok(ViewportDto {
+            aggregated: view.aggregated,
+            bounds: index.bounds().map(|b| [b.x0, b.y0, b.x1, b.y1]),
+            nodes,
+            edges,
+        })
+    }
+
+    /// Register a client for delta pushes and make sure the workspace is
+    /// being watched.
+    pub fn subscribe(self: &Arc<Self>, client: ClientWriter) -> Result<()> {
+        {
+            let mut subscribers = self.subscribers.lock().unwrap();
+            if !subscribers.iter().any(|c| Arc::ptr_eq(c, &client)) {
+                subscribers.push(client);
+            }
+        }
+
+        let mut watcher_slot = self.watcher.lock().unwrap();
+        if watcher_slot.is_none() {
+            let weak: Weak<WorkspaceSession> = Arc::downgrade(self);
+            let watcher = WorkspaceWatcher::start(
+                &self.root,
+                self.language.extensions(),
+                watcher::DEFAULT_DEBOUNCE,
+                move |changed| {
+                    if let Some(session) = weak.upgrade() {
+                        session.on_files_changed(&changed);
+                    }
+                },
+            )?;
+            *watcher_slot = Some(watcher);
+        }
+        Ok(())
+    }
+
+    /// Remove a client; the watcher stops once nobody is subscribed.
+    pub fn unsubscribe(&self, client: &ClientWriter) {
+        let remaining = {
+            let mut subscribers = self.subscribers.lock().unwrap();
+            subscribers.retain(|c| !Arc::ptr_eq(c, client));
+            subscribers.len()
+        };
+        if remaining == 0 {
+            self.watcher.lock().unwrap().take();
+        }
+    }
+
+    /// Debounced watcher callback: rebuild and push the delta.
+    fn on_files_changed(&self, changed: &[PathBuf]) {
+        println!("[Watch] {} file(s) changed in {}", changed.len(), self.root.display());
+
+        let _guard = self.analysis_lock.lock().unwrap();
+
+        // Sources changed, so the cached index is stale by definition
+        let cache = ScipCache::new(&self.root);
+        let graph = Scheduler::global().run(Priority::Background, || {
+            scip_runner::generate_fresh_index(&self.root, self.language, &cache, &[])
+                .and_then(|index_path| {
+                    let (graph, _) = self.ingest.lock().unwrap().update(&index_path)
+                        .context("Failed to ingest SCIP index")?;
+                    Ok((graph, GraphSnapshot::path_for_index(&index_path)))
+                })
+        });
+
+        match graph {
+            Ok((graph, snapshot_path)) => self.replace_graph(graph, None, Some(&snapshot_path), changed),
+            Err(e) => eprintln!("[Watch] Re-analysis failed: {}", e),
+        }
+    }
+
+    /// Swap in a new resident graph and broadcast the difference.
+    ///
+    /// `reachability` is the graph's index if it came from a snapshot;
+    /// otherwise one is built and, given a `snapshot` path, saved with the
+    /// graph so the next start can skip ingest.
+    ///
+    /// Callers hold `analysis_lock`, so the graph read here as the old one
+    /// is still resident when the swap happens.
+    fn replace_graph(&self, graph: CallGraph, reachability: Option<ReachabilityIndex>, snapshot: Option<&Path>, changed: &[PathBuf]) {
+        // Lay out, index and diff before swapping, with no lock held, so
+        // queries never see stale data and are not blocked meanwhile
+        let old = self.graph.read().unwrap().clone();
+        let fresh = reachability.is_none();
+        let ((viewport, reachability), delta) = Scheduler::global().run(Priority::Background, || {
+            rayon::join(
+                || rayon::join(
+                    || Arc::new(ViewportIndex::build(&graph)),
+                    || Arc::new(reachability.unwrap_or_else(|| ReachabilityIndex::build(&graph))),
+                ),
+                || old.as_deref().map(|old| GraphDelta::between(old, &graph)),
+            )
+        });
+        drop(old);
+
+        if let (true, Some(path)) = (fresh, snapshot) {
+            if let Err(e) = GraphSnapshot::save(path, &graph, Some(&reachability)) {
+                eprintln!("[Snapshot] {:#}", e);
+            }
+        }
+
+        {
+            // Held while the derived state is swapped too
+            let mut slot = self.graph.write().unwrap();
+            *slot = Some(Arc::new(graph));
+            *self.viewport.write().unwrap() = Some(viewport);
+            self.condensation.clear();
+            *self.flow.lock().unwrap() = None;
+            self.dominators.clear();
+            self.post_dominators.clear();
+            *self.reachability.write().unwrap() = Some(reachability);
+            self.entry_roots.clear();
+        }
+
+        // First load has nothing to diff against; subscribers got the full graph
+        let delta = match delta {
+            Some(d) if !d.is_empty() => d,
+            _ => return,
+        };
+
+        println!(
+            "[Watch] Delta: +{} / -{} nodes, +{} / -{} edges",
+            delta.added_nodes.len(),
+            delta.removed_nodes.len(),
+            delta.added_edges.len(),
+            delta.removed_edges.len()
+        );
+
+        let changed_files: Vec<String> = changed.iter().map(|p| p.display().to_string()).collect();
+        let event = json!({
+            "event": "graph_delta",
+            "path": self.root.display().to_string(),
+            "changed_files": changed_files,
+            "data": GraphDeltaDto::from(&delta),
+        });
+        self.broadcast(&event);
+    }
+
+    /// Push one event line to every subscriber, dropping dead connections.
+    fn broadcast(&self, event: &serde_json::Value) {
+        let line = match serde_json::to_string(event) {
+            Ok(s) => s,
+            Err(e) => {
+                eprintln!("[API] Failed to serialize event: {}", e);
+                return;
+            }
+        };
+
+        // Write outside the list lock so a stalled client cannot hold up
+        // SUBSCRIBE, UNSUBSCRIBE or the next broadcast's bookkeeping
+        let subscribers: Vec<ClientWriter> = self.subscribers.lock().unwrap().clone();
+        let dead: Vec<ClientWriter> = subscribers
+            .into_iter()
+            .filter(|client| {
+                let mut stream = client.lock().unwrap();
+                stream
+                    .write_all(line.as_bytes())
+                    .and_then(|_| stream.write_all(b"\n"))
+                    .is_err()
+            })
+            .collect();
+
+        if !dead.is_empty() {
+            self.subscribers.lock().unwrap().retain(|c| !dead.iter().any(|d| Arc::ptr_eq(c, d)));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+//! Atomic Bitset
+//!
+//! One bit per graph vertex, settable from many threads at once; used to
+//! mark visited vertices in parallel traversals.
+
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// Fixed-size bitset whose bits threads can claim without locking.
+pub struct AtomicBitSet {
+    words: Vec<AtomicU64>,
+}
+
+impl AtomicBitSet {
+    pub fn new(len: usize) -> Self {
+        Self {
+            words: (0..(len + 63) / 64).map(|_| AtomicU64::new(0)).collect(),
+        }
+    }
+
+    /// Set bit `i`; true if this call is the one that set it.
+    pub fn claim(&self, i: usize) -> bool {
+        let mask = 1u64 << (i % 64);
+        self.words[i / 64].fetch_or(mask, Ordering::Relaxed) & mask == 0
+    }
+
+    pub fn contains(&self, i: usize) -> bool {
+        self.words[i / 64].load(Ordering::Relaxed) & (1u64 << (i % 64)) != 0
+    }
+
+    /// Number of set bits.
+    pub fn count(&self) -> usize {
+        self.words.iter().map(|w| w.load(Ordering::Relaxed).count_ones() as usize).sum()
+    }
+}
@@ -1,34 +1,534 @@
 // Call graph structures for Mr. Hedgehog.
 // Represents function/module call relationships.
+//
+// Graphs are assembled with `GraphBuilder` (id -> index hash map, O(1) edge
+// insertion) and then frozen into a `CallGraph` in CSR form: every vertex
+// has a dense `u32` index, and the callees of vertex `v` are
+// `targets[offsets[v]..offsets[v + 1]]`. Ids and labels are interned
+// `Symbol`s and resolve to strings only when read. Definition sites are a
+// file `Symbol` plus a line number, so edits that shift lines never add
+// strings to the interner.
+//
+// A reverse CSR (callers of each vertex) is built once when the graph is
+// frozen, so "who calls X" is O(in-degree) for every consumer.
+//
+// Serialized graphs store only the forward arrays; the id index and the
+// reverse CSR are rebuilt on load.
 
-/// A node in the call graph.
-#[derive(Debug)]
+use crate::domain::symbol::Symbol;
+use rayon::prelude::*;
+use serde::de::Error as _;
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
+use std::collections::HashMap;
+use std::fmt;
+use std::ops::Range;
+
+/// Dense vertex index into a frozen `CallGraph`.
+pub type NodeIdx = u32;
+
+/// Where a node is defined. Displays as "file:line".
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
+pub struct Location {
+    pub file: Symbol,
+    /// 1-based
+    pub line: u32,
+}
+
+impl Location {
+    pub fn new(file: Symbol, line: u32) -> Self {
+        Self { file, line }
+    }
+
+    pub fn file(&self) -> &'static str {
+        self.file.as_str()
+    }
+}
+
+impl fmt::Display for Location {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "{}:{}", self.file, self.line)
+    }
+}
+
+/// Adjacency-list record for one defined node.
+///
+/// Convenient input for `CallGraph::new` (tests, small builders); the
+/// frozen graph does not store these.
+#[derive(Debug, Clone)]
 pub struct CallGraphNode {
     pub id: String, // function/module/unique identifier
     pub callees: Vec<String>, // list of IDs this node calls
     pub label: Option<String>, // label for DOT (file:line etc)
 }
 
-/// The call graph itself.
-#[derive(Debug)]
+/// The call graph itself, frozen into CSR adjacency.
+///
+/// Vertices `0..node_count()` are defined nodes in insertion order; callees
+/// that were never defined (std, external crates, synthetic `if(...)`
+/// markers) follow as external vertices with no outgoing edges.
+#[derive(Debug, Clone)]
 pub struct CallGraph {
-    pub nodes: Vec<CallGraphNode>,
+    ids: Vec<Symbol>,
+    labels: Vec<Option<Symbol>>,
+    /// Definition site, when the builder knows it
+    locations: Vec<Option<Location>>,
+    defined: u32,
+    index: HashMap<Symbol, NodeIdx>,
+    offsets: Vec<u32>,
+    targets: Vec<NodeIdx>,
+    /// Reverse CSR: distinct callers of `v` are
+    /// `rev_sources[rev_offsets[v]..rev_offsets[v + 1]]`, ascending
+    rev_offsets: Vec<u32>,
+    rev_sources: Vec<NodeIdx>,
+}
+
+impl Default for CallGraph {
+    fn default() -> Self {
+        GraphBuilder::new().build()
+    }
 }
 
 impl CallGraph {
+    /// Build from adjacency-list records. Edges keep their listed order.
     pub fn new(nodes: Vec<CallGraphNode>) -> Self {
-        Self { nodes }
+        let mut builder = GraphBuilder::with_capacity(nodes.len());
+        for node in &nodes {
+            builder.add_node(Symbol::intern(&node.id), node.label.as_deref().map(Symbol::intern));
+        }
+        for node in &nodes {
+            let caller = builder.idx_of(&node.id).unwrap();
+            for callee in &node.callees {
+                let callee = builder.intern(Symbol::intern(callee));
+                builder.add_edge_idx(caller, callee);
+            }
+        }
+        builder.build()
+    }
+
+    /// Number of defined nodes.
+    pub fn node_count(&self) -> usize {
+        self.defined as usize
+    }
+
+    /// Number of vertices, defined and external.
+    pub fn vertex_count(&self) -> usize {
+        self.ids.len()
+    }
+
+    pub fn edge_count(&self) -> usize {
+        self.targets.len()
+    }
+
+    /// Indices of the defined nodes.
+    pub fn nodes(&self) -> Range<NodeIdx> {
+        0..self.defined
+    }
+
+    /// Indices of every vertex, defined nodes first.
+    pub fn vertices(&self) -> Range<NodeIdx> {
+        0..self.ids.len() as NodeIdx
+    }
+
+    pub fn is_defined(&self, idx: NodeIdx) -> bool {
+        idx < self.defined
+    }
+
+    pub fn idx_of(&self, id: &str) -> Option<NodeIdx> {
+        Symbol::lookup(id).and_then(|sym| self.idx_of_symbol(sym))
+    }
+
+    pub fn idx_of_symbol(&self, sym: Symbol) -> Option<NodeIdx> {
+        self.index.get(&sym).copied()
+    }
+
+    pub fn symbol(&self, idx: NodeIdx) -> Symbol {
+        self.ids[idx as usize]
+    }
+
+    pub fn id(&self, idx: NodeIdx) -> &'static str {
+        self.ids[idx as usize].as_str()
+    }
+
+    pub fn label(&self, idx: NodeIdx) -> Option<&'static str> {
+        self.labels[idx as usize].map(Symbol::as_str)
+    }
+
+    /// Definition site, if known.
+    pub fn location(&self, idx: NodeIdx) -> Option<Location> {
+        self.locations[idx as usize]
+    }
+
+    /// Label if present, otherwise the id.
+    pub fn display_label(&self, idx: NodeIdx) -> &'static str {
+        self.label(idx).unwrap_or_else(|| self.id(idx))
+    }
+
+    /// Callees of `idx` in insertion order (may repeat).
+    pub fn callees(&self, idx: NodeIdx) -> &[NodeIdx] {
+        let start = self.offsets[idx as usize] as usize;
+        let end = self.offsets[idx as usize + 1] as usize;
+        &self.targets[start..end]
+    }
+
+    /// Callee ids of the node named `id`; empty if unknown or external.
+    pub fn callees_of(&self, id: &str) -> Vec<&'static str> {
+        self.idx_of(id)
+            .map(|idx| self.callees(idx).iter().map(|&c| self.id(c)).collect())
+            .unwrap_or_default()
+    }
+
+    /// Distinct callers of `idx`, ascending. Always defined nodes.
+    pub fn callers(&self, idx: NodeIdx) -> &[NodeIdx] {
+        let start = self.rev_offsets[idx as usize] as usize;
+        let end = self.rev_offsets[idx as usize + 1] as usize;
+        &self.rev_sources[start..end]
+    }
+
+    /// Caller ids of the vertex named `id`; empty if unknown.
+    pub fn callers_of(&self, id: &str) -> Vec<&'static str> {
+        self.idx_of(id)
+            .map(|idx| self.callers(idx).iter().map(|&c| self.id(c)).collect())
+            .unwrap_or_default()
+    }
+
+    /// Every `(caller, callee)` edge, grouped by caller.
+    pub fn edges(&self) -> impl Iterator<Item = (NodeIdx, NodeIdx)> + '_ {
+        self.nodes()
+            .flat_map(move |caller| self.callees(caller).iter().map(move |&callee| (caller, callee)))
+    }
+
+    /// Raw CSR arrays `(offsets, targets)`.
+    pub fn csr(&self) -> (&[u32], &[NodeIdx]) {
+        (&self.offsets, &self.targets)
+    }
+}
+
+/// Serialized form of a `CallGraph` (borrowed for writing).
+#[derive(Serialize)]
+struct StoredGraphRef<'a> {
+    ids: &'a [Symbol],
+    labels: &'a [Option<Symbol>],
+    locations: &'a [Option<Location>],
+    defined: u32,
+    offsets: &'a [u32],
+    targets: &'a [NodeIdx],
+}
+
+#[derive(Deserialize)]
+struct StoredGraph {
+    ids: Vec<Symbol>,
+    labels: Vec<Option<Symbol>>,
+    locations: Vec<Option<Location>>,
+    defined: u32,
+    offsets: Vec<u32>,
+    targets: Vec<NodeIdx>,
+}
+
+impl Serialize for CallGraph {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        StoredGraphRef {
+            ids: &self.ids,
+            labels: &self.labels,
+            locations: &self.locations,
+            defined: self.defined,
+            offsets: &self.offsets,
+            targets: &self.targets,
+        }
+        .serialize(serializer)
     }
+}
+
+impl<'de> Deserialize<'de> for CallGraph {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        let stored = StoredGraph::deserialize(deserializer)?;
+        let n = stored.ids.len();
 
-    pub fn add_edge(&mut self, caller_id: &str, callee_id: &str) {
-        if let Some(node) = self.nodes.iter_mut().find(|n| n.id == caller_id) {
-            node.callees.push(callee_id.to_string());
+        let consistent = stored.labels.len() == n
+            && stored.locations.len() == n
+            && stored.defined as usize <= n
+            && stored.offsets.len() == n + 1
+            && stored.offsets.first() == Some(&0)
+            && stored.offsets.windows(2).all(|w| w[0] <= w[1])
+            && stored.offsets[n] as usize == stored.targets.len()
+            && stored.targets.iter().all(|&t| (t as usize) < n);
+        if !consistent {
+            return Err(D::Error::custom("inconsistent call graph arrays"));
         }
+
+        let index = stored
+            .ids
+            .iter()
+            .enumerate()
+            .map(|(i, &id)| (id, i as NodeIdx))
+            .collect();
+        let (rev_offsets, rev_sources) = reverse_csr(n, &stored.offsets, &stored.targets);
+
+        Ok(CallGraph {
+            ids: stored.ids,
+            labels: stored.labels,
+            locations: stored.locations,
+            defined: stored.defined,
+            index,
+            offsets: stored.offsets,
+            targets: stored.targets,
+            rev_offsets,
+            rev_sources,
+        })
     }
 }
 
+/// Mutable graph under construction.
+#[derive(Debug, Default)]
+pub struct GraphBuilder {
+    ids: Vec<Symbol>,
+    labels: Vec<Option<Symbol>>,
+    locations: Vec<Option<Location>>,
+    defined: Vec<bool>,
+    index: HashMap<Symbol, NodeIdx>,
+    edges: Vec<(NodeIdx, NodeIdx)>,
+}
+
+impl GraphBuilder {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn with_capacity(nodes: usize) -> Self {
+        Self {
+            ids: Vec::with_capacity(nodes),
+            labels: Vec::with_capacity(nodes),
+            locations: Vec::with_capacity(nodes),
+            defined: Vec::with_capacity(nodes),
+            index: HashMap::with_capacity(nodes),
+            edges: Vec::new(),
+        }
+    }
+
+    /// Define a node, returning its builder index. Defining an id twice
+    /// keeps the first label; defining an id first seen as a callee
+    /// promotes it.
+    pub fn add_node(&mut self, id: Symbol, label: Option<Symbol>) -> NodeIdx {
+        let idx = self.intern(id);
+        if !self.defined[idx as usize] {
+            self.defined[idx as usize] = true;
+            self.labels[idx as usize] = label;
+        }
+        idx
+    }
+
+    /// Index for `id`, registering it as external if unseen.
+    pub fn intern(&mut self, id: Symbol) -> NodeIdx {
+        if let Some(&idx) = self.index.get(&id) {
+            return idx;
+        }
+        let idx = self.ids.len() as NodeIdx;
+        self.ids.push(id);
+        self.labels.push(None);
+        self.locations.push(None);
+        self.defined.push(false);
+        self.index.insert(id, idx);
+        idx
+    }
+
+    pub fn idx_of(&self, id: &str) -> Option<NodeIdx> {
+        Symbol::lookup(id).and_then(|sym| self.index.get(&sym).copied())
+    }
+
+    /// Record where `idx` is defined.
+    pub fn set_location(&mut self, idx: NodeIdx, location: Location) {
+        self.locations[idx as usize] = Some(location);
+    }
+
+    pub fn is_defined(&self, idx: NodeIdx) -> bool {
+        self.defined[idx as usize]
+    }
+
+    /// Add `caller -> callee`. Ignored when the caller is not defined,
+    /// matching how calls from unknown scopes were always dropped.
+    pub fn add_edge(&mut self, caller_id: Symbol, callee_id: Symbol) {
+        let caller = match self.index.get(&caller_id).copied() {
+            Some(idx) if self.defined[idx as usize] => idx,
+            _ => return,
+        };
+        let callee = self.intern(callee_id);
+        self.edges.push((caller, callee));
+    }
+
+    pub fn add_edge_idx(&mut self, caller: NodeIdx, callee: NodeIdx) {
+        self.edges.push((caller, callee));
+    }
+
+    /// Freeze into CSR. Defined nodes keep their definition order and come
+    /// first; each caller's edges keep their insertion order.
+    pub fn build(self) -> CallGraph {
+        let n = self.ids.len();
+
+        // Defined first, externals after, both in first-seen order
+        let order: Vec<usize> = (0..n)
+            .filter(|&old| self.defined[old])
+            .chain((0..n).filter(|&old| !self.defined[old]))
+            .collect();
+        let mut remap = vec![0 as NodeIdx; n];
+        for (new, &old) in order.iter().enumerate() {
+            remap[old] = new as NodeIdx;
+        }
+        let defined = self.defined.iter().filter(|&&d| d).count() as u32;
+
+        let ids: Vec<Symbol> = order.iter().map(|&old| self.ids[old]).collect();
+        let labels: Vec<Option<Symbol>> = order.iter().map(|&old| self.labels[old]).collect();
+        let locations: Vec<Option<Location>> = order.iter().map(|&old| self.locations[old]).collect();
+        let index = ids
+            .iter()
+            .enumerate()
+            .map(|(i, &id)| (id, i as NodeIdx))
+            .collect();
+
+        // Counting sort by caller keeps per-caller insertion order
+        let mut offsets = vec![0u32; n + 1];
+        for &(caller, _) in &self.edges {
+            offsets[remap[caller as usize] as usize + 1] += 1;
+        }
+        for i in 0..n {
+            offsets[i + 1] += offsets[i];
+        }
+        let mut cursor = offsets.clone();
+        let mut targets = vec![0 as NodeIdx; self.edges.len()];
+        for &(caller, callee) in &self.edges {
+            let slot = &mut cursor[remap[caller as usize] as usize];
+            targets[*slot as usize] = remap[callee as usize];
+            *slot += 1;
+        }
+
+        let (rev_offsets, rev_sources) = reverse_csr(n, &offsets, &targets);
+
+        CallGraph { ids, labels, locations, defined, index, offsets, targets, rev_offsets, rev_sources }
+    }
+}
+
+/// Transpose a CSR adjacency in one parallel pass over the callers:
+/// emit `(callee, caller)` pairs, sort, and drop repeated calls.
+fn reverse_csr(n: usize, offsets: &[u32], targets: &[NodeIdx]) -> (Vec<u32>, Vec<NodeIdx>) {
+    let mut pairs: Vec<(NodeIdx, NodeIdx)> = (0..n)
+        .into_par_iter()
+        .flat_map_iter(|caller| {
+            let span = offsets[caller] as usize..offsets[caller + 1] as usize;
+            targets[span].iter().map(move |&callee| (callee, caller as NodeIdx))
+        })
+        .collect();
+    pairs.par_sort_unstable();
+    pairs.dedup();
+
+    let mut rev_offsets = vec![0u32; n + 1];
+    for &(callee, _) in &pairs {
+        rev_offsets[callee as usize + 1] += 1;
+    }
+    for i in 0..n {
+        rev_offsets[i + 1] += rev_offsets[i];
+    }
+    let rev_sources = pairs.into_iter().map(|(_, caller)| caller).collect();
+    (rev_offsets, rev_sources)
+}
+
 /// Call graph for a single file.
 pub struct FileCallGraph {
     pub filename: String,
     pub callgraph: CallGraph,
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_builder_freezes_into_csr() {
+        let sym = Symbol::intern;
+        let mut builder = GraphBuilder::new();
+        builder.add_node(sym("main"), Some(sym("main")));
+        builder.add_node(sym("foo"), None);
+        builder.add_edge(sym("main"), sym("std::println"));
+        builder.add_edge(sym("main"), sym("foo"));
+        builder.add_edge(sym("foo"), sym("main"));
+        builder.add_edge(sym("unknown"), sym("foo")); // Caller not defined: dropped
+        let graph = builder.build();
+
+        assert_eq!(graph.node_count(), 2);
+        assert_eq!(graph.vertex_count(), 3);
+        assert_eq!(graph.edge_count(), 3);
+
+        let main = graph.idx_of("main").unwrap();
+        assert_eq!(graph.callees_of("main"), vec!["std::println", "foo"]);
+        assert_eq!(graph.callees_of("foo"), vec!["main"]);
+        assert!(graph.callees_of("std::println").is_empty());
+        assert!(!graph.is_defined(graph.idx_of("std::println").unwrap()));
+        assert_eq!(graph.display_label(main), "main");
+        assert_eq!(graph.display_label(graph.idx_of("foo").unwrap()), "foo");
+
+        assert_eq!(graph.callers_of("foo"), vec!["main"]);
+        assert_eq!(graph.callers_of("main"), vec!["foo"]);
+        assert_eq!(graph.callers_of("std::println"), vec!["main"]);
+    }
+
+    #[test]
+    fn test_reverse_index_dedups_repeated_calls() {
+        let graph = CallGraph::new(vec![
+            CallGraphNode { id: "a".to_string(), callees: vec!["c".to_string(), "c".to_string()], label: None },
+            CallGraphNode { id: "b".to_string(), callees: vec!["c".to_string()], label: None },
+            CallGraphNode { id: "c".to_string(), callees: vec![], label: None },
+        ]);
+        assert_eq!(graph.callees_of("a"), vec!["c", "c"]);
+        assert_eq!(graph.callers_of("c"), vec!["a", "b"]);
+        assert!(graph.callers_of("a").is_empty());
+        assert!(graph.callers_of("missing").is_empty());
+    }
+
+    #[test]
+    fn test_callee_defined_later_is_promoted() {
+        let sym = Symbol::intern;
+        let mut builder = GraphBuilder::new();
+        builder.add_node(sym("main"), None);
+        builder.add_edge(sym("main"), sym("helper"));
+        builder.add_node(sym("helper"), Some(sym("helper()")));
+        let graph = builder.build();
+
+        assert_eq!(graph.node_count(), 2);
+        let helper = graph.idx_of("helper").unwrap();
+        assert!(graph.is_defined(helper));
+        assert_eq!(graph.label(helper), Some("helper()"));
+        assert_eq!(graph.callees(graph.idx_of("main").unwrap()), &[helper]);
+    }
+
+    #[test]
+    fn test_new_from_records_keeps_order() {
+        let graph = CallGraph::new(vec![
+            CallGraphNode { id: "b".to_string(), callees: vec!["a".to_string(), "x".to_string()], label: None },
+            CallGraphNode { id: "a".to_string(), callees: vec![], label: None },
+        ]);
+        let ids: Vec<&str> = graph.vertices().map(|v| graph.id(v)).collect();
+        assert_eq!(ids, vec!["b", "a", "x"]);
+        let edges: Vec<(NodeIdx, NodeIdx)> = graph.edges().collect();
+        assert_eq!(edges, vec![(0, 1), (0, 2)]);
+    }
+
+    #[test]
+    fn test_serialized_graph_round_trips() {
+        let mut b = GraphBuilder::new();
+        let main = b.add_node(Symbol::intern("app::main"), None);
+        b.set_location(main, Location::new(Symbol::intern("src/main.rs"), 3));
+        b.add_node(Symbol::intern("app::run"), Some(Symbol::intern("run")));
+        b.add_edge(Symbol::intern("app::main"), Symbol::intern("app::run"));
+        b.add_edge(Symbol::intern("app::run"), Symbol::intern("std::println"));
+        let graph = b.build();
+
+        let json = serde_json::to_string(&graph).unwrap();
+        let back: CallGraph = serde_json::from_str(&json).unwrap();
+
+        assert_eq!(back.node_count(), 2);
+        assert_eq!(back.vertex_count(), 3);
+        assert_eq!(back.callees_of("app::run"), vec!["std::println"]);
+        assert_eq!(back.callers_of("app::run"), vec!["app::main"]);
+        assert_eq!(back.location(main).map(|l| l.to_string()).as_deref(), Some("src/main.rs:3"));
+
+        let broken = json.replace("\"defined\":2", "\"defined\":9");
+        assert!(serde_json::from_str::<CallGraph>(&broken).is_err());
+    }
+}
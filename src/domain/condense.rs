@@ -0,0 +1,385 @@
+//! SCC Condensation
+//!
+//! Collapses each strongly connected component (a group of mutually
+//! recursive functions) of the call graph into one vertex. The result is a
+//! DAG, so questions that are ill-posed on the cyclic graph ("how many call
+//! paths reach X?") can be answered by one topological pass in O(V + E).
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use serde::{Deserialize, Serialize};
+
+const UNVISITED: u32 = u32::MAX;
+
+/// The component DAG of a call graph.
+///
+/// Components are numbered in topological order: every DAG edge goes from
+/// a lower to a higher component id, so a forward scan over ids visits
+/// callers before callees.
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct Condensation {
+    /// Component of each graph vertex
+    comp: Vec<u32>,
+    /// Vertices of component `c` are `members[member_offsets[c]..member_offsets[c + 1]]`
+    member_offsets: Vec<u32>,
+    members: Vec<NodeIdx>,
+    /// Deduplicated DAG edges between components, CSR by source component
+    offsets: Vec<u32>,
+    targets: Vec<u32>,
+    /// Components containing a call cycle (several members, or a self call)
+    cyclic: Vec<bool>,
+}
+
+impl Condensation {
+    /// Condense every vertex of `graph` (external callees included), using
+    /// an iterative Tarjan so deep call chains cannot overflow the stack.
+    pub fn build(graph: &CallGraph) -> Self {
+        let n = graph.vertex_count();
+        let mut index = vec![UNVISITED; n];
+        let mut low = vec![0u32; n];
+        let mut on_stack = vec![false; n];
+        let mut stack: Vec<NodeIdx> = Vec::new();
+        let mut comp = vec![UNVISITED; n];
+        let mut count = 0u32;
+        let mut next_index = 0u32;
+        // (vertex, position of the next callee to visit)
+        let mut frames: Vec<(NodeIdx, usize)> = Vec::new();
+
+        for root in graph.vertices() {
+            if index[root as usize] != UNVISITED {
+                continue;
+            }
+            index[root as usize] = next_index;
+            low[root as usize] = next_index;
+            next_index += 1;
+            stack.push(root);
+            on_stack[root as usize] = true;
+            frames.push((root, 0));
+
+            while let Some(frame) = frames.last_mut() {
+                let v = frame.0;
+                let callees = graph.callees(v);
+                if frame.1 < callees.len() {
+                    let w = callees[frame.1];
+                    frame.1 += 1;
+                    if index[w as usize] == UNVISITED {
+                        index[w as usize] = next_index;
+                        low[w as usize] = next_index;
+                        next_index += 1;
+                        stack.push(w);
+                        on_stack[w as usize] = true;
+                        frames.push((w, 0));
+                    } else if on_stack[w as usize] {
+                        low[v as usize] = low[v as usize].min(index[w as usize]);
+                    }
+                    continue;
+                }
+
+                frames.pop();
+                if low[v as usize] == index[v as usize] {
+                    loop {
+                        let w = stack.pop().unwrap();
+                        on_stack[w as usize] = false;
+                        comp[w as usize] = count;
+                        if w == v {
+                            break;
+                        }
+                    }
+                    count += 1;
+                }
+                if let Some(&(parent, _)) = frames.last() {
+                    low[parent as usize] = low[parent as usize].min(low[v as usize]);
+                }
+            }
+        }
+
+        // Tarjan completes callees first (reverse topological order): flip
+        for c in comp.iter_mut() {
+            *c = count - 1 - *c;
+        }
+
+        let k = count as usize;
+        let mut member_offsets = vec![0u32; k + 1];
+        for &c in &comp {
+            member_offsets[c as usize + 1] += 1;
+        }
+        for c in 0..k {
+            member_offsets[c + 1] += member_offsets[c];
+        }
+        let mut fill = member_offsets.clone();
+        let mut members = vec![0; n];
+        for v in graph.vertices() {
+            let c = comp[v as usize] as usize;
+            members[fill[c] as usize] = v;
+            fill[c] += 1;
+        }
+
+        let mut cyclic: Vec<bool> = (0..k).map(|c| member_offsets[c + 1] - member_offsets[c] > 1).collect();
+        let mut dag_edges: Vec<(u32, u32)> = Vec::new();
+        for (caller, callee) in graph.edges() {
+            let (a, b) = (comp[caller as usize], comp[callee as usize]);
+            if a == b {
+                if caller == callee {
+                    cyclic[a as usize] = true;
+                }
+            } else {
+                dag_edges.push((a, b));
+            }
+        }
+        dag_edges.sort_unstable();
+        dag_edges.dedup();
+
+        let mut offsets = vec![0u32; k + 1];
+        for &(a, _) in &dag_edges {
+            offsets[a as usize + 1] += 1;
+        }
+        for c in 0..k {
+            offsets[c + 1] += offsets[c];
+        }
+        let targets = dag_edges.into_iter().map(|(_, b)| b).collect();
+
+        Self {
+            comp,
+            member_offsets,
+            members,
+            offsets,
+            targets,
+            cyclic,
+        }
+    }
+
+    /// Number of components.
+    pub fn len(&self) -> usize {
+        self.cyclic.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.cyclic.is_empty()
+    }
+
+    pub fn component(&self, node: NodeIdx) -> u32 {
+        self.comp[node as usize]
+    }
+
+    pub fn members(&self, c: u32) -> &[NodeIdx] {
+        let c = c as usize;
+        &self.members[self.member_offsets[c] as usize..self.member_offsets[c + 1] as usize]
+    }
+
+    /// Components called from `c`, ascending.
+    pub fn successors(&self, c: u32) -> &[u32] {
+        let c = c as usize;
+        &self.targets[self.offsets[c] as usize..self.offsets[c + 1] as usize]
+    }
+
+    pub fn is_cyclic(&self, c: u32) -> bool {
+        self.cyclic[c as usize]
+    }
+
+    /// Number of DAG edges.
+    pub fn edge_count(&self) -> usize {
+        self.targets.len()
+    }
+}
+
+/// Path statistics of one node relative to an entry set.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct NodeStats {
+    /// Distinct call paths from the entries, saturating at `u64::MAX`
+    pub paths: u64,
+    /// Fewest calls from an entry
+    pub min_depth: u32,
+    /// Most calls from an entry along any acyclic route
+    pub max_depth: u32,
+    /// The node sits in a recursive group (its component has a cycle)
+    pub recursive: bool,
+}
+
+impl NodeStats {
+    pub fn saturated(&self) -> bool {
+        self.paths == u64::MAX
+    }
+}
+
+/// Path counts and min/max depths from a set of entry nodes, computed on
+/// the condensation.
+///
+/// Paths and depths are measured on the component DAG: a recursive group
+/// counts as a single step however it is entered, which keeps the counts
+/// finite. Counts saturate rather than overflow.
+pub struct PathStats<'c> {
+    condensation: &'c Condensation,
+    /// Per component; 0 means unreachable
+    paths: Vec<u64>,
+    min_depth: Vec<u32>,
+    max_depth: Vec<u32>,
+}
+
+impl<'c> PathStats<'c> {
+    pub fn compute(condensation: &'c Condensation, entries: &[NodeIdx]) -> Self {
+        let k = condensation.len();
+        let mut paths = vec![0u64; k];
+        let mut min_depth = vec![u32::MAX; k];
+        let mut max_depth = vec![0u32; k];
+
+        for &entry in entries {
+            let c = condensation.component(entry) as usize;
+            // Several entries in one group still start one path
+            paths[c] = 1;
+            min_depth[c] = 0;
+        }
+
+        // Topological order is ascending component id
+        for c in 0..k {
+            if paths[c] == 0 {
+                continue;
+            }
+            for &d in condensation.successors(c as u32) {
+                let d = d as usize;
+                paths[d] = paths[d].saturating_add(paths[c]);
+                min_depth[d] = min_depth[d].min(min_depth[c] + 1);
+                max_depth[d] = max_depth[d].max(max_depth[c] + 1);
+            }
+        }
+
+        Self {
+            condensation,
+            paths,
+            min_depth,
+            max_depth,
+        }
+    }
+
+    pub fn is_reachable(&self, node: NodeIdx) -> bool {
+        self.paths[self.condensation.component(node) as usize] > 0
+    }
+
+    /// Statistics for `node`, or `None` when no entry reaches it.
+    pub fn node(&self, node: NodeIdx) -> Option<NodeStats> {
+        let c = self.condensation.component(node);
+        let paths = self.paths[c as usize];
+        if paths == 0 {
+            return None;
+        }
+        Some(NodeStats {
+            paths,
+            min_depth: self.min_depth[c as usize],
+            max_depth: self.max_depth[c as usize],
+            recursive: self.condensation.is_cyclic(c),
+        })
+    }
+
+    /// Number of graph vertices reachable from the entries.
+    pub fn reachable_count(&self) -> usize {
+        (0..self.condensation.len() as u32)
+            .filter(|&c| self.paths[c as usize] > 0)
+            .map(|c| self.condensation.members(c).len())
+            .sum()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    fn idx(graph: &CallGraph, id: &str) -> NodeIdx {
+        graph.idx_of(id).unwrap()
+    }
+
+    #[test]
+    fn test_cycles_collapse_into_topologically_ordered_components() {
+        // main -> a <-> b -> c, c -> c, main -> c
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "c"]),
+            node("a", &["b"]),
+            node("b", &["a", "c"]),
+            node("c", &["c"]),
+        ]);
+        let cond = Condensation::build(&graph);
+
+        assert_eq!(cond.len(), 3);
+        let (m, a, b, c) = (idx(&graph, "main"), idx(&graph, "a"), idx(&graph, "b"), idx(&graph, "c"));
+        assert_eq!(cond.component(a), cond.component(b));
+        assert!(cond.is_cyclic(cond.component(a)));
+        assert!(cond.is_cyclic(cond.component(c)));
+        assert!(!cond.is_cyclic(cond.component(m)));
+        assert!(cond.component(m) < cond.component(a));
+        assert!(cond.component(a) < cond.component(c));
+        // a->c and b->c merge into one DAG edge
+        assert_eq!(cond.edge_count(), 3);
+    }
+
+    #[test]
+    fn test_path_counts_and_depths() {
+        // Diamond with a recursive middle: main -> {l, r} -> sink, l <-> l2
+        let graph = CallGraph::new(vec![
+            node("main", &["l", "r", "sink"]),
+            node("l", &["l2", "sink"]),
+            node("l2", &["l"]),
+            node("r", &["sink"]),
+            node("sink", &[]),
+            node("orphan", &["sink"]),
+        ]);
+        let cond = Condensation::build(&graph);
+        let stats = PathStats::compute(&cond, &[idx(&graph, "main")]);
+
+        let sink = stats.node(idx(&graph, "sink")).unwrap();
+        assert_eq!(sink.paths, 3);
+        assert_eq!(sink.min_depth, 1);
+        assert_eq!(sink.max_depth, 2);
+        assert!(!sink.recursive);
+
+        let l2 = stats.node(idx(&graph, "l2")).unwrap();
+        assert_eq!(l2.paths, 1);
+        assert!(l2.recursive);
+
+        assert!(stats.node(idx(&graph, "orphan")).is_none());
+        assert_eq!(stats.reachable_count(), 5);
+    }
+
+    #[test]
+    fn test_path_counts_saturate() {
+        // 70 doubling layers overflow u64
+        let mut nodes = vec![node("main", &["l0_0", "l0_1"])];
+        for layer in 0..70 {
+            let next = [format!("l{}_0", layer + 1), format!("l{}_1", layer + 1)];
+            let next: Vec<&str> = next.iter().map(|s| s.as_str()).collect();
+            for i in 0..2 {
+                nodes.push(node(&format!("l{}_{}", layer, i), &next));
+            }
+        }
+        let graph = CallGraph::new(nodes);
+        let cond = Condensation::build(&graph);
+        let stats = PathStats::compute(&cond, &[idx(&graph, "main")]);
+
+        assert_eq!(stats.node(idx(&graph, "l10_0")).unwrap().paths, 1 << 10);
+        let deep = stats.node(idx(&graph, "l70_0")).unwrap();
+        assert!(deep.saturated());
+        assert_eq!(deep.min_depth, 71);
+    }
+
+    #[test]
+    fn test_deep_chains_do_not_overflow_the_stack() {
+        let ids: Vec<String> = (0..100_000).map(|i| format!("f{}", i)).collect();
+        let nodes = (0..ids.len())
+            .map(|i| {
+                let next: Vec<&str> = ids.get(i + 1).map(|s| s.as_str()).into_iter().collect();
+                node(&ids[i], &next)
+            })
+            .collect();
+        let graph = CallGraph::new(nodes);
+        let cond = Condensation::build(&graph);
+        assert_eq!(cond.len(), 100_000);
+
+        let stats = PathStats::compute(&cond, &[idx(&graph, "f0")]);
+        assert_eq!(stats.node(idx(&graph, "f99999")).unwrap().max_depth, 99_999);
+    }
+}
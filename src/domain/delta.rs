@@ -0,0 +1,215 @@
+//! Graph Delta
+//!
+//! The compact difference between two versions of a call graph, pushed to
+//! daemon subscribers so clients can patch their view instead of reloading.
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use crate::domain::symbol::Symbol;
+use rayon::prelude::*;
+use serde::{Deserialize, Serialize};
+
+/// Nodes and edges added or removed between two call graphs.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct GraphDelta {
+    /// Newly defined nodes as `(id, label)`
+    pub added_nodes: Vec<(String, Option<String>)>,
+    /// IDs of nodes that no longer exist
+    pub removed_nodes: Vec<String>,
+    /// New `(caller, callee)` edges
+    pub added_edges: Vec<(String, String)>,
+    /// Vanished `(caller, callee)` edges
+    pub removed_edges: Vec<(String, String)>,
+}
+
+impl GraphDelta {
+    /// Compute the delta that turns `old` into `new`.
+    ///
+    /// Both graphs' ids are interned in the same table, so node and edge
+    /// sets are compared as sorted runs of symbol numbers: one sort per
+    /// side, then a single linear merge. Only the (usually small) delta is
+    /// sorted by name, so identical inputs always yield identical deltas.
+    pub fn between(old: &CallGraph, new: &CallGraph) -> Self {
+        let (old_nodes, new_nodes) = rayon::join(|| Self::node_run(old), || Self::node_run(new));
+        let (old_edges, new_edges) = rayon::join(|| Self::edge_run(old), || Self::edge_run(new));
+
+        let mut added_nodes = Vec::new();
+        let mut removed_nodes = Vec::new();
+        merge(&old_nodes, &new_nodes, |side, &(sym, idx)| match side {
+            Side::Old => removed_nodes.push(sym.as_str().to_string()),
+            Side::New => added_nodes.push((sym.as_str().to_string(), new.label(idx).map(str::to_string))),
+        });
+
+        let mut added_edges = Vec::new();
+        let mut removed_edges = Vec::new();
+        merge(&old_edges, &new_edges, |side, &(caller, callee)| {
+            let edge = (caller.as_str().to_string(), callee.as_str().to_string());
+            match side {
+                Side::Old => removed_edges.push(edge),
+                Side::New => added_edges.push(edge),
+            }
+        });
+
+        added_nodes.sort();
+        removed_nodes.sort();
+        added_edges.sort();
+        removed_edges.sort();
+
+        GraphDelta {
+            added_nodes,
+            removed_nodes,
+            added_edges,
+            removed_edges,
+        }
+    }
+
+    /// True when both graphs were identical.
+    pub fn is_empty(&self) -> bool {
+        self.added_nodes.is_empty()
+            && self.removed_nodes.is_empty()
+            && self.added_edges.is_empty()
+            && self.removed_edges.is_empty()
+    }
+
+    /// Defined nodes by symbol number.
+    fn node_run(graph: &CallGraph) -> Vec<(SymbolKey, NodeIdx)> {
+        let mut run: Vec<_> = graph.nodes().map(|n| (SymbolKey(graph.symbol(n)), n)).collect();
+        run.par_sort_unstable_by_key(|&(sym, _)| sym);
+        run
+    }
+
+    /// Distinct `(caller, callee)` edges by symbol numbers.
+    fn edge_run(graph: &CallGraph) -> Vec<(SymbolKey, SymbolKey)> {
+        let mut run: Vec<_> = graph
+            .edges()
+            .map(|(caller, callee)| (SymbolKey(graph.symbol(caller)), SymbolKey(graph.symbol(callee))))
+            .collect();
+        run.par_sort_unstable();
+        run.dedup();
+        run
+    }
+}
+
+/// A symbol ordered by its intern number (cheap, not alphabetical).
+#[derive(Clone, Copy, PartialEq, Eq)]
+struct SymbolKey(Symbol);
+
+impl SymbolKey {
+    fn as_str(self) -> &'static str {
+        self.0.as_str()
+    }
+}
+
+impl Ord for SymbolKey {
+    fn cmp(&self, other: &Self) -> std::cmp::Ordering {
+        self.0.index().cmp(&other.0.index())
+    }
+}
+
+impl PartialOrd for SymbolKey {
+    fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+enum Side {
+    Old,
+    New,
+}
+
+/// Walk two sorted runs in step, reporting entries found on one side only.
+/// Node runs compare by their key (the first field) alone.
+fn merge<T: Keyed>(old: &[T], new: &[T], mut only: impl FnMut(Side, &T)) {
+    let (mut i, mut j) = (0, 0);
+    while i < old.len() && j < new.len() {
+        match old[i].key().cmp(&new[j].key()) {
+            std::cmp::Ordering::Less => {
+                only(Side::Old, &old[i]);
+                i += 1;
+            }
+            std::cmp::Ordering::Greater => {
+                only(Side::New, &new[j]);
+                j += 1;
+            }
+            std::cmp::Ordering::Equal => {
+                i += 1;
+                j += 1;
+            }
+        }
+    }
+    old[i..].iter().for_each(|x| only(Side::Old, x));
+    new[j..].iter().for_each(|x| only(Side::New, x));
+}
+
+trait Keyed {
+    type Key: Ord;
+    fn key(&self) -> Self::Key;
+}
+
+impl Keyed for (SymbolKey, NodeIdx) {
+    type Key = SymbolKey;
+    fn key(&self) -> SymbolKey {
+        self.0
+    }
+}
+
+impl Keyed for (SymbolKey, SymbolKey) {
+    type Key = (SymbolKey, SymbolKey);
+    fn key(&self) -> (SymbolKey, SymbolKey) {
+        *self
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: Some(id.to_string()),
+        }
+    }
+
+    #[test]
+    fn test_delta_identical_graphs_is_empty() {
+        let a = CallGraph::new(vec![node("main", &["foo"]), node("foo", &[])]);
+        let b = CallGraph::new(vec![node("main", &["foo"]), node("foo", &[])]);
+        assert!(GraphDelta::between(&a, &b).is_empty());
+    }
+
+    #[test]
+    fn test_delta_added_and_removed() {
+        let old = CallGraph::new(vec![node("main", &["foo"]), node("foo", &[])]);
+        let new = CallGraph::new(vec![node("main", &["bar"]), node("bar", &[])]);
+
+        let delta = GraphDelta::between(&old, &new);
+        assert_eq!(delta.added_nodes, vec![("bar".to_string(), Some("bar".to_string()))]);
+        assert_eq!(delta.removed_nodes, vec!["foo".to_string()]);
+        assert_eq!(delta.added_edges, vec![("main".to_string(), "bar".to_string())]);
+        assert_eq!(delta.removed_edges, vec![("main".to_string(), "foo".to_string())]);
+    }
+
+    #[test]
+    fn test_delta_merges_unsorted_graphs_with_repeated_calls() {
+        let old = CallGraph::new(vec![
+            node("zeta", &["alpha", "alpha", "std::fmt"]),
+            node("alpha", &["mid"]),
+            node("mid", &[]),
+        ]);
+        let new = CallGraph::new(vec![
+            node("mid", &["alpha"]),
+            node("alpha", &[]),
+            node("zeta", &["alpha", "std::fmt", "std::io"]),
+        ]);
+
+        let delta = GraphDelta::between(&old, &new);
+        assert!(delta.added_nodes.is_empty() && delta.removed_nodes.is_empty());
+        assert_eq!(delta.added_edges, vec![
+            ("mid".to_string(), "alpha".to_string()),
+            ("zeta".to_string(), "std::io".to_string()),
+        ]);
+        assert_eq!(delta.removed_edges, vec![("alpha".to_string(), "mid".to_string())]);
+    }
+}
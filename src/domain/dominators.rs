@@ -0,0 +1,295 @@
+//! Dominator Analysis
+//!
+//! A function D dominates F when every call path from the entries to F
+//! passes through D; those are the chokepoints an audit of F must cover.
+//! Post-dominators are the mirror image: every path from F down to a leaf
+//! (a function that calls nothing) passes through them.
+//!
+//! Both use the Cooper-Harvey-Kennedy iterative algorithm over a reverse
+//! postorder. It needs only the CSR adjacency the call graph already has,
+//! and on call graphs (mostly acyclic, shallow loops) it settles in two or
+//! three passes, so it is near-linear in practice.
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+
+const UNDEF: u32 = u32::MAX;
+
+/// Immediate dominators of every vertex reachable from a set of sources,
+/// in either direction of the call graph.
+///
+/// Several sources are joined under a virtual root, so a node dominated by
+/// nothing but "some entry" has no immediate dominator.
+#[derive(Debug, Clone)]
+pub struct Dominators {
+    /// Immediate dominator per vertex; the virtual root's index for nodes
+    /// only it dominates, `UNDEF` when unreachable
+    idom: Vec<u32>,
+    /// Reachable vertices in reverse postorder (virtual root excluded)
+    order: Vec<NodeIdx>,
+    virtual_root: u32,
+}
+
+/// Which way paths run.
+#[derive(Clone, Copy)]
+enum Direction {
+    /// Entries down through callees
+    Calls,
+    /// Leaves up through callers
+    Returns,
+}
+
+struct Walk<'g> {
+    graph: &'g CallGraph,
+    direction: Direction,
+    virtual_root: u32,
+    sources: Vec<NodeIdx>,
+    is_source: Vec<bool>,
+}
+
+impl<'g> Walk<'g> {
+    fn successors(&self, v: u32) -> &[NodeIdx] {
+        if v == self.virtual_root {
+            return &self.sources;
+        }
+        match self.direction {
+            Direction::Calls => self.graph.callees(v),
+            Direction::Returns => self.graph.callers(v),
+        }
+    }
+
+    fn predecessors(&self, v: u32) -> &[NodeIdx] {
+        match self.direction {
+            Direction::Calls => self.graph.callers(v),
+            Direction::Returns => self.graph.callees(v),
+        }
+    }
+}
+
+impl Dominators {
+    /// Dominators of everything reachable from `entries` along calls.
+    pub fn compute(graph: &CallGraph, entries: &[NodeIdx]) -> Self {
+        Self::solve(graph, Direction::Calls, entries.to_vec())
+    }
+
+    /// Post-dominators: dominators on the reversed graph, rooted at every
+    /// leaf vertex (no callees, externals included).
+    pub fn compute_post(graph: &CallGraph) -> Self {
+        let leaves = graph.vertices().filter(|&v| graph.callees(v).is_empty()).collect();
+        Self::solve(graph, Direction::Returns, leaves)
+    }
+
+    fn solve(graph: &CallGraph, direction: Direction, mut sources: Vec<NodeIdx>) -> Self {
+        let n = graph.vertex_count();
+        let virtual_root = n as u32;
+        sources.sort_unstable();
+        sources.dedup();
+        let mut is_source = vec![false; n];
+        for &s in &sources {
+            is_source[s as usize] = true;
+        }
+        let walk = Walk { graph, direction, virtual_root, sources, is_source };
+
+        // Postorder numbers by iterative DFS from the virtual root
+        let mut postorder_num = vec![UNDEF; n + 1];
+        let mut postorder = Vec::new();
+        let mut seen = vec![false; n + 1];
+        seen[n] = true;
+        let mut stack = vec![(virtual_root, 0usize)];
+        while let Some(frame) = stack.last_mut() {
+            let (v, pos) = *frame;
+            let succ = walk.successors(v);
+            if pos < succ.len() {
+                frame.1 += 1;
+                let w = succ[pos];
+                if !seen[w as usize] {
+                    seen[w as usize] = true;
+                    stack.push((w, 0));
+                }
+            } else {
+                stack.pop();
+                postorder_num[v as usize] = postorder.len() as u32;
+                postorder.push(v);
+            }
+        }
+        // Reverse postorder without the virtual root (numbered last)
+        postorder.pop();
+        let order: Vec<NodeIdx> = postorder.into_iter().rev().collect();
+
+        let mut idom = vec![UNDEF; n + 1];
+        idom[n] = virtual_root;
+
+        let intersect = |idom: &[u32], mut a: u32, mut b: u32| {
+            while a != b {
+                while postorder_num[a as usize] < postorder_num[b as usize] {
+                    a = idom[a as usize];
+                }
+                while postorder_num[b as usize] < postorder_num[a as usize] {
+                    b = idom[b as usize];
+                }
+            }
+            a
+        };
+
+        let mut changed = true;
+        while changed {
+            changed = false;
+            for &v in &order {
+                let mut new_idom = if walk.is_source[v as usize] { virtual_root } else { UNDEF };
+                for &p in walk.predecessors(v) {
+                    if idom[p as usize] == UNDEF {
+                        continue; // unreachable, or not processed yet
+                    }
+                    new_idom = if new_idom == UNDEF { p } else { intersect(&idom, p, new_idom) };
+                }
+                if new_idom != idom[v as usize] {
+                    idom[v as usize] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+
+        idom.truncate(n);
+        Self { idom, order, virtual_root }
+    }
+
+    pub fn is_reachable(&self, node: NodeIdx) -> bool {
+        self.idom[node as usize] != UNDEF
+    }
+
+    /// Immediate dominator; `None` for sources, unreachable nodes and nodes
+    /// reached from several sources with no common chokepoint.
+    pub fn idom(&self, node: NodeIdx) -> Option<NodeIdx> {
+        match self.idom[node as usize] {
+            UNDEF => None,
+            d if d == self.virtual_root => None,
+            d => Some(d),
+        }
+    }
+
+    /// Strict dominators of `node`, outermost (a source) first.
+    pub fn dominators(&self, node: NodeIdx) -> Vec<NodeIdx> {
+        let mut chain = Vec::new();
+        let mut current = node;
+        while let Some(d) = self.idom(current) {
+            chain.push(d);
+            current = d;
+        }
+        chain.reverse();
+        chain
+    }
+
+    /// Whether every path to `node` passes through `by` (a node dominates
+    /// itself).
+    pub fn dominates(&self, by: NodeIdx, node: NodeIdx) -> bool {
+        if !self.is_reachable(node) {
+            return false;
+        }
+        let mut current = node;
+        loop {
+            if current == by {
+                return true;
+            }
+            match self.idom(current) {
+                Some(d) => current = d,
+                None => return false,
+            }
+        }
+    }
+
+    /// Number of nodes each node dominates, itself included (its dominator
+    /// subtree size); 0 for unreachable nodes. Large values mark the
+    /// chokepoints guarding the most code.
+    pub fn dominated_counts(&self) -> Vec<u32> {
+        let mut counts = vec![0u32; self.idom.len()];
+        // Children come after their idom in reverse postorder
+        for &v in self.order.iter().rev() {
+            counts[v as usize] += 1;
+            if let Some(d) = self.idom(v) {
+                counts[d as usize] += counts[v as usize];
+            }
+        }
+        counts
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    fn ids(graph: &CallGraph, nodes: &[NodeIdx]) -> Vec<&'static str> {
+        nodes.iter().map(|&n| graph.id(n)).collect()
+    }
+
+    fn idx(graph: &CallGraph, id: &str) -> NodeIdx {
+        graph.idx_of(id).unwrap()
+    }
+
+    /// main -> auth -> {db, cache}; db -> log; cache -> log;
+    /// main -> health (bypasses auth); auth <-> retry
+    fn service() -> CallGraph {
+        CallGraph::new(vec![
+            node("main", &["auth", "health"]),
+            node("auth", &["db", "cache", "retry"]),
+            node("retry", &["auth"]),
+            node("db", &["log"]),
+            node("cache", &["log"]),
+            node("health", &[]),
+            node("log", &[]),
+        ])
+    }
+
+    #[test]
+    fn test_dominators_are_the_chokepoints() {
+        let graph = service();
+        let dom = Dominators::compute(&graph, &[idx(&graph, "main")]);
+
+        assert_eq!(ids(&graph, &dom.dominators(idx(&graph, "log"))), vec!["main", "auth"]);
+        assert_eq!(dom.idom(idx(&graph, "retry")), Some(idx(&graph, "auth")));
+        assert!(dom.dominates(idx(&graph, "auth"), idx(&graph, "cache")));
+        assert!(!dom.dominates(idx(&graph, "db"), idx(&graph, "log")));
+        assert!(dom.idom(idx(&graph, "main")).is_none());
+
+        let counts = dom.dominated_counts();
+        assert_eq!(counts[idx(&graph, "main") as usize], 7);
+        assert_eq!(counts[idx(&graph, "auth") as usize], 5);
+    }
+
+    #[test]
+    fn test_several_entries_share_only_common_chokepoints() {
+        let graph = CallGraph::new(vec![
+            node("route_a", &["validate"]),
+            node("route_b", &["validate"]),
+            node("validate", &["store"]),
+            node("other", &[]),
+        ]);
+        let entries = [idx(&graph, "route_a"), idx(&graph, "route_b")];
+        let dom = Dominators::compute(&graph, &entries);
+
+        assert_eq!(ids(&graph, &dom.dominators(idx(&graph, "store"))), vec!["validate"]);
+        assert!(dom.idom(idx(&graph, "validate")).is_none());
+        assert!(dom.is_reachable(idx(&graph, "validate")));
+        assert!(!dom.is_reachable(idx(&graph, "other")));
+    }
+
+    #[test]
+    fn test_post_dominators_follow_paths_to_leaves() {
+        let graph = service();
+        let post = Dominators::compute_post(&graph);
+
+        // Every way out of db or cache ends in log
+        assert_eq!(post.idom(idx(&graph, "db")), Some(idx(&graph, "log")));
+        assert_eq!(post.idom(idx(&graph, "cache")), Some(idx(&graph, "log")));
+        // main can finish in health or log: no common exit chokepoint
+        assert!(post.idom(idx(&graph, "main")).is_none());
+        assert_eq!(ids(&graph, &post.dominators(idx(&graph, "retry"))), vec!["log", "auth"]);
+    }
+}
@@ -3,8 +3,10 @@
 //! Represents sequential execution flow from entry points.
 
 use crate::domain::entry_point::{EntryPoint, EntryPointKind};
-use crate::domain::callgraph::CallGraph;
-use std::collections::{HashMap, HashSet};
+use crate::domain::bitset::AtomicBitSet;
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use rayon::prelude::*;
+use std::sync::atomic::{AtomicU32, Ordering};
 
 /// Represents a sequential execution flow graph.
 #[derive(Debug, Clone)]
@@ -64,131 +66,259 @@ pub struct FlowEdge {
     pub label: Option<String>,
 }
 
-impl FlowGraph {
-    /// Create a FlowGraph from a CallGraph starting from detected entry points.
-    pub fn from_callgraph(
-        callgraph: &CallGraph,
-        entry_points: Vec<EntryPoint>,
-        max_depth: usize,
-    ) -> Self {
-        let mut nodes = Vec::new();
-        let mut edges = Vec::new();
-        let mut visited = HashSet::new();
-        let mut sequence = 0;
+/// Marks an unreached node (no owner, no depth yet).
+const UNREACHED: u32 = u32::MAX;
 
-        // Build adjacency map from callgraph
-        let adj_map: HashMap<String, Vec<String>> = callgraph
-            .nodes
-            .iter()
-            .map(|n| (n.id.clone(), n.callees.clone()))
-            .collect();
+/// Resumable multi-entry expansion behind `FlowGraph::from_callgraph`.
+///
+/// Ownership is settled by a level-synchronous BFS from all entries at once:
+/// each level's frontier is expanded in parallel, nodes are claimed through
+/// an atomic bitset and `fetch_min` on the owner. `flow_graph` then has
+/// every entry walk its own nodes in call order with an explicit stack, in
+/// parallel, and concatenates the walks in entry order, so node order and
+/// sequence numbers do not depend on scheduling. Total work is O(V + E)
+/// however many entries share the graph.
+///
+/// The BFS layers are kept. Raising the depth limit continues from the
+/// deepest saved frontier; lowering it only hides the layers below, which
+/// stay available for the next raise. Must only be used with the call graph
+/// it was created from.
+pub struct FlowExpansion {
+    entry_points: Vec<EntryPoint>,
+    /// Graph node of each entry; `None` when outside the graph or already
+    /// the root of an earlier entry
+    roots: Vec<Option<NodeIdx>>,
+    owner: Vec<AtomicU32>,
+    depth: Vec<u32>,
+    claimed: AtomicBitSet,
+    /// Nodes first reached at each depth; `layers[0]` holds the roots
+    layers: Vec<Vec<NodeIdx>>,
+    /// No node lies deeper than the last layer
+    exhausted: bool,
+    max_depth: usize,
+}
 
-        // Process each entry point
-        for entry in &entry_points {
-            let node_type = match entry.kind {
-                EntryPointKind::Main | EntryPointKind::AsyncMain | EntryPointKind::PythonMain => {
-                    FlowNodeType::Entry
-                }
-                EntryPointKind::FlaskRoute | EntryPointKind::FastAPIRoute | EntryPointKind::DjangoView => {
-                    FlowNodeType::Entry
-                }
-                _ => FlowNodeType::Call,
-            };
+impl FlowExpansion {
+    /// Expansion to depth 0 (entries only).
+    pub fn new(callgraph: &CallGraph, entry_points: Vec<EntryPoint>) -> Self {
+        let n = callgraph.vertex_count();
+        let owner: Vec<AtomicU32> = (0..n).map(|_| AtomicU32::new(UNREACHED)).collect();
+        let mut depth = vec![UNREACHED; n];
+        let claimed = AtomicBitSet::new(n);
 
-            let entry_node = FlowNode {
-                id: entry.id.clone(),
-                label: entry.name.clone(),
-                node_type,
-                file_path: Some(entry.file_path.clone()),
-                line: entry.line,
-                depth: 0,
-            };
-            nodes.push(entry_node);
-            visited.insert(entry.id.clone());
-
-            // DFS from this entry point
-            Self::expand_node(
-                &entry.id,
-                0,
-                max_depth,
-                &adj_map,
-                &mut nodes,
-                &mut edges,
-                &mut visited,
-                &mut sequence,
-            );
+        let mut roots = Vec::with_capacity(entry_points.len());
+        let mut layer = Vec::new();
+        for (i, entry) in entry_points.iter().enumerate() {
+            let root = callgraph.idx_of(&entry.id).filter(|&r| claimed.claim(r as usize));
+            if let Some(r) = root {
+                owner[r as usize].store(i as u32, Ordering::Relaxed);
+                depth[r as usize] = 0;
+                layer.push(r);
+            }
+            roots.push(root);
         }
 
-        FlowGraph {
+        Self {
             entry_points,
-            nodes,
-            edges,
+            roots,
+            owner,
+            depth,
+            claimed,
+            exhausted: layer.is_empty(),
+            layers: vec![layer],
+            max_depth: 0,
         }
     }
 
-    fn expand_node(
-        node_id: &str,
-        depth: usize,
-        max_depth: usize,
-        adj_map: &HashMap<String, Vec<String>>,
-        nodes: &mut Vec<FlowNode>,
-        edges: &mut Vec<FlowEdge>,
-        visited: &mut HashSet<String>,
-        sequence: &mut usize,
-    ) {
-        if depth >= max_depth {
-            return;
+    pub fn max_depth(&self) -> usize {
+        self.max_depth
+    }
+
+    /// Nothing lies beyond the current depth limit.
+    pub fn is_complete(&self) -> bool {
+        self.exhausted && self.layers.len() - 1 <= self.max_depth
+    }
+
+    /// Change the depth limit, computing only layers not computed before.
+    pub fn set_max_depth(&mut self, callgraph: &CallGraph, max_depth: usize) {
+        self.max_depth = max_depth;
+
+        while !self.exhausted && self.layers.len() <= max_depth {
+            let level = self.layers.len() as u32;
+            let next: Vec<NodeIdx> = {
+                let (owner, depth, claimed) = (&self.owner, &self.depth, &self.claimed);
+                self.layers
+                    .last()
+                    .unwrap()
+                    .par_iter()
+                    .flat_map_iter(|&u| {
+                        let by = owner[u as usize].load(Ordering::Relaxed);
+                        callgraph.callees(u).iter().copied().filter(move |&v| {
+                            if depth[v as usize] != UNREACHED {
+                                return false; // settled on an earlier level
+                            }
+                            owner[v as usize].fetch_min(by, Ordering::Relaxed);
+                            claimed.claim(v as usize)
+                        })
+                    })
+                    .collect()
+            };
+
+            if next.is_empty() {
+                self.exhausted = true;
+                break;
+            }
+            for &v in &next {
+                self.depth[v as usize] = level;
+            }
+            self.layers.push(next);
         }
+    }
 
-        if let Some(callees) = adj_map.get(node_id) {
-            for callee in callees {
-                *sequence += 1;
+    /// The flowchart up to the current depth limit.
+    pub fn flow_graph(&self, callgraph: &CallGraph) -> FlowGraph {
+        let expanded = AtomicBitSet::new(callgraph.vertex_count());
+        let walks: Vec<(Vec<FlowNode>, Vec<(NodeIdx, NodeIdx)>)> = (0..self.roots.len())
+            .into_par_iter()
+            .map(|i| match self.roots[i] {
+                Some(root) => FlowGraph::walk_owned(
+                    callgraph,
+                    root,
+                    i as u32,
+                    &self.owner,
+                    &self.depth,
+                    &expanded,
+                    self.max_depth,
+                ),
+                None => (Vec::new(), Vec::new()),
+            })
+            .collect();
 
-                // Add edge
+        // Deterministic merge in entry order
+        let mut nodes = Vec::new();
+        let mut edges = Vec::new();
+        let mut sequence = 0;
+        for ((entry, root), (owned, calls)) in self.entry_points.iter().zip(&self.roots).zip(walks) {
+            if root.is_none() && callgraph.idx_of(&entry.id).is_some() {
+                continue; // same node as an earlier entry
+            }
+            nodes.push(FlowGraph::entry_node(entry));
+            nodes.extend(owned);
+            for (from, to) in calls {
+                sequence += 1;
                 edges.push(FlowEdge {
-                    from: node_id.to_string(),
-                    to: callee.clone(),
-                    sequence: *sequence,
+                    from: callgraph.id(from).to_string(),
+                    to: callgraph.id(to).to_string(),
+                    sequence,
                     label: None,
                 });
+            }
+        }
+
+        FlowGraph {
+            entry_points: self.entry_points.clone(),
+            nodes,
+            edges,
+        }
+    }
+}
+
+impl FlowGraph {
+    /// Create a FlowGraph from a CallGraph starting from detected entry points.
+    ///
+    /// Every reachable node is expanded once, by the entry that owns it: the
+    /// lowest-numbered entry among those reaching it in the fewest calls.
+    /// See `FlowExpansion` for how ownership is settled in parallel.
+    pub fn from_callgraph(
+        callgraph: &CallGraph,
+        entry_points: Vec<EntryPoint>,
+        max_depth: usize,
+    ) -> Self {
+        let mut expansion = FlowExpansion::new(callgraph, entry_points);
+        expansion.set_max_depth(callgraph, max_depth);
+        expansion.flow_graph(callgraph)
+    }
 
-                // Add node if not visited
-                if !visited.contains(callee) {
-                    visited.insert(callee.clone());
-
-                    let node_type = Self::infer_node_type(callee);
-                    let label = callee
-                        .split("::")
-                        .last()
-                        .unwrap_or(callee)
-                        .split('@')
-                        .next()
-                        .unwrap_or(callee)
-                        .to_string();
-
-                    nodes.push(FlowNode {
-                        id: callee.clone(),
-                        label,
-                        node_type,
-                        file_path: None,
-                        line: None,
-                        depth: depth + 1,
-                    });
-
-                    // Recurse
-                    Self::expand_node(
-                        callee,
-                        depth + 1,
-                        max_depth,
-                        adj_map,
-                        nodes,
-                        edges,
-                        visited,
-                        sequence,
-                    );
-                }
+    /// Depth-first walk from `root` over the nodes owned by `entry`, in call
+    /// order. Returns the owned nodes in discovery order and every call
+    /// made by them (calls into other entries' nodes included).
+    fn walk_owned(
+        callgraph: &CallGraph,
+        root: NodeIdx,
+        entry: u32,
+        owner: &[AtomicU32],
+        depth: &[u32],
+        expanded: &AtomicBitSet,
+        max_depth: usize,
+    ) -> (Vec<FlowNode>, Vec<(NodeIdx, NodeIdx)>) {
+        let mut nodes = Vec::new();
+        let mut calls = Vec::new();
+        expanded.claim(root as usize);
+        // (node, position of the next callee)
+        let mut stack = vec![(root, 0usize)];
+
+        while let Some(frame) = stack.last_mut() {
+            let (node, pos) = *frame;
+            let callees: &[NodeIdx] = if (depth[node as usize] as usize) < max_depth {
+                callgraph.callees(node)
+            } else {
+                &[]
+            };
+            if pos == callees.len() {
+                stack.pop();
+                continue;
+            }
+            frame.1 += 1;
+
+            let callee = callees[pos];
+            calls.push((node, callee));
+            if owner[callee as usize].load(Ordering::Relaxed) == entry && expanded.claim(callee as usize) {
+                nodes.push(Self::call_node(callgraph.id(callee), depth[callee as usize] as usize));
+                stack.push((callee, 0));
             }
         }
+        (nodes, calls)
+    }
+
+    fn entry_node(entry: &EntryPoint) -> FlowNode {
+        let node_type = match entry.kind {
+            EntryPointKind::Main | EntryPointKind::AsyncMain | EntryPointKind::PythonMain => {
+                FlowNodeType::Entry
+            }
+            EntryPointKind::FlaskRoute | EntryPointKind::FastAPIRoute | EntryPointKind::DjangoView => {
+                FlowNodeType::Entry
+            }
+            _ => FlowNodeType::Call,
+        };
+
+        FlowNode {
+            id: entry.id.clone(),
+            label: entry.name.clone(),
+            node_type,
+            file_path: Some(entry.file_path.clone()),
+            line: entry.line,
+            depth: 0,
+        }
+    }
+
+    fn call_node(id: &str, depth: usize) -> FlowNode {
+        let label = id
+            .split("::")
+            .last()
+            .unwrap_or(id)
+            .split('@')
+            .next()
+            .unwrap_or(id)
+            .to_string();
+
+        FlowNode {
+            id: id.to_string(),
+            label,
+            node_type: Self::infer_node_type(id),
+            file_path: None,
+            line: None,
+            depth,
+        }
     }
 
     fn infer_node_type(node_id: &str) -> FlowNodeType {
@@ -224,30 +354,28 @@ mod tests {
 
     #[test]
     fn test_flowgraph_from_callgraph() {
-        let callgraph = CallGraph {
-            nodes: vec![
-                CallGraphNode {
-                    id: "main".to_string(),
-                    callees: vec!["foo".to_string(), "bar".to_string()],
-                    label: Some("main".to_string()),
-                },
-                CallGraphNode {
-                    id: "foo".to_string(),
-                    callees: vec!["baz".to_string()],
-                    label: Some("foo".to_string()),
-                },
-                CallGraphNode {
-                    id: "bar".to_string(),
-                    callees: vec![],
-                    label: Some("bar".to_string()),
-                },
-                CallGraphNode {
-                    id: "baz".to_string(),
-                    callees: vec![],
-                    label: Some("baz".to_string()),
-                },
-            ],
-        };
+        let callgraph = CallGraph::new(vec![
+            CallGraphNode {
+                id: "main".to_string(),
+                callees: vec!["foo".to_string(), "bar".to_string()],
+                label: Some("main".to_string()),
+            },
+            CallGraphNode {
+                id: "foo".to_string(),
+                callees: vec!["baz".to_string()],
+                label: Some("foo".to_string()),
+            },
+            CallGraphNode {
+                id: "bar".to_string(),
+                callees: vec![],
+                label: Some("bar".to_string()),
+            },
+            CallGraphNode {
+                id: "baz".to_string(),
+                callees: vec![],
+                label: Some("baz".to_string()),
+            },
+        ]);
 
         let entries = vec![EntryPoint {
             id: "main".to_string(),
@@ -261,4 +389,109 @@ mod tests {
         assert_eq!(flow.nodes.len(), 4);
         assert_eq!(flow.edges.len(), 3);
     }
+
+    fn entry(id: &str) -> EntryPoint {
+        EntryPoint {
+            id: id.to_string(),
+            name: id.to_string(),
+            kind: EntryPointKind::FastAPIRoute,
+            file_path: "app.py".to_string(),
+            line: None,
+        }
+    }
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    #[test]
+    fn test_shared_nodes_expand_once_in_entry_order() {
+        let callgraph = CallGraph::new(vec![
+            node("r1", &["a"]),
+            node("a", &["shared"]),
+            node("r2", &["shared", "r1"]),
+            node("shared", &["leaf"]),
+        ]);
+
+        let flow = FlowGraph::from_callgraph(&callgraph, vec![entry("r1"), entry("r2"), entry("r1")], 5);
+
+        let ids: Vec<(&str, usize)> = flow.nodes.iter().map(|n| (n.id.as_str(), n.depth)).collect();
+        // r2 reaches `shared` in one call, r1 needs two: r2 owns it
+        assert_eq!(ids, vec![("r1", 0), ("a", 1), ("r2", 0), ("shared", 1), ("leaf", 2)]);
+
+        let edges: Vec<(&str, &str, usize)> =
+            flow.edges.iter().map(|e| (e.from.as_str(), e.to.as_str(), e.sequence)).collect();
+        assert_eq!(edges, vec![
+            ("r1", "a", 1),
+            ("a", "shared", 2),
+            ("r2", "shared", 3),
+            ("shared", "leaf", 4),
+            ("r2", "r1", 5),
+        ]);
+    }
+
+    #[test]
+    fn test_max_depth_stops_expansion() {
+        let callgraph = CallGraph::new(vec![node("main", &["a"]), node("a", &["b"]), node("b", &["c"])]);
+        let flow = FlowGraph::from_callgraph(&callgraph, vec![entry("main")], 2);
+        assert_eq!(flow.nodes.len(), 3);
+        assert_eq!(flow.edges.len(), 2);
+    }
+
+    #[test]
+    fn test_deep_chains_do_not_overflow_the_stack() {
+        let ids: Vec<String> = (0..100_000).map(|i| format!("f{}", i)).collect();
+        let nodes = (0..ids.len())
+            .map(|i| {
+                let next: Vec<&str> = ids.get(i + 1).map(|s| s.as_str()).into_iter().collect();
+                node(&ids[i], &next)
+            })
+            .collect();
+        let callgraph = CallGraph::new(nodes);
+
+        let flow = FlowGraph::from_callgraph(&callgraph, vec![entry("f0")], usize::MAX);
+        assert_eq!(flow.nodes.len(), 100_000);
+        assert_eq!(flow.nodes.last().unwrap().depth, 99_999);
+    }
+
+    fn shape(flow: &FlowGraph) -> (Vec<(String, usize)>, Vec<(String, String, usize)>) {
+        (
+            flow.nodes.iter().map(|n| (n.id.clone(), n.depth)).collect(),
+            flow.edges.iter().map(|e| (e.from.clone(), e.to.clone(), e.sequence)).collect(),
+        )
+    }
+
+    #[test]
+    fn test_depth_changes_match_a_fresh_build() {
+        let callgraph = CallGraph::new(vec![
+            node("r1", &["a", "b"]),
+            node("a", &["c", "shared"]),
+            node("b", &["d"]),
+            node("c", &["e"]),
+            node("r2", &["shared"]),
+            node("shared", &["c", "f"]),
+            node("f", &["g"]),
+        ]);
+        let entries = vec![entry("r1"), entry("r2")];
+        let fresh = |depth| shape(&FlowGraph::from_callgraph(&callgraph, entries.clone(), depth));
+
+        let mut expansion = FlowExpansion::new(&callgraph, entries.clone());
+        expansion.set_max_depth(&callgraph, 1);
+        assert_eq!(shape(&expansion.flow_graph(&callgraph)), fresh(1));
+
+        expansion.set_max_depth(&callgraph, 4);
+        assert_eq!(shape(&expansion.flow_graph(&callgraph)), fresh(4));
+        assert!(expansion.is_complete());
+
+        expansion.set_max_depth(&callgraph, 2);
+        assert_eq!(shape(&expansion.flow_graph(&callgraph)), fresh(2));
+        assert!(!expansion.is_complete());
+
+        expansion.set_max_depth(&callgraph, 3);
+        assert_eq!(shape(&expansion.flow_graph(&callgraph)), fresh(3));
+    }
 }
@@ -4,17 +4,20 @@ use syn::{Item, Type, Visibility};
 
 use serde::{Serialize, Deserialize};
 
+/// `name` and `crate_name` repeat across thousands of signatures, so they
+/// are interned; they still serialize as plain strings.
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct FunctionSignature {
-    pub name: String,
+    pub name: Symbol,
     pub is_public: bool,
     pub receiver: Option<String>, // "&self", "self", or None for static
     pub location: String,         // file:line
-    pub crate_name: String,
+    pub crate_name: Symbol,
 }
 
 use std::sync::Arc;
 use crate::domain::store::SymbolStore;
+use crate::domain::symbol::Symbol;
 
 /// Error encountered during analysis/parsing.
 #[derive(Debug, Clone)]
@@ -77,11 +80,11 @@ impl SymbolIndex {
                     let qualified_name = format!("{}::{}", crate_name, name);
 
                     let sig = FunctionSignature {
-                        name: name.clone(),
+                        name: Symbol::intern(&name),
                         is_public,
                         receiver: None,
                         location: format!("{}:{}", file_path, line),
-                        crate_name: crate_name.to_string(),
+                        crate_name: Symbol::intern(crate_name),
                     };
                     self.store.insert_function(qualified_name, sig);
                 }
@@ -108,11 +111,11 @@ impl SymbolIndex {
                                     });
 
                                     let sig = FunctionSignature {
-                                        name: method_name.clone(),
+                                        name: Symbol::intern(&method_name),
                                         is_public,
                                         receiver,
                                         location: format!("{}:{}", file_path, line),
-                                        crate_name: crate_name.to_string(),
+                                        crate_name: Symbol::intern(crate_name),
                                     };
 
                                     self.store.insert_method(type_name.clone(), method_name.clone(), sig);
@@ -0,0 +1,137 @@
+//! Graph Layout
+//!
+//! Assigns 2D positions to call graph nodes for clients that render only a
+//! window of the graph. Nodes are layered by BFS depth from their roots
+//! (functions nobody calls); wide layers wrap onto extra rows so very large
+//! graphs keep a usable aspect ratio.
+
+use crate::domain::callgraph::CallGraph;
+use std::collections::VecDeque;
+
+/// Horizontal distance between node origins (matches the GUI grid).
+pub const NODE_SPACING_X: f64 = 200.0;
+/// Vertical distance between rows.
+pub const NODE_SPACING_Y: f64 = 80.0;
+/// Maximum nodes per row before a layer wraps.
+pub const MAX_ROW_NODES: usize = 64;
+
+/// Positions for the defined nodes of a call graph, indexed like
+/// `CallGraph::nodes`. Edges to undefined (external) callees are dropped.
+#[derive(Debug, Clone, Default)]
+pub struct GraphLayout {
+    pub positions: Vec<(f64, f64)>,
+    /// `(caller, callee)` edges between laid-out nodes, as node indices
+    pub edges: Vec<(u32, u32)>,
+}
+
+impl GraphLayout {
+    pub fn compute(graph: &CallGraph) -> Self {
+        let n = graph.node_count();
+
+        let mut edges = Vec::new();
+        let mut adjacency: Vec<Vec<u32>> = vec![Vec::new(); n];
+        let mut in_degree = vec![0u32; n];
+        for (caller, callee) in graph.edges() {
+            if !graph.is_defined(callee) || callee == caller {
+                continue;
+            }
+            edges.push((caller, callee));
+            adjacency[caller as usize].push(callee);
+            in_degree[callee as usize] += 1;
+        }
+
+        // Layer by BFS depth from roots. Nodes only reachable through cycles
+        // seed their own BFS once the roots are exhausted.
+        let mut depth = vec![usize::MAX; n];
+        let mut layers: Vec<Vec<u32>> = Vec::new();
+        let mut queue = VecDeque::new();
+
+        let roots = (0..n).filter(|&i| in_degree[i] == 0);
+        let rest = 0..n;
+        for seed in roots.chain(rest) {
+            if depth[seed] != usize::MAX {
+                continue;
+            }
+            depth[seed] = 0;
+            queue.push_back(seed as u32);
+
+            while let Some(current) = queue.pop_front() {
+                let d = depth[current as usize];
+                if layers.len() <= d {
+                    layers.resize_with(d + 1, Vec::new);
+                }
+                layers[d].push(current);
+
+                for &next in &adjacency[current as usize] {
+                    if depth[next as usize] == usize::MAX {
+                        depth[next as usize] = d + 1;
+                        queue.push_back(next);
+                    }
+                }
+            }
+        }
+
+        let mut positions = vec![(0.0, 0.0); n];
+        let mut row = 0usize;
+        for layer in &layers {
+            for (slot, &node) in layer.iter().enumerate() {
+                let x = (slot % MAX_ROW_NODES) as f64 * NODE_SPACING_X;
+                let y = (row + slot / MAX_ROW_NODES) as f64 * NODE_SPACING_Y;
+                positions[node as usize] = (x, y);
+            }
+            row += (layer.len() + MAX_ROW_NODES - 1) / MAX_ROW_NODES;
+        }
+
+        Self { positions, edges }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    #[test]
+    fn test_layers_follow_call_depth() {
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "b", "std::println"]),
+            node("a", &["c"]),
+            node("b", &["c"]),
+            node("c", &[]),
+        ]);
+        let layout = GraphLayout::compute(&graph);
+
+        assert_eq!(layout.positions[0].1, 0.0);
+        assert_eq!(layout.positions[1].1, NODE_SPACING_Y);
+        assert_eq!(layout.positions[2].1, NODE_SPACING_Y);
+        assert_eq!(layout.positions[3].1, 2.0 * NODE_SPACING_Y);
+        assert_ne!(layout.positions[1], layout.positions[2]);
+
+        // External callee dropped
+        assert_eq!(layout.edges.len(), 4);
+    }
+
+    #[test]
+    fn test_cycle_only_nodes_are_placed() {
+        let graph = CallGraph::new(vec![node("a", &["b"]), node("b", &["a"])]);
+        let layout = GraphLayout::compute(&graph);
+        assert_eq!(layout.positions[0], (0.0, 0.0));
+        assert_eq!(layout.positions[1], (0.0, NODE_SPACING_Y));
+    }
+
+    #[test]
+    fn test_wide_layer_wraps() {
+        let ids: Vec<String> = (0..MAX_ROW_NODES + 1).map(|i| format!("f{}", i)).collect();
+        let nodes = ids.iter().map(|id| node(id, &[])).collect();
+        let layout = GraphLayout::compute(&CallGraph::new(nodes));
+        assert_eq!(layout.positions[MAX_ROW_NODES], (0.0, NODE_SPACING_Y));
+    }
+}
@@ -1,9 +1,21 @@
 pub mod ast;
 pub mod callgraph;
+pub mod bitset;
+pub mod symbol;
 pub mod index;
 pub mod trace;
+pub mod paths;
+pub mod condense;
+pub mod dominators;
+pub mod reachability;
+pub mod unreachable;
 pub mod store;
 pub mod scip_ingest;
+pub mod scip_stream;
 pub mod language;
 pub mod entry_point;
 pub mod flowgraph;
+pub mod delta;
+pub mod spatial;
+pub mod layout;
+pub mod viewport;
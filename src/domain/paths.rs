@@ -0,0 +1,342 @@
+//! Shortest Call Paths
+//!
+//! Point-to-point path queries between two nodes of a call graph. A
+//! bidirectional BFS (callees forward from the source, the reverse index
+//! backward from the target) finds one shortest path while touching only
+//! the neighbourhoods of both ends; Yen's algorithm builds on it to produce
+//! the k shortest simple paths in order of length, one at a time.
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, HashSet};
+
+const NONE: u32 = u32::MAX;
+
+/// Reusable bidirectional BFS over a call graph.
+///
+/// Visit marks are epoch-stamped so repeated searches (one per spur node in
+/// Yen's algorithm) do not clear O(V) arrays each time.
+pub struct BidiBfs<'g> {
+    graph: &'g CallGraph,
+    epoch: u32,
+    fwd_seen: Vec<u32>,
+    bwd_seen: Vec<u32>,
+    fwd_parent: Vec<NodeIdx>,
+    bwd_parent: Vec<NodeIdx>,
+    fwd_dist: Vec<u32>,
+    bwd_dist: Vec<u32>,
+}
+
+/// Nodes and edges a search may not use.
+#[derive(Default)]
+struct Bans {
+    nodes: HashSet<NodeIdx>,
+    edges: HashSet<(NodeIdx, NodeIdx)>,
+}
+
+impl Bans {
+    fn allows(&self, from: NodeIdx, to: NodeIdx) -> bool {
+        !self.nodes.contains(&to) && !self.nodes.contains(&from) && !self.edges.contains(&(from, to))
+    }
+}
+
+impl<'g> BidiBfs<'g> {
+    pub fn new(graph: &'g CallGraph) -> Self {
+        let n = graph.vertex_count();
+        Self {
+            graph,
+            epoch: 0,
+            fwd_seen: vec![0; n],
+            bwd_seen: vec![0; n],
+            fwd_parent: vec![NONE; n],
+            bwd_parent: vec![NONE; n],
+            fwd_dist: vec![0; n],
+            bwd_dist: vec![0; n],
+        }
+    }
+
+    /// One shortest call path `from -> ... -> to`, both ends included.
+    pub fn shortest(&mut self, from: NodeIdx, to: NodeIdx) -> Option<Vec<NodeIdx>> {
+        self.search(from, to, &Bans::default())
+    }
+
+    fn search(&mut self, from: NodeIdx, to: NodeIdx, bans: &Bans) -> Option<Vec<NodeIdx>> {
+        if bans.nodes.contains(&from) || bans.nodes.contains(&to) {
+            return None;
+        }
+        if from == to {
+            return Some(vec![from]);
+        }
+
+        self.epoch = self.epoch.wrapping_add(1);
+        if self.epoch == 0 {
+            // Stamps wrapped: forget every old mark
+            self.fwd_seen.iter_mut().for_each(|s| *s = 0);
+            self.bwd_seen.iter_mut().for_each(|s| *s = 0);
+            self.epoch = 1;
+        }
+        let epoch = self.epoch;
+        let graph = self.graph;
+
+        self.fwd_seen[from as usize] = epoch;
+        self.fwd_parent[from as usize] = NONE;
+        self.fwd_dist[from as usize] = 0;
+        self.bwd_seen[to as usize] = epoch;
+        self.bwd_parent[to as usize] = NONE;
+        self.bwd_dist[to as usize] = 0;
+
+        let mut fwd = vec![from];
+        let mut bwd = vec![to];
+        let mut next = Vec::new();
+
+        while !fwd.is_empty() && !bwd.is_empty() {
+            // Expand the smaller frontier by one full level; the best
+            // meeting point within that level is a shortest path.
+            let mut best: Option<(u32, NodeIdx, NodeIdx)> = None;
+            if fwd.len() <= bwd.len() {
+                for &u in &fwd {
+                    for &v in graph.callees(u) {
+                        if !bans.allows(u, v) {
+                            continue;
+                        }
+                        if self.bwd_seen[v as usize] == epoch {
+                            let len = self.fwd_dist[u as usize] + 1 + self.bwd_dist[v as usize];
+                            if best.map_or(true, |(l, _, _)| len < l) {
+                                best = Some((len, u, v));
+                            }
+                        }
+                        if self.fwd_seen[v as usize] != epoch {
+                            self.fwd_seen[v as usize] = epoch;
+                            self.fwd_parent[v as usize] = u;
+                            self.fwd_dist[v as usize] = self.fwd_dist[u as usize] + 1;
+                            next.push(v);
+                        }
+                    }
+                }
+                std::mem::swap(&mut fwd, &mut next);
+            } else {
+                for &v in &bwd {
+                    for &u in graph.callers(v) {
+                        if !bans.allows(u, v) {
+                            continue;
+                        }
+                        if self.fwd_seen[u as usize] == epoch {
+                            let len = self.fwd_dist[u as usize] + 1 + self.bwd_dist[v as usize];
+                            if best.map_or(true, |(l, _, _)| len < l) {
+                                best = Some((len, u, v));
+                            }
+                        }
+                        if self.bwd_seen[u as usize] != epoch {
+                            self.bwd_seen[u as usize] = epoch;
+                            self.bwd_parent[u as usize] = v;
+                            self.bwd_dist[u as usize] = self.bwd_dist[v as usize] + 1;
+                            next.push(u);
+                        }
+                    }
+                }
+                std::mem::swap(&mut bwd, &mut next);
+            }
+            next.clear();
+
+            if let Some((_, u, v)) = best {
+                return Some(self.splice(u, v));
+            }
+        }
+        None
+    }
+
+    /// Join the forward chain ending at `u` with the backward chain from `v`.
+    fn splice(&self, u: NodeIdx, v: NodeIdx) -> Vec<NodeIdx> {
+        let mut path = Vec::new();
+        let mut node = u;
+        while node != NONE {
+            path.push(node);
+            node = self.fwd_parent[node as usize];
+        }
+        path.reverse();
+        let mut node = v;
+        while node != NONE {
+            path.push(node);
+            node = self.bwd_parent[node as usize];
+        }
+        path
+    }
+}
+
+/// The simple call paths from one node to another, shortest first (Yen's
+/// algorithm). Each `next()` does only the work for one more path, so
+/// callers can stream results and stop with `take(k)`. Queued candidates
+/// of equal length are taken in order of node index, so output is stable.
+pub struct KShortestPaths<'g> {
+    bfs: BidiBfs<'g>,
+    from: NodeIdx,
+    to: NodeIdx,
+    started: bool,
+    found: Vec<Vec<NodeIdx>>,
+    candidates: BinaryHeap<Reverse<(usize, Vec<NodeIdx>)>>,
+    queued: HashSet<Vec<NodeIdx>>,
+}
+
+impl<'g> KShortestPaths<'g> {
+    pub fn new(graph: &'g CallGraph, from: NodeIdx, to: NodeIdx) -> Self {
+        Self {
+            bfs: BidiBfs::new(graph),
+            from,
+            to,
+            started: false,
+            found: Vec::new(),
+            candidates: BinaryHeap::new(),
+            queued: HashSet::new(),
+        }
+    }
+
+    /// Queue every deviation from the most recently returned path.
+    fn queue_spurs(&mut self) {
+        let last = match self.found.last() {
+            Some(path) => path.clone(),
+            None => return,
+        };
+
+        for i in 0..last.len() - 1 {
+            let spur = last[i];
+            let root = &last[..=i];
+
+            // Don't repeat an edge already taken out of this root, and
+            // don't revisit the root itself (paths stay simple).
+            let mut bans = Bans::default();
+            for path in &self.found {
+                if path.len() > i + 1 && &path[..=i] == root {
+                    bans.edges.insert((path[i], path[i + 1]));
+                }
+            }
+            bans.nodes.extend(root[..i].iter().copied());
+
+            if let Some(spur_path) = self.bfs.search(spur, self.to, &bans) {
+                let mut candidate = root[..i].to_vec();
+                candidate.extend(spur_path);
+                if self.queued.insert(candidate.clone()) {
+                    self.candidates.push(Reverse((candidate.len(), candidate)));
+                }
+            }
+        }
+    }
+}
+
+impl<'g> Iterator for KShortestPaths<'g> {
+    type Item = Vec<NodeIdx>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if !self.started {
+            self.started = true;
+            let first = self.bfs.shortest(self.from, self.to)?;
+            self.queued.insert(first.clone());
+            self.found.push(first.clone());
+            return Some(first);
+        }
+        if self.found.is_empty() {
+            return None;
+        }
+
+        self.queue_spurs();
+        let Reverse((_, path)) = self.candidates.pop()?;
+        self.found.push(path.clone());
+        Some(path)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    fn names(graph: &CallGraph, path: &[NodeIdx]) -> Vec<&'static str> {
+        path.iter().map(|&n| graph.id(n)).collect()
+    }
+
+    fn idx(graph: &CallGraph, id: &str) -> NodeIdx {
+        graph.idx_of(id).unwrap()
+    }
+
+    #[test]
+    fn test_shortest_path_meets_in_the_middle() {
+        // main -> a -> b -> c -> target, plus a shortcut main -> x -> target
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "x"]),
+            node("a", &["b"]),
+            node("b", &["c"]),
+            node("c", &["target"]),
+            node("x", &["target"]),
+            node("target", &[]),
+        ]);
+        let mut bfs = BidiBfs::new(&graph);
+        let path = bfs.shortest(idx(&graph, "main"), idx(&graph, "target")).unwrap();
+        assert_eq!(names(&graph, &path), vec!["main", "x", "target"]);
+
+        // Direction matters: nothing calls main
+        assert!(bfs.shortest(idx(&graph, "target"), idx(&graph, "main")).is_none());
+        assert_eq!(bfs.shortest(idx(&graph, "a"), idx(&graph, "a")), Some(vec![idx(&graph, "a")]));
+    }
+
+    #[test]
+    fn test_k_shortest_come_out_by_length() {
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "b", "target"]),
+            node("a", &["b", "target"]),
+            node("b", &["target", "main"]),
+            node("target", &[]),
+        ]);
+        let paths: Vec<_> = KShortestPaths::new(&graph, idx(&graph, "main"), idx(&graph, "target"))
+            .map(|p| names(&graph, &p))
+            .collect();
+
+        assert_eq!(paths, vec![
+            vec!["main", "target"],
+            vec!["main", "a", "target"],
+            vec!["main", "b", "target"],
+            vec!["main", "a", "b", "target"],
+        ]);
+    }
+
+    #[test]
+    fn test_k_shortest_stops_early_on_path_explosion() {
+        // 40 layers, each fully connected to the next: 2^40 simple paths
+        let mut nodes = vec![node("main", &["l0_0", "l0_1"])];
+        for layer in 0..40 {
+            let next: Vec<String> = if layer == 39 {
+                vec!["target".to_string()]
+            } else {
+                vec![format!("l{}_0", layer + 1), format!("l{}_1", layer + 1)]
+            };
+            let next: Vec<&str> = next.iter().map(|s| s.as_str()).collect();
+            for i in 0..2 {
+                nodes.push(node(&format!("l{}_{}", layer, i), &next));
+            }
+        }
+        nodes.push(node("target", &[]));
+        let graph = CallGraph::new(nodes);
+
+        let paths: Vec<_> = KShortestPaths::new(&graph, idx(&graph, "main"), idx(&graph, "target"))
+            .take(10)
+            .collect();
+        assert_eq!(paths.len(), 10);
+        assert!(paths.iter().all(|p| p.len() == 42));
+        let distinct: HashSet<_> = paths.iter().collect();
+        assert_eq!(distinct.len(), 10);
+    }
+
+    #[test]
+    fn test_unreachable_target_yields_nothing() {
+        let graph = CallGraph::new(vec![node("main", &["a"]), node("a", &[]), node("b", &[])]);
+        let mut paths = KShortestPaths::new(&graph, idx(&graph, "main"), idx(&graph, "b"));
+        assert!(paths.next().is_none());
+        assert!(paths.next().is_none());
+    }
+}
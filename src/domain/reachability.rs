@@ -0,0 +1,286 @@
+//! Reachability Index
+//!
+//! Answers "can A (transitively) call B?" without a graph search in the
+//! common case, using GRAIL-style interval labels on the SCC condensation.
+//!
+//! Each of a few randomized DFS traversals of the component DAG gives every
+//! component an interval `[low, high]`: `high` is its postorder rank and
+//! `low` the smallest rank below it. If A reaches B, B's interval nests in
+//! A's for every traversal, so one non-nesting interval proves B is
+//! unreachable. Nesting in all of them is only a hint; those queries fall
+//! back to a DFS pruned by the same intervals and by topological order.
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use crate::domain::condense::Condensation;
+use rayon::prelude::*;
+use serde::{Deserialize, Serialize};
+use std::collections::HashSet;
+
+/// Randomized traversals labelled by `build`.
+pub const DEFAULT_TRAVERSALS: usize = 3;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+struct Interval {
+    low: u32,
+    high: u32,
+}
+
+impl Interval {
+    fn contains(&self, other: &Interval) -> bool {
+        self.low <= other.low && other.high <= self.high
+    }
+}
+
+/// Result of one reachability query.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Reachability {
+    pub reachable: bool,
+    /// Settled by the labels alone, without a search
+    pub by_index: bool,
+}
+
+/// Interval labels over the condensation of one call graph.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ReachabilityIndex {
+    condensation: Condensation,
+    traversals: usize,
+    /// `traversals` labelings of every component, labeling-major
+    intervals: Vec<Interval>,
+}
+
+impl ReachabilityIndex {
+    pub fn build(graph: &CallGraph) -> Self {
+        Self::from_condensation(Condensation::build(graph), DEFAULT_TRAVERSALS)
+    }
+
+    /// Label `condensation` with `traversals` randomized DFS orders, one
+    /// per thread. Seeds are fixed, so the same graph gets the same index.
+    pub fn from_condensation(condensation: Condensation, traversals: usize) -> Self {
+        let labelings: Vec<Vec<Interval>> = (0..traversals)
+            .into_par_iter()
+            .map(|t| label(&condensation, t as u64))
+            .collect();
+
+        Self {
+            condensation,
+            traversals,
+            intervals: labelings.into_iter().flatten().collect(),
+        }
+    }
+
+    pub fn condensation(&self) -> &Condensation {
+        &self.condensation
+    }
+
+    /// Whether `from` reaches `to` through one or more calls (or is it).
+    pub fn reaches(&self, from: NodeIdx, to: NodeIdx) -> bool {
+        self.query(from, to).reachable
+    }
+
+    pub fn query(&self, from: NodeIdx, to: NodeIdx) -> Reachability {
+        let (a, b) = (self.condensation.component(from), self.condensation.component(to));
+        let decided = |reachable| Reachability { reachable, by_index: true };
+
+        if a == b {
+            return decided(true);
+        }
+        // Components are numbered topologically: calls only go up
+        if b < a || !self.nests(a, b) {
+            return decided(false);
+        }
+
+        Reachability { reachable: self.search(a, b), by_index: false }
+    }
+
+    /// `b`'s intervals nest in `a`'s in every labeling.
+    fn nests(&self, a: u32, b: u32) -> bool {
+        let k = self.condensation.len();
+        (0..self.traversals).all(|t| {
+            let labels = &self.intervals[t * k..(t + 1) * k];
+            labels[a as usize].contains(&labels[b as usize])
+        })
+    }
+
+    /// DFS from `a` that only enters components which may still reach `b`.
+    fn search(&self, a: u32, b: u32) -> bool {
+        let mut visited = HashSet::new();
+        let mut stack = vec![a];
+        while let Some(c) = stack.pop() {
+            for &next in self.condensation.successors(c) {
+                if next == b {
+                    return true;
+                }
+                if next < b && self.nests(next, b) && visited.insert(next) {
+                    stack.push(next);
+                }
+            }
+        }
+        false
+    }
+}
+
+/// SplitMix64: small, seedable, good enough to shuffle traversal orders.
+struct SplitMix(u64);
+
+impl SplitMix {
+    fn next(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9E37_79B9_7F4A_7C15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+        z ^ (z >> 31)
+    }
+
+    fn below(&mut self, n: usize) -> usize {
+        (self.next() % n as u64) as usize
+    }
+}
+
+/// One randomized postorder labeling: roots in shuffled order, each
+/// component's children starting at a random offset.
+fn label(condensation: &Condensation, seed: u64) -> Vec<Interval> {
+    let k = condensation.len();
+    let mut rng = SplitMix(seed);
+
+    let mut has_parent = vec![false; k];
+    for c in 0..k as u32 {
+        for &d in condensation.successors(c) {
+            has_parent[d as usize] = true;
+        }
+    }
+    let mut roots: Vec<u32> = (0..k as u32).filter(|&c| !has_parent[c as usize]).collect();
+    for i in (1..roots.len()).rev() {
+        roots.swap(i, rng.below(i + 1));
+    }
+
+    let mut intervals = vec![Interval { low: u32::MAX, high: 0 }; k];
+    let mut visited = vec![false; k];
+    let mut rank = 0u32;
+    // (component, first child offset, children visited so far)
+    let mut stack: Vec<(u32, usize, usize)> = Vec::new();
+
+    for root in roots {
+        visited[root as usize] = true;
+        let start = rng.next() as usize;
+        stack.push((root, start, 0));
+
+        while let Some(frame) = stack.last_mut() {
+            let (c, start, i) = *frame;
+            let children = condensation.successors(c);
+            if i < children.len() {
+                frame.2 += 1;
+                let d = children[(start + i) % children.len()];
+                if !visited[d as usize] {
+                    visited[d as usize] = true;
+                    stack.push((d, rng.next() as usize, 0));
+                } else {
+                    // Already labelled: its subtree still bounds ours
+                    let low = intervals[d as usize].low;
+                    let own = &mut intervals[c as usize];
+                    own.low = own.low.min(low);
+                }
+                continue;
+            }
+
+            stack.pop();
+            rank += 1;
+            let own = &mut intervals[c as usize];
+            own.high = rank;
+            own.low = own.low.min(rank);
+            let low = own.low;
+            if let Some(&(parent, _, _)) = stack.last() {
+                let parent = &mut intervals[parent as usize];
+                parent.low = parent.low.min(low);
+            }
+        }
+    }
+    intervals
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    /// Ground truth by plain BFS.
+    fn bfs_reaches(graph: &CallGraph, from: NodeIdx, to: NodeIdx) -> bool {
+        let mut seen = vec![false; graph.vertex_count()];
+        let mut queue = vec![from];
+        seen[from as usize] = true;
+        while let Some(v) = queue.pop() {
+            if v == to {
+                return true;
+            }
+            for &w in graph.callees(v) {
+                if !seen[w as usize] {
+                    seen[w as usize] = true;
+                    queue.push(w);
+                }
+            }
+        }
+        false
+    }
+
+    #[test]
+    fn test_answers_match_bfs() {
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "b"]),
+            node("a", &["c", "d"]),
+            node("b", &["d", "e"]),
+            node("c", &["a", "f"]),
+            node("d", &["f"]),
+            node("e", &[]),
+            node("f", &["std::io"]),
+            node("island", &["e"]),
+        ]);
+        let index = ReachabilityIndex::build(&graph);
+
+        for from in graph.vertices() {
+            for to in graph.vertices() {
+                assert_eq!(
+                    index.reaches(from, to),
+                    bfs_reaches(&graph, from, to),
+                    "{} -> {}",
+                    graph.id(from),
+                    graph.id(to)
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn test_most_negatives_need_no_search() {
+        // Two independent chains: nothing crosses between them
+        let mut nodes = Vec::new();
+        for chain in ["x", "y"] {
+            for i in 0..50 {
+                let next = format!("{}{}", chain, i + 1);
+                nodes.push(node(&format!("{}{}", chain, i), &[next.as_str()]));
+            }
+        }
+        let graph = CallGraph::new(nodes);
+        let index = ReachabilityIndex::build(&graph);
+
+        let x0 = graph.idx_of("x0").unwrap();
+        let y0 = graph.idx_of("y0").unwrap();
+        let y50 = graph.idx_of("y50").unwrap();
+        assert_eq!(index.query(x0, y50), Reachability { reachable: false, by_index: true });
+        assert!(index.reaches(y0, y50));
+    }
+
+    #[test]
+    fn test_labels_are_deterministic() {
+        let graph = CallGraph::new(vec![node("a", &["b", "c"]), node("b", &["d"]), node("c", &["d"])]);
+        let one = ReachabilityIndex::build(&graph);
+        let two = ReachabilityIndex::build(&graph);
+        assert_eq!(one.intervals, two.intervals);
+    }
+}
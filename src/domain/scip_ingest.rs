@@ -1,15 +1,25 @@
 /// SCIP Index Ingestor.
 /// Parses SCIP indices and builds a precise CallGraph using semantic information.
 /// 
-/// Phase 3.1: Parallel processing with rayon and DashMap for high performance.
+/// Phase 3.1: Parallel processing with rayon, merging per-task partial
+/// results instead of sharing concurrent maps.
 
-use std::path::Path;
-use std::sync::atomic::{AtomicUsize, Ordering};
+use std::collections::hash_map::DefaultHasher;
+use std::collections::{BTreeMap, HashMap, HashSet};
+use std::hash::{Hash, Hasher};
+use std::path::{Path, PathBuf};
 use anyhow::{Context, Result};
-use dashmap::DashMap;
 use rayon::prelude::*;
+use scip::types::symbol_information::Kind;
 
-use crate::domain::callgraph::{CallGraph, CallGraphNode};
+use crate::domain::callgraph::{CallGraph, GraphBuilder, Location, NodeIdx};
+use crate::domain::scip_stream::{self, DocumentView};
+use crate::domain::symbol::Symbol;
+use crate::infrastructure::scheduler;
+
+/// Documents processed per parallel chunk. Between chunks a daemon
+/// background ingest yields to interactive queries.
+const INGEST_CHUNK_DOCS: usize = 256;
 
 /// Represents a range in source code.
 #[derive(Debug, Clone, PartialEq, Eq)]
@@ -34,175 +44,687 @@ impl SourceRange {
         }
         true
     }
+
+    fn start(&self) -> (i32, i32) {
+        (self.start_line, self.start_col)
+    }
+
+    fn end(&self) -> (i32, i32) {
+        (self.end_line, self.end_col)
+    }
 }
 
 /// A definition occurrence extracted from SCIP.
 #[derive(Debug, Clone)]
 struct DefinitionInfo {
-    symbol: String,
+    symbol: Symbol,
     range: SourceRange,
 }
 
+/// The definitions of one document, for finding the innermost definition
+/// enclosing a reference.
+///
+/// Definitions are sorted by start (enclosing before enclosed on ties) and
+/// a stack sweep links each to its innermost enclosing definition. Every
+/// definition that contains a reference is then an ancestor of the last
+/// definition starting at or before it, so a lookup is a binary search
+/// plus a walk up the (shallow) nesting chain.
+#[derive(Debug, Default)]
+struct DefinitionIndex {
+    defs: Vec<DefinitionInfo>,
+    /// Index of the innermost enclosing definition, `NO_PARENT` at top level
+    parent: Vec<u32>,
+}
+
+const NO_PARENT: u32 = u32::MAX;
+
+impl DefinitionIndex {
+    fn build(mut defs: Vec<DefinitionInfo>) -> Self {
+        defs.sort_by(|a, b| {
+            a.range.start().cmp(&b.range.start()).then(b.range.end().cmp(&a.range.end()))
+        });
+
+        let mut parent = Vec::with_capacity(defs.len());
+        let mut open: Vec<u32> = Vec::new();
+        for (i, def) in defs.iter().enumerate() {
+            while let Some(&top) = open.last() {
+                if defs[top as usize].range.contains(&def.range) {
+                    break;
+                }
+                open.pop();
+            }
+            parent.push(open.last().copied().unwrap_or(NO_PARENT));
+            open.push(i as u32);
+        }
+
+        Self { defs, parent }
+    }
+
+    /// Innermost definition containing `range`.
+    fn innermost(&self, range: &SourceRange) -> Option<&DefinitionInfo> {
+        let after = self.defs.partition_point(|d| d.range.start() <= range.start());
+        let mut current = after.checked_sub(1)? as u32;
+        loop {
+            let def = &self.defs[current as usize];
+            if def.range.contains(range) {
+                return Some(def);
+            }
+            current = self.parent[current as usize];
+            if current == NO_PARENT {
+                return None;
+            }
+        }
+    }
+}
+
+/// A definition site collected by the map phase.
+#[derive(Debug)]
+struct NodeData {
+    symbol: Symbol,
+    label: Symbol,
+    /// Definition site
+    location: Location,
+}
+
+/// How a symbol takes part in ingest.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum SymbolClass {
+    /// Becomes a node; references to it are call edges
+    Callable,
+    /// Target of the optional type-reference layer
+    Type,
+    /// Locals, fields, parameters, modules, constants: dropped
+    Other,
+}
+
+/// `SymbolInformation.Kind` values of callables.
+const CALLABLE_KINDS: &[i32] = &[
+    Kind::Constructor as i32,
+    Kind::Function as i32,
+    Kind::Getter as i32,
+    Kind::Method as i32,
+    Kind::Setter as i32,
+    Kind::AbstractMethod as i32,
+    Kind::MethodSpecification as i32,
+    Kind::ProtocolMethod as i32,
+    Kind::PureVirtualMethod as i32,
+    Kind::TraitMethod as i32,
+    Kind::TypeClassMethod as i32,
+    Kind::Accessor as i32,
+    Kind::MethodAlias as i32,
+    Kind::SingletonMethod as i32,
+    Kind::StaticMethod as i32,
+];
+
+/// Kinds of types.
+const TYPE_KINDS: &[i32] = &[
+    Kind::Class as i32,
+    Kind::Enum as i32,
+    Kind::Interface as i32,
+    Kind::Protocol as i32,
+    Kind::Struct as i32,
+    Kind::Trait as i32,
+    Kind::Type as i32,
+    Kind::TypeAlias as i32,
+    Kind::TypeClass as i32,
+    Kind::Union as i32,
+    Kind::SingletonClass as i32,
+];
+
+/// Classify by `SymbolInformation` kind when the indexer gave one, else by
+/// the last descriptor of the symbol: `().` is a method (every function in
+/// SCIP), `#` a type. `local N` symbols never leave their document. Ids
+/// that are not SCIP symbols at all are taken to be callable.
+fn classify(symbol: &str, kind: i32) -> SymbolClass {
+    if symbol.starts_with("local ") {
+        SymbolClass::Other
+    } else if kind != 0 {
+        if CALLABLE_KINDS.contains(&kind) {
+            SymbolClass::Callable
+        } else if TYPE_KINDS.contains(&kind) {
+            SymbolClass::Type
+        } else {
+            SymbolClass::Other
+        }
+    } else if symbol.splitn(5, ' ').count() < 5 {
+        SymbolClass::Callable
+    } else if symbol.ends_with(").") {
+        SymbolClass::Callable
+    } else if symbol.ends_with('#') {
+        SymbolClass::Type
+    } else {
+        SymbolClass::Other
+    }
+}
+
+/// Symbols whose `SymbolInformation` kind classifies them differently from
+/// their descriptor (e.g. a field named `new().`), gathered from every
+/// document before any is ingested. An indexer describes a symbol only in
+/// the document that defines it, so references from other documents are
+/// classified from this map.
+#[derive(Debug, Default, PartialEq, Eq)]
+struct KindOverrides(HashMap<&'static str, SymbolClass>);
+
+impl KindOverrides {
+    /// Map phase over the documents' `SymbolInformation`s only; for a
+    /// symbol described more than once, the first override found wins.
+    fn gather(documents: &[(&str, &[u8])]) -> Result<Self> {
+        let partials: Vec<HashMap<&'static str, SymbolClass>> = scheduler::fold_chunked(
+            documents,
+            INGEST_CHUNK_DOCS,
+            || Ok(HashMap::new()),
+            |acc: Result<HashMap<_, _>>, &(_, bytes)| {
+                let mut acc = acc?;
+                for info in scip_stream::document_symbols(bytes)? {
+                    if info.kind == 0 || acc.contains_key(info.symbol) {
+                        continue;
+                    }
+                    let class = classify(info.symbol, info.kind);
+                    if class != classify(info.symbol, 0) {
+                        acc.insert(Symbol::intern(info.symbol).as_str(), class);
+                    }
+                }
+                Ok(acc)
+            },
+        )
+        .into_iter()
+        .collect::<Result<_>>()
+        .context("Failed to parse SCIP index protobuf")?;
+
+        let mut overrides = HashMap::new();
+        for partial in partials {
+            for (symbol, class) in partial {
+                overrides.entry(symbol).or_insert(class);
+            }
+        }
+        Ok(Self(overrides))
+    }
+
+    fn class_of(&self, symbol: &str) -> SymbolClass {
+        self.0.get(symbol).copied().unwrap_or_else(|| classify(symbol, 0))
+    }
+}
+
+/// Optional parts of SCIP ingest.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct IngestOptions {
+    /// Also collect references from functions to types, as a separate layer
+    pub type_refs: bool,
+}
+
+/// The graphs one ingest produces.
+#[derive(Debug)]
+pub struct ScipGraphs {
+    /// Callable symbols and the calls between them
+    pub calls: CallGraph,
+    /// The same functions with edges to the types they mention, if requested
+    pub type_refs: Option<CallGraph>,
+}
+
+/// What one rayon task extracted from the documents it was handed. Tasks
+/// never share state; partials are merged once every document is done.
+#[derive(Debug, Default)]
+struct IngestPartial {
+    /// Callable definition sites in document order
+    defs: Vec<NodeData>,
+    /// Definitions dropped as not callable
+    skipped_defs: usize,
+    /// `(caller, callee)` pairs, self-calls dropped, possibly repeated
+    edges: Vec<(Symbol, Symbol)>,
+    /// `(function, type)` pairs, collected only when requested
+    type_refs: Option<Vec<(Symbol, Symbol)>>,
+}
+
+impl IngestPartial {
+    fn new(options: IngestOptions) -> Self {
+        Self {
+            type_refs: options.type_refs.then(Vec::new),
+            ..Self::default()
+        }
+    }
+
+    /// Decode one document, collect its callable definitions, then
+    /// attribute each of its references to the innermost one enclosing it.
+    /// `prefix` roots the document's path in the workspace.
+    fn add_document(mut self, prefix: &str, bytes: &[u8], kinds: &KindOverrides) -> Result<Self> {
+        let document = DocumentView::decode(bytes)?;
+        let class_of = |symbol: &str| kinds.class_of(symbol);
+        let mut file_defs: Vec<DefinitionInfo> = Vec::new();
+        // One interned path per document; lines stay plain numbers
+        let mut file: Option<Symbol> = None;
+
+        for occurrence in &document.occurrences {
+            if occurrence.is_definition() && !occurrence.symbol.is_empty() {
+                if class_of(occurrence.symbol) != SymbolClass::Callable {
+                    self.skipped_defs += 1;
+                    continue;
+                }
+                // The body, when the indexer reports it, rather than the name
+                let range = parse_scip_range(occurrence.range());
+                let span = match occurrence.enclosing_range() {
+                    [] => range.clone(),
+                    enclosing => parse_scip_range(enclosing),
+                };
+                let symbol = Symbol::intern(occurrence.symbol);
+                self.defs.push(NodeData {
+                    symbol,
+                    label: Symbol::intern(&extract_label_from_symbol(occurrence.symbol)),
+                    location: Location::new(
+                        *file.get_or_insert_with(|| Symbol::intern(&format!("{}{}", prefix, document.relative_path))),
+                        range.start_line as u32 + 1,
+                    ),
+                });
+                file_defs.push(DefinitionInfo { symbol, range: span });
+            }
+        }
+
+        // Without definitions, no reference in this file has a caller
+        if file_defs.is_empty() {
+            return Ok(self);
+        }
+        let file_defs = DefinitionIndex::build(file_defs);
+
+        for occurrence in &document.occurrences {
+            if occurrence.is_definition() || occurrence.symbol.is_empty() {
+                continue;
+            }
+            let layer = match (class_of(occurrence.symbol), self.type_refs.as_mut()) {
+                (SymbolClass::Callable, _) => &mut self.edges,
+                (SymbolClass::Type, Some(type_refs)) => type_refs,
+                _ => continue,
+            };
+            let ref_range = parse_scip_range(occurrence.range());
+            if let Some(def) = file_defs.innermost(&ref_range) {
+                let target = Symbol::intern(occurrence.symbol);
+                if def.symbol != target {
+                    layer.push((def.symbol, target));
+                }
+            }
+        }
+
+        Ok(self)
+    }
+}
+
+/// One SCIP index to ingest.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ScipInput {
+    pub path: PathBuf,
+    /// Prepended to every document path (e.g. `crates/core/`), so indices
+    /// generated per crate share the workspace's path namespace
+    pub path_prefix: String,
+    /// Directories (unprefixed, with a trailing slash) whose documents are
+    /// skipped because another input covers them, e.g. a nested crate
+    pub exclude: Vec<String>,
+}
+
+impl ScipInput {
+    pub fn new(path: impl Into<PathBuf>) -> Self {
+        Self { path: path.into(), path_prefix: String::new(), exclude: Vec::new() }
+    }
+}
+
 /// SCIP Ingestor for building CallGraphs from SCIP indices.
 pub struct ScipIngestor;
 
 impl ScipIngestor {
-    /// Ingest a SCIP index file and build a CallGraph.
+    /// Ingest a SCIP index file and build its call graph.
+    pub fn ingest_and_build_graph(scip_path: &Path) -> Result<CallGraph> {
+        Ok(Self::ingest(scip_path, IngestOptions::default())?.calls)
+    }
+
+    /// Ingest a SCIP index file into a call graph of callable symbols only
+    /// (see `classify`), plus the type-reference layer if requested.
+    pub fn ingest(scip_path: &Path, options: IngestOptions) -> Result<ScipGraphs> {
+        Self::ingest_all(&[ScipInput::new(scip_path)], options)
+    }
+
+    /// Ingest several SCIP indices (e.g. one per crate) as one graph.
     /// 
-    /// Uses parallel processing for both definition collection (Pass 1)
-    /// and reference resolution (Pass 2).
+    /// Map-reduce: each rayon task folds its documents into a private
+    /// `IngestPartial` (definitions and resolved call edges) with no shared
+    /// maps or atomics, then the partials are concatenated, sorted and
+    /// deduplicated in parallel and frozen into CSR.
     /// 
     /// Phase 3.3: Uses memory-mapped file I/O to avoid large allocations.
-    pub fn ingest_and_build_graph(scip_path: &Path) -> Result<CallGraph> {
-        use std::fs::File;
-        use memmap2::Mmap;
-        use protobuf::Message;
+    /// The index is never parsed as a whole: documents are located in the
+    /// mapping and each task decodes only the fields ingest reads, borrowing
+    /// strings from the map, so decoded data is bounded by the documents in
+    /// flight.
+    ///
+    /// Documents are processed in chunks of `INGEST_CHUNK_DOCS` so a daemon
+    /// background ingest can pause for interactive queries.
+    pub fn ingest_all(inputs: &[ScipInput], options: IngestOptions) -> Result<ScipGraphs> {
+        for input in inputs {
+            println!("[SCIP Ingest] Loading index from: {}", input.path.display());
+        }
+        let maps = map_inputs(inputs)?;
+        let documents = input_documents(inputs, &maps)?;
 
-        println!("[SCIP Ingest] Loading index from: {}", scip_path.display());
-        
-        // Memory-map the SCIP index file for efficient access
-        let file = File::open(scip_path)
-            .context("Failed to open SCIP index file")?;
-        
-        // SAFETY: We assume the file won't be modified while we're reading it.
-        // The mmap provides a zero-copy view into the file.
-        let mmap = unsafe { Mmap::map(&file) }
-            .context("Failed to memory-map SCIP index file")?;
-        
-        let index = scip::types::Index::parse_from_bytes(&mmap)
-            .context("Failed to parse SCIP index protobuf")?;
+        // ═══════════════════════════════════════════════════════════════════
+        // Map: symbol kinds across all documents, then per-task definitions
+        // and call edges
+        // ═══════════════════════════════════════════════════════════════════
+
+        let kinds = KindOverrides::gather(&documents)?;
+        let mut partials: Vec<IngestPartial> = scheduler::fold_chunked(
+            &documents,
+            INGEST_CHUNK_DOCS,
+            || Ok(IngestPartial::new(options)),
+            |partial: Result<IngestPartial>, &(prefix, bytes)| partial.and_then(|p| p.add_document(prefix, bytes, &kinds)),
+        )
+        .into_iter()
+        .collect::<Result<_>>()
+        .context("Failed to parse SCIP index protobuf")?;
 
         // ═══════════════════════════════════════════════════════════════════
-        // Pass 1: Parallel Definition Collection
+        // Reduce: merge, sort and dedup, then freeze into CSR
         // ═══════════════════════════════════════════════════════════════════
-        
-        // Thread-safe maps for parallel access
-        let definitions_by_file: DashMap<String, Vec<DefinitionInfo>> = DashMap::new();
-        let symbol_to_node: DashMap<String, usize> = DashMap::new();
-        let node_counter = AtomicUsize::new(0);
-        
-        // Collect nodes in parallel (we'll sort them later)
-        let node_data: DashMap<usize, CallGraphNode> = DashMap::new();
-
-        index.documents.par_iter().for_each(|document| {
-            let file_path = document.relative_path.clone();
-            let mut file_defs: Vec<DefinitionInfo> = Vec::new();
-
-            for occurrence in &document.occurrences {
-                // Check if this is a Definition (bit 0 of symbol_roles)
-                let is_definition = occurrence.symbol_roles & 1 != 0;
-                
-                if is_definition && !occurrence.symbol.is_empty() {
-                    let range = parse_scip_range(&occurrence.range);
-                    
-                    // Atomically get or create node ID for this symbol
-                    let node_id = *symbol_to_node
-                        .entry(occurrence.symbol.clone())
-                        .or_insert_with(|| {
-                            let id = node_counter.fetch_add(1, Ordering::SeqCst);
-                            let label = extract_label_from_symbol(&occurrence.symbol);
-                            node_data.insert(id, CallGraphNode {
-                                id: occurrence.symbol.clone(),
-                                callees: Vec::new(),
-                                label: Some(label),
-                            });
-                            id
-                        });
-
-                    // We don't use node_id here directly, just ensure it's registered
-                    let _ = node_id;
-
-                    file_defs.push(DefinitionInfo {
-                        symbol: occurrence.symbol.clone(),
-                        range,
-                    });
-                }
+
+        let mut nodes: Vec<NodeData> = Vec::with_capacity(partials.iter().map(|p| p.defs.len()).sum());
+        let mut edges: Vec<(Symbol, Symbol)> = Vec::with_capacity(partials.iter().map(|p| p.edges.len()).sum());
+        let mut type_refs: Option<Vec<(Symbol, Symbol)>> = options.type_refs.then(Vec::new);
+        let mut skipped = 0;
+        for partial in &mut partials {
+            nodes.append(&mut partial.defs);
+            edges.append(&mut partial.edges);
+            if let (Some(all), Some(part)) = (type_refs.as_mut(), partial.type_refs.as_mut()) {
+                all.append(part);
             }
+            skipped += partial.skipped_defs;
+        }
 
-            // Sort definitions by range size (largest first) for containment lookup
-            file_defs.sort_by(|a, b| {
-                let a_size = (a.range.end_line - a.range.start_line) * 1000 
-                           + (a.range.end_col - a.range.start_col);
-                let b_size = (b.range.end_line - b.range.start_line) * 1000 
-                           + (b.range.end_col - b.range.start_col);
-                b_size.cmp(&a_size) // Largest first
-            });
+        // Sort by symbol string for deterministic output; the sort is
+        // stable, so a symbol defined twice keeps its first site
+        rayon::join(
+            || nodes.par_sort_by(|a, b| a.symbol.as_str().cmp(b.symbol.as_str())),
+            || {
+                sort_edges(&mut edges);
+                if let Some(type_refs) = type_refs.as_mut() {
+                    sort_edges(type_refs);
+                }
+            },
+        );
+        nodes.dedup_by_key(|node| node.symbol);
 
-            definitions_by_file.insert(file_path, file_defs);
-        });
+        println!("[SCIP Ingest] Found {} callable definitions ({} other definitions skipped)", nodes.len(), skipped);
+        println!("[SCIP Ingest] Created {} edges (parallel)", edges.len());
+        if let Some(type_refs) = &type_refs {
+            println!("[SCIP Ingest] Collected {} type references", type_refs.len());
+        }
+
+        let (calls, type_refs) = rayon::join(
+            || freeze(&nodes, &edges),
+            || type_refs.map(|type_refs| freeze(&nodes, &type_refs)),
+        );
+        Ok(ScipGraphs { calls, type_refs })
+    }
+}
 
-        let def_count = node_counter.load(Ordering::SeqCst);
-        println!("[SCIP Ingest] Found {} definitions (parallel)", def_count);
+fn sort_edges(edges: &mut Vec<(Symbol, Symbol)>) {
+    edges.par_sort_unstable_by_key(|&(caller, callee)| (caller.index(), callee.index()));
+    edges.dedup();
+}
 
-        // ═══════════════════════════════════════════════════════════════════
-        // Pass 2: Parallel Reference Resolution
-        // ═══════════════════════════════════════════════════════════════════
-        
-        let edge_counter = AtomicUsize::new(0);
-
-        index.documents.par_iter().for_each(|document| {
-            let file_path = &document.relative_path;
-            
-            // Get definitions for this file (if any)
-            let file_defs = definitions_by_file
-                .get(file_path)
-                .map(|r| r.clone())
-                .unwrap_or_default();
-
-            for occurrence in &document.occurrences {
-                // Check if this is a Reference (not a definition)
-                let is_definition = occurrence.symbol_roles & 1 != 0;
-                
-                if !is_definition && !occurrence.symbol.is_empty() {
-                    let ref_range = parse_scip_range(&occurrence.range);
-                    let callee_symbol = &occurrence.symbol;
-
-                    // Find the enclosing definition (the caller)
-                    for def in &file_defs {
-                        if def.range.contains(&ref_range) {
-                            let caller_symbol = &def.symbol;
-                            
-                            // Add edge: caller -> callee
-                            if let Some(caller_idx) = symbol_to_node.get(caller_symbol) {
-                                // Avoid self-references
-                                if caller_symbol != callee_symbol {
-                                    // Thread-safe edge insertion
-                                    if let Some(mut node) = node_data.get_mut(&*caller_idx) {
-                                        if !node.callees.contains(callee_symbol) {
-                                            node.callees.push(callee_symbol.clone());
-                                            edge_counter.fetch_add(1, Ordering::Relaxed);
-                                        }
-                                    }
-                                }
-                            }
-                            break; // Found the innermost enclosing definition
-                        }
-                    }
+/// Freeze deduplicated nodes and edges into CSR.
+fn freeze(nodes: &[NodeData], edges: &[(Symbol, Symbol)]) -> CallGraph {
+    let mut builder = GraphBuilder::with_capacity(nodes.len());
+    for node in nodes {
+        let idx = builder.add_node(node.symbol, Some(node.label));
+        builder.set_location(idx, node.location);
+    }
+    for &(caller, callee) in edges {
+        builder.add_edge(caller, callee);
+    }
+    builder.build()
+}
+
+/// Memory-map a SCIP index file for efficient access.
+fn map_index(scip_path: &Path) -> Result<memmap2::Mmap> {
+    let file = std::fs::File::open(scip_path)
+        .with_context(|| format!("Failed to open SCIP index file: {}", scip_path.display()))?;
+
+    // SAFETY: We assume the file won't be modified while we're reading it.
+    // The mmap provides a zero-copy view into the file.
+    unsafe { memmap2::Mmap::map(&file) }
+        .context("Failed to memory-map SCIP index file")
+}
+
+fn map_inputs(inputs: &[ScipInput]) -> Result<Vec<memmap2::Mmap>> {
+    inputs
+        .iter()
+        .map(|input| map_index(&input.path))
+        .collect()
+}
+
+/// Encoded documents of every input, in order, each with its input's path
+/// prefix; documents under an input's `exclude` directories are left out.
+/// `maps` holds the inputs' mappings.
+fn input_documents<'a>(inputs: &'a [ScipInput], maps: &'a [memmap2::Mmap]) -> Result<Vec<(&'a str, &'a [u8])>> {
+    let mut documents = Vec::new();
+    for (input, mmap) in inputs.iter().zip(maps) {
+        for document in scip_stream::documents(mmap) {
+            let document = document.context("Failed to parse SCIP index protobuf")?;
+            if !input.exclude.is_empty() {
+                let path = scip_stream::document_path(document).context("Failed to parse SCIP index protobuf")?;
+                if input.exclude.iter().any(|dir| path.starts_with(dir.as_str())) {
+                    continue;
                 }
             }
-        });
+            documents.push((input.path_prefix.as_str(), document));
+        }
+    }
+    Ok(documents)
+}
 
-        let edge_count = edge_counter.load(Ordering::Relaxed);
-        println!("[SCIP Ingest] Created {} edges (parallel)", edge_count);
+/// What one document added to the graph, kept so it can be retracted.
+#[derive(Debug)]
+struct DocumentContribution {
+    /// Hash of the encoded document
+    hash: u64,
+    defs: Vec<NodeData>,
+    /// Sorted and deduplicated
+    edges: Vec<(Symbol, Symbol)>,
+}
 
-        // ═══════════════════════════════════════════════════════════════════
-        // Finalize: Convert DashMap to sorted Vec
-        // ═══════════════════════════════════════════════════════════════════
-        
-        let mut nodes: Vec<CallGraphNode> = node_data
-            .into_iter()
-            .collect::<Vec<_>>()
-            .into_iter()
-            .map(|(_, node)| node)
+impl DocumentContribution {
+    fn decode(prefix: &str, bytes: &[u8], hash: u64, kinds: &KindOverrides) -> Result<Self> {
+        let mut partial = IngestPartial::default().add_document(prefix, bytes, kinds)?;
+        partial.edges.sort_unstable_by_key(|&(caller, callee)| (caller.index(), callee.index()));
+        partial.edges.dedup();
+        Ok(Self { hash, defs: partial.defs, edges: partial.edges })
+    }
+}
+
+/// A defined symbol of the resident graph.
+#[derive(Debug)]
+struct ResidentNode {
+    symbol: Symbol,
+    /// `(document, label, location)` per definition; the first one present
+    /// labels and locates the node
+    sites: Vec<(Symbol, Symbol, Location)>,
+    /// Callees in symbol order, with the number of documents contributing
+    /// each call
+    callees: Vec<(Symbol, u32)>,
+}
+
+/// Documents re-ingested by an `IncrementalIngestor::update`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct IngestStats {
+    pub documents: usize,
+    /// New or edited documents, decoded and re-applied
+    pub changed: usize,
+    /// Documents no longer in the index, retracted
+    pub removed: usize,
+}
+
+/// SCIP ingest that keeps each document's contribution, keyed by path and
+/// content hash, next to the aggregated graph they add up to.
+///
+/// An update hashes every document of the new index (a linear scan over
+/// the mapping), decodes only documents whose hash changed, retracts their
+/// old definitions and edges and applies the new ones. Nodes are kept in
+/// symbol order and callees per node, so freezing the result is a single
+/// pass with no sorting. Edges are counted per contributing document, so a
+/// call survives as long as any document still makes it. Symbol kinds are
+/// gathered from every document on each update; if they classify any
+/// symbol differently than before, every document is re-decoded, since
+/// unchanged documents may reference it.
+#[derive(Debug, Default)]
+pub struct IncrementalIngestor {
+    documents: HashMap<Symbol, DocumentContribution>,
+    nodes: BTreeMap<&'static str, ResidentNode>,
+    kinds: KindOverrides,
+}
+
+impl IncrementalIngestor {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Bring the resident state up to date with the index at `scip_path`
+    /// and freeze it into a graph. The first update ingests everything.
+    pub fn update(&mut self, scip_path: &Path) -> Result<(CallGraph, IngestStats)> {
+        self.update_all(&[ScipInput::new(scip_path)])
+    }
+
+    /// `update` over several indices (e.g. one per crate); documents are
+    /// keyed by their prefixed path.
+    pub fn update_all(&mut self, inputs: &[ScipInput]) -> Result<(CallGraph, IngestStats)> {
+        let maps = map_inputs(inputs)?;
+        let documents = input_documents(inputs, &maps)?;
+
+        // Identify every document; only changed ones are decoded in full
+        let keyed: Vec<(Symbol, u64, &str, &[u8])> = documents
+            .par_iter()
+            .map(|&(prefix, bytes)| {
+                let path = scip_stream::document_path(bytes)?;
+                let key = if prefix.is_empty() {
+                    Symbol::intern(path)
+                } else {
+                    Symbol::intern(&format!("{}{}", prefix, path))
+                };
+                Ok((key, content_hash(bytes), prefix, bytes))
+            })
+            .collect::<Result<_>>()
+            .context("Failed to parse SCIP index protobuf")?;
+
+        let kinds = KindOverrides::gather(&documents)?;
+        let reclassified = kinds != self.kinds;
+        let changed: Vec<(Symbol, u64, &str, &[u8])> = keyed
+            .iter()
+            .copied()
+            .filter(|(path, hash, _, _)| reclassified || self.documents.get(path).map_or(true, |c| c.hash != *hash))
             .collect();
-        
-        // Sort by ID for deterministic output
-        nodes.sort_by(|a, b| a.id.cmp(&b.id));
+        let present: HashSet<Symbol> = keyed.iter().map(|&(path, _, _, _)| path).collect();
+        let removed: Vec<Symbol> = self
+            .documents
+            .keys()
+            .copied()
+            .filter(|path| !present.contains(path))
+            .collect();
+
+        let decoded: Vec<Vec<(Symbol, DocumentContribution)>> = scheduler::fold_chunked(
+            &changed,
+            INGEST_CHUNK_DOCS,
+            || Ok(Vec::new()),
+            |acc: Result<Vec<_>>, &(path, hash, prefix, bytes)| {
+                let mut acc = acc?;
+                acc.push((path, DocumentContribution::decode(prefix, bytes, hash, &kinds)?));
+                Ok(acc)
+            },
+        )
+        .into_iter()
+        .collect::<Result<_>>()
+        .context("Failed to parse SCIP index protobuf")?;
 
-        Ok(CallGraph { nodes })
+        for path in &removed {
+            if let Some(old) = self.documents.remove(path) {
+                self.retract(*path, &old);
+            }
+        }
+        for (path, contribution) in decoded.into_iter().flatten() {
+            if let Some(old) = self.documents.remove(&path) {
+                self.retract(path, &old);
+            }
+            self.apply(path, &contribution);
+            self.documents.insert(path, contribution);
+        }
+        self.kinds = kinds;
+
+        let stats = IngestStats { documents: keyed.len(), changed: changed.len(), removed: removed.len() };
+        println!(
+            "[SCIP Ingest] Incremental: {} changed, {} removed of {} documents",
+            stats.changed, stats.removed, stats.documents
+        );
+        Ok((self.graph(), stats))
+    }
+
+    fn apply(&mut self, document: Symbol, contribution: &DocumentContribution) {
+        for def in &contribution.defs {
+            self.nodes
+                .entry(def.symbol.as_str())
+                .or_insert_with(|| ResidentNode { symbol: def.symbol, sites: Vec::new(), callees: Vec::new() })
+                .sites
+                .push((document, def.label, def.location));
+        }
+        for &(caller, callee) in &contribution.edges {
+            // The caller is defined in this same document, so it exists
+            let callees = &mut self.nodes.get_mut(caller.as_str()).unwrap().callees;
+            match callees.binary_search_by_key(&callee.index(), |(c, _)| c.index()) {
+                Ok(i) => callees[i].1 += 1,
+                Err(i) => callees.insert(i, (callee, 1)),
+            }
+        }
+    }
+
+    fn retract(&mut self, document: Symbol, contribution: &DocumentContribution) {
+        for &(caller, callee) in &contribution.edges {
+            if let Some(node) = self.nodes.get_mut(caller.as_str()) {
+                if let Ok(i) = node.callees.binary_search_by_key(&callee.index(), |(c, _)| c.index()) {
+                    node.callees[i].1 -= 1;
+                    if node.callees[i].1 == 0 {
+                        node.callees.remove(i);
+                    }
+                }
+            }
+        }
+        for def in &contribution.defs {
+            if let Some(node) = self.nodes.get_mut(def.symbol.as_str()) {
+                if let Some(i) = node.sites.iter().position(|&(doc, _, _)| doc == document) {
+                    node.sites.remove(i);
+                }
+                if node.sites.is_empty() {
+                    self.nodes.remove(def.symbol.as_str());
+                }
+            }
+        }
+    }
+
+    /// Freeze the resident state into CSR.
+    fn graph(&self) -> CallGraph {
+        let mut builder = GraphBuilder::with_capacity(self.nodes.len());
+        for node in self.nodes.values() {
+            let (_, label, location) = node.sites[0];
+            let idx = builder.add_node(node.symbol, Some(label));
+            builder.set_location(idx, location);
+        }
+        for (caller, node) in self.nodes.values().enumerate() {
+            for &(callee, _) in &node.callees {
+                let callee = builder.intern(callee);
+                builder.add_edge_idx(caller as NodeIdx, callee);
+            }
+        }
+        builder.build()
     }
 }
 
+fn content_hash(bytes: &[u8]) -> u64 {
+    let mut hasher = DefaultHasher::new();
+    bytes.hash(&mut hasher);
+    hasher.finish()
+}
+
 /// Parse SCIP range format: [start_line, start_col, end_line, end_col] or [start_line, start_col, end_col]
 fn parse_scip_range(range: &[i32]) -> SourceRange {
     match range.len() {
@@ -242,6 +764,7 @@ fn extract_label_from_symbol(symbol: &str) -> String {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::domain::delta::GraphDelta;
     use tempfile::tempdir;
     use std::fs::File;
     use std::io::Write;
@@ -261,6 +784,54 @@ mod tests {
         assert!(!inner.contains(&outer));
     }
 
+    #[test]
+    fn test_definition_index_finds_innermost() {
+        let def = |name: &str, range: &[i32]| DefinitionInfo {
+            symbol: Symbol::intern(name),
+            range: parse_scip_range(range),
+        };
+        // outer { a { a_inner } b }, then a sibling at top level
+        let index = DefinitionIndex::build(vec![
+            def("b", &[20, 4, 30, 5]),
+            def("outer", &[0, 0, 40, 1]),
+            def("a_inner", &[5, 8, 8, 9]),
+            def("a", &[2, 4, 15, 5]),
+            def("later", &[50, 0, 60, 1]),
+        ]);
+        let caller = |range: &[i32]| index.innermost(&parse_scip_range(range)).map(|d| d.symbol.as_str());
+
+        assert_eq!(caller(&[6, 10, 20]), Some("a_inner"));
+        assert_eq!(caller(&[12, 8, 14]), Some("a"));
+        assert_eq!(caller(&[17, 0, 9]), Some("outer"));
+        assert_eq!(caller(&[25, 4, 12]), Some("b"));
+        assert_eq!(caller(&[55, 2, 7]), Some("later"));
+        assert_eq!(caller(&[45, 0, 3]), None);
+    }
+
+    #[test]
+    fn test_classify_symbols() {
+        let scip = |descriptors: &str| format!("rust-analyzer cargo app 0.1.0 {}", descriptors);
+        assert_eq!(classify(&scip("lib/parse()."), 0), SymbolClass::Callable);
+        assert_eq!(classify(&scip("lib/Parser#next()."), 0), SymbolClass::Callable);
+        assert_eq!(classify(&scip("lib/Parser#"), 0), SymbolClass::Type);
+        assert_eq!(classify(&scip("lib/Parser#pos."), 0), SymbolClass::Other);
+        assert_eq!(classify(&scip("lib/"), 0), SymbolClass::Other);
+        assert_eq!(classify("local 7", 0), SymbolClass::Other);
+        // Kinds override the descriptor
+        let kind = |k: Kind| k as i32;
+        assert_eq!(classify(&scip("lib/Parser#new()."), kind(Kind::Field)), SymbolClass::Other);
+        assert_eq!(classify(&scip("lib/Alias#"), kind(Kind::TypeAlias)), SymbolClass::Type);
+        assert_eq!(classify(&scip("lib/Parser#"), kind(Kind::Struct)), SymbolClass::Type);
+        assert_eq!(classify(&scip("lib/Value#"), kind(Kind::Union)), SymbolClass::Type);
+        assert_eq!(classify(&scip("lib/Parser#set_pos()."), kind(Kind::Setter)), SymbolClass::Callable);
+        // Neighbours of those codes must not be mistaken for them
+        assert_eq!(classify(&scip("lib/Parser#pos."), kind(Kind::Property)), SymbolClass::Other);
+        assert_eq!(classify(&scip("lib/Parser#new().(self)"), kind(Kind::SelfParameter)), SymbolClass::Other);
+        assert_eq!(classify(&scip("lib/parse().[T]"), kind(Kind::TypeParameter)), SymbolClass::Other);
+        // Not a SCIP symbol: kept as before
+        assert_eq!(classify("pkg::func_a", 0), SymbolClass::Callable);
+    }
+
     #[test]
     fn test_parse_scip_range() {
         let r3 = parse_scip_range(&[10, 5, 15]);
@@ -323,7 +894,7 @@ mod tests {
         assert!(result.is_ok(), "Failed: {:?}", result.err());
         
         let graph = result.unwrap();
-        assert_eq!(graph.nodes.len(), 50); // 5 docs * 10 defs
+        assert_eq!(graph.node_count(), 50); // 5 docs * 10 defs
     }
 
     #[test]
@@ -341,7 +912,7 @@ mod tests {
         assert!(result.is_ok());
         
         let graph = result.unwrap();
-        assert_eq!(graph.nodes.len(), 0);
+        assert_eq!(graph.node_count(), 0);
     }
 
     #[test]
@@ -354,7 +925,7 @@ mod tests {
         assert!(result.is_ok(), "Failed: {:?}", result.err());
         
         let graph = result.unwrap();
-        assert_eq!(graph.nodes.len(), 5000);
+        assert_eq!(graph.node_count(), 5000);
     }
 
     #[test]
@@ -430,12 +1001,205 @@ mod tests {
         let graph = result.unwrap();
         
         // Should have 2 definitions
-        assert_eq!(graph.nodes.len(), 2);
+        assert_eq!(graph.node_count(), 2);
         
         // func_a should call func_b
-        let func_a = graph.nodes.iter().find(|n| n.id == "pkg::func_a");
+        let func_a = graph.idx_of("pkg::func_a");
         assert!(func_a.is_some());
-        assert!(func_a.unwrap().callees.contains(&"pkg::func_b".to_string()));
+        assert!(graph.callees_of("pkg::func_a").contains(&"pkg::func_b"));
     }
-}
 
+    fn write_index(dir: &std::path::Path, docs: &[(&str, &[(&str, Vec<i32>, i32)])]) -> std::path::PathBuf {
+        let mut index = scip::types::Index::new();
+        for (path, occurrences) in docs {
+            let mut doc = scip::types::Document::new();
+            doc.relative_path = path.to_string();
+            for (symbol, range, roles) in occurrences.iter() {
+                let mut occ = scip::types::Occurrence::new();
+                occ.symbol = symbol.to_string();
+                occ.range = range.clone();
+                occ.symbol_roles = *roles;
+                doc.occurrences.push(occ);
+            }
+            index.documents.push(doc);
+        }
+        let path = dir.join("index.scip");
+        std::fs::write(&path, index.write_to_bytes().unwrap()).unwrap();
+        path
+    }
+
+    #[test]
+    fn test_incremental_reingests_only_changed_documents() {
+        let dir = tempdir().unwrap();
+        let a: &[(&str, Vec<i32>, i32)] = &[("pkg::a", vec![0, 0, 20, 0], 1), ("pkg::b", vec![5, 4, 9], 0)];
+        let b: &[(&str, Vec<i32>, i32)] = &[("pkg::b", vec![0, 0, 10, 0], 1), ("pkg::c", vec![3, 4, 9], 0)];
+        let c: &[(&str, Vec<i32>, i32)] = &[("pkg::c", vec![0, 0, 10, 0], 1)];
+        let mut ingest = IncrementalIngestor::new();
+
+        let path = write_index(dir.path(), &[("src/a.rs", a), ("src/b.rs", b), ("src/c.rs", c)]);
+        let (graph, stats) = ingest.update(&path).unwrap();
+        assert_eq!(stats, IngestStats { documents: 3, changed: 3, removed: 0 });
+        let full = ScipIngestor::ingest_and_build_graph(&path).unwrap();
+        assert!(GraphDelta::between(&full, &graph).is_empty());
+
+        // b.rs now calls a instead of c; c.rs is deleted
+        let b: &[(&str, Vec<i32>, i32)] = &[("pkg::b", vec![0, 0, 10, 0], 1), ("pkg::a", vec![3, 4, 9], 0)];
+        let path = write_index(dir.path(), &[("src/a.rs", a), ("src/b.rs", b)]);
+        let (graph, stats) = ingest.update(&path).unwrap();
+        assert_eq!(stats, IngestStats { documents: 2, changed: 1, removed: 1 });
+
+        assert_eq!(graph.node_count(), 2);
+        assert_eq!(graph.callees_of("pkg::b"), vec!["pkg::a"]);
+        assert_eq!(graph.callees_of("pkg::a"), vec!["pkg::b"]);
+        let full = ScipIngestor::ingest_and_build_graph(&path).unwrap();
+        assert!(GraphDelta::between(&full, &graph).is_empty());
+
+        let (_, stats) = ingest.update(&path).unwrap();
+        assert_eq!(stats.changed, 0);
+    }
+
+    #[test]
+    fn test_only_callables_become_nodes() {
+        let dir = tempdir().unwrap();
+        let sym = |descriptors: &str| format!("rust-analyzer cargo app 0.1.0 {}", descriptors);
+        let (run, parser, field, next) = (sym("main/run()."), sym("lib/Parser#"), sym("lib/Parser#pos."), sym("lib/Parser#next()."));
+
+        let mut doc = scip::types::Document::new();
+        doc.relative_path = "src/main.rs".to_string();
+        let mut def_run = scip::types::Occurrence::new();
+        def_run.symbol = run.clone();
+        def_run.range = vec![1, 3, 6];
+        def_run.enclosing_range = vec![1, 0, 10, 1];
+        def_run.symbol_roles = 1;
+        doc.occurrences.push(def_run);
+        for (symbol, range, roles) in [
+            ("local 0", vec![2, 8, 9], 1),
+            (parser.as_str(), vec![2, 12, 18], 0),
+            (field.as_str(), vec![3, 6, 9], 0),
+            (next.as_str(), vec![4, 6, 10], 0),
+            ("local 0", vec![4, 4, 5], 0),
+        ] {
+            let mut occ = scip::types::Occurrence::new();
+            occ.symbol = symbol.to_string();
+            occ.range = range;
+            occ.symbol_roles = roles;
+            doc.occurrences.push(occ);
+        }
+        let mut index = scip::types::Index::new();
+        index.documents.push(doc);
+        let path = dir.path().join("kinds.scip");
+        std::fs::write(&path, index.write_to_bytes().unwrap()).unwrap();
+
+        let graphs = ScipIngestor::ingest(&path, IngestOptions { type_refs: true }).unwrap();
+        assert_eq!(graphs.calls.node_count(), 1);
+        assert_eq!(graphs.calls.callees_of(&run), vec![next.as_str()]);
+        assert_eq!(graphs.type_refs.unwrap().callees_of(&run), vec![parser.as_str()]);
+
+        let calls_only = ScipIngestor::ingest(&path, IngestOptions::default()).unwrap();
+        assert!(calls_only.type_refs.is_none());
+    }
+
+    #[test]
+    fn test_ingests_several_indices_with_path_prefixes() {
+        let dir = tempdir().unwrap();
+        let app: &[(&str, Vec<i32>, i32)] = &[("app::main", vec![0, 0, 9, 1], 1), ("core::parse", vec![2, 4, 9], 0)];
+        let core: &[(&str, Vec<i32>, i32)] = &[("core::parse", vec![4, 0, 8, 1], 1)];
+        let app_dir = dir.path().join("app");
+        let core_dir = dir.path().join("core");
+        std::fs::create_dir_all(&app_dir).unwrap();
+        std::fs::create_dir_all(&core_dir).unwrap();
+        let inputs = [
+            ScipInput { path_prefix: "crates/app/".to_string(), ..ScipInput::new(write_index(&app_dir, &[("src/lib.rs", app)])) },
+            ScipInput { path_prefix: "crates/core/".to_string(), ..ScipInput::new(write_index(&core_dir, &[("src/lib.rs", core)])) },
+        ];
+
+        let graph = ScipIngestor::ingest_all(&inputs, IngestOptions::default()).unwrap().calls;
+        assert_eq!(graph.callees_of("app::main"), vec!["core::parse"]);
+        let parse = graph.idx_of("core::parse").unwrap();
+        assert_eq!(graph.location(parse).map(|l| l.to_string()).as_deref(), Some("crates/core/src/lib.rs:5"));
+
+        // Same relative path in both crates: still two documents
+        let (_, stats) = IncrementalIngestor::new().update_all(&inputs).unwrap();
+        assert_eq!(stats.documents, 2);
+    }
+
+    #[test]
+    fn test_nested_member_documents_come_from_the_member_only() {
+        let dir = tempdir().unwrap();
+        let main: &[(&str, Vec<i32>, i32)] = &[("app::main", vec![0, 0, 9, 1], 1), ("b::parse", vec![2, 4, 9], 0)];
+        let parse: &[(&str, Vec<i32>, i32)] = &[("b::parse", vec![4, 0, 8, 1], 1)];
+        let root_dir = dir.path().join("root");
+        let member_dir = dir.path().join("b");
+        std::fs::create_dir_all(&root_dir).unwrap();
+        std::fs::create_dir_all(&member_dir).unwrap();
+
+        // The root package's indexer also sees the nested member's files
+        let inputs = [
+            ScipInput {
+                exclude: vec!["repos/b/".to_string()],
+                ..ScipInput::new(write_index(&root_dir, &[("src/main.rs", main), ("repos/b/src/lib.rs", parse)]))
+            },
+            ScipInput { path_prefix: "repos/b/".to_string(), ..ScipInput::new(write_index(&member_dir, &[("src/lib.rs", parse)])) },
+        ];
+
+        let graph = ScipIngestor::ingest_all(&inputs, IngestOptions::default()).unwrap().calls;
+        assert_eq!(graph.node_count(), 2);
+        assert_eq!(graph.callees_of("app::main"), vec!["b::parse"]);
+
+        let (_, stats) = IncrementalIngestor::new().update_all(&inputs).unwrap();
+        assert_eq!(stats.documents, 2);
+    }
+
+    #[test]
+    fn test_kinds_classify_references_from_other_documents() {
+        let dir = tempdir().unwrap();
+        let sym = |descriptors: &str| format!("rust-analyzer cargo app 0.1.0 {}", descriptors);
+        let (run, new) = (sym("main/run()."), sym("lib/Parser#new()."));
+        let index = |kind: Kind| {
+            let mut index = scip::types::Index::new();
+            // a.rs defines `new().` and says what it is
+            let mut a = scip::types::Document::new();
+            a.relative_path = "src/a.rs".to_string();
+            let mut def_new = scip::types::Occurrence::new();
+            def_new.symbol = new.clone();
+            def_new.range = vec![0, 0, 3, 1];
+            def_new.symbol_roles = 1;
+            a.occurrences.push(def_new);
+            let mut info = scip::types::SymbolInformation::new();
+            info.symbol = new.clone();
+            info.kind = protobuf::EnumOrUnknown::new(kind);
+            a.symbols.push(info);
+            index.documents.push(a);
+            // b.rs only references it
+            let mut b = scip::types::Document::new();
+            b.relative_path = "src/b.rs".to_string();
+            for (symbol, range, roles) in [(run.as_str(), vec![0, 0, 9, 1], 1), (new.as_str(), vec![2, 4, 9], 0)] {
+                let mut occ = scip::types::Occurrence::new();
+                occ.symbol = symbol.to_string();
+                occ.range = range;
+                occ.symbol_roles = roles;
+                b.occurrences.push(occ);
+            }
+            index.documents.push(b);
+            let path = dir.path().join("index.scip");
+            std::fs::write(&path, index.write_to_bytes().unwrap()).unwrap();
+            path
+        };
+        let mut ingest = IncrementalIngestor::new();
+
+        let path = index(Kind::Field);
+        let graph = ScipIngestor::ingest_and_build_graph(&path).unwrap();
+        assert_eq!(graph.node_count(), 1);
+        assert!(graph.callees_of(&run).is_empty());
+        let (incremental, _) = ingest.update(&path).unwrap();
+        assert!(GraphDelta::between(&graph, &incremental).is_empty());
+
+        // Only a.rs changes, but b.rs's reference is reclassified too
+        let path = index(Kind::Method);
+        let (incremental, stats) = ingest.update(&path).unwrap();
+        assert_eq!(stats.changed, 2);
+        assert_eq!(incremental.callees_of(&run), vec![new.as_str()]);
+        let graph = ScipIngestor::ingest_and_build_graph(&path).unwrap();
+        assert!(GraphDelta::between(&graph, &incremental).is_empty());
+    }
+}
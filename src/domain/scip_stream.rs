@@ -0,0 +1,378 @@
+//! Streaming SCIP Decoder
+//!
+//! Reads only what call-graph ingest needs straight from the bytes of a
+//! SCIP index (normally a memory map): each document's `relative_path`,
+//! each occurrence's `range`, `enclosing_range`, `symbol` and
+//! `symbol_roles`, and each symbol's `kind`. Strings borrow
+//! from the input and documents are split out one at a time, so the full
+//! protobuf object graph (symbol documentation, signatures, diagnostics,
+//! file text) is never built. Every other field is skipped by wire type.
+
+use anyhow::{bail, Context, Result};
+
+// Field numbers from scip.proto
+const INDEX_DOCUMENTS: u32 = 2;
+const DOCUMENT_RELATIVE_PATH: u32 = 1;
+const DOCUMENT_OCCURRENCES: u32 = 2;
+const DOCUMENT_SYMBOLS: u32 = 3;
+const OCCURRENCE_RANGE: u32 = 1;
+const OCCURRENCE_SYMBOL: u32 = 2;
+const OCCURRENCE_SYMBOL_ROLES: u32 = 3;
+const OCCURRENCE_ENCLOSING_RANGE: u32 = 7;
+const SYMBOL_INFORMATION_SYMBOL: u32 = 1;
+const SYMBOL_INFORMATION_KIND: u32 = 5;
+
+// Protobuf wire types
+const VARINT: u8 = 0;
+const FIXED64: u8 = 1;
+const LEN: u8 = 2;
+const FIXED32: u8 = 5;
+
+/// Encoded documents of a SCIP index, in order, each still undecoded.
+/// Yields the first error and then stops.
+pub struct Documents<'a> {
+    reader: Reader<'a>,
+}
+
+pub fn documents(index: &[u8]) -> Documents<'_> {
+    Documents { reader: Reader::new(index) }
+}
+
+impl<'a> Iterator for Documents<'a> {
+    type Item = Result<&'a [u8]>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        while !self.reader.is_empty() {
+            let field = self.reader.tag().and_then(|(field, wire)| match (field, wire) {
+                (INDEX_DOCUMENTS, LEN) => self.reader.bytes().map(Some),
+                _ => self.reader.skip(wire).map(|()| None),
+            });
+            match field {
+                Ok(Some(document)) => return Some(Ok(document)),
+                Ok(None) => {}
+                Err(e) => {
+                    self.reader.finish();
+                    return Some(Err(e));
+                }
+            }
+        }
+        None
+    }
+}
+
+/// `relative_path` of an encoded document, reading no further than needed.
+pub fn document_path(bytes: &[u8]) -> Result<&str> {
+    let mut reader = Reader::new(bytes);
+    while !reader.is_empty() {
+        match reader.tag()? {
+            (DOCUMENT_RELATIVE_PATH, LEN) => return reader.str(),
+            (_, wire) => reader.skip(wire)?,
+        }
+    }
+    Ok("")
+}
+
+/// `SymbolInformation`s of an encoded document, skipping its occurrences.
+pub fn document_symbols(bytes: &[u8]) -> Result<Vec<SymbolView<'_>>> {
+    let mut symbols = Vec::new();
+    let mut reader = Reader::new(bytes);
+    while !reader.is_empty() {
+        match reader.tag()? {
+            (DOCUMENT_SYMBOLS, LEN) => symbols.push(SymbolView::decode(reader.bytes()?)?),
+            (_, wire) => reader.skip(wire)?,
+        }
+    }
+    Ok(symbols)
+}
+
+/// The ingest-relevant fields of one document.
+#[derive(Debug, Clone, Default)]
+pub struct DocumentView<'a> {
+    pub relative_path: &'a str,
+    pub occurrences: Vec<OccurrenceView<'a>>,
+    /// Symbols defined in this document
+    pub symbols: Vec<SymbolView<'a>>,
+}
+
+impl<'a> DocumentView<'a> {
+    pub fn decode(bytes: &'a [u8]) -> Result<Self> {
+        let mut doc = Self::default();
+        let mut reader = Reader::new(bytes);
+        while !reader.is_empty() {
+            match reader.tag()? {
+                (DOCUMENT_RELATIVE_PATH, LEN) => doc.relative_path = reader.str()?,
+                (DOCUMENT_OCCURRENCES, LEN) => doc.occurrences.push(OccurrenceView::decode(reader.bytes()?)?),
+                (DOCUMENT_SYMBOLS, LEN) => doc.symbols.push(SymbolView::decode(reader.bytes()?)?),
+                (_, wire) => reader.skip(wire)?,
+            }
+        }
+        Ok(doc)
+    }
+}
+
+/// The ingest-relevant fields of one `SymbolInformation`.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct SymbolView<'a> {
+    pub symbol: &'a str,
+    /// `SymbolInformation.Kind` value, 0 when unspecified
+    pub kind: i32,
+}
+
+impl<'a> SymbolView<'a> {
+    fn decode(bytes: &'a [u8]) -> Result<Self> {
+        let mut info = Self::default();
+        let mut reader = Reader::new(bytes);
+        while !reader.is_empty() {
+            match reader.tag()? {
+                (SYMBOL_INFORMATION_SYMBOL, LEN) => info.symbol = reader.str()?,
+                (SYMBOL_INFORMATION_KIND, VARINT) => info.kind = reader.varint()? as i32,
+                (_, wire) => reader.skip(wire)?,
+            }
+        }
+        Ok(info)
+    }
+}
+
+/// The ingest-relevant fields of one occurrence.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct OccurrenceView<'a> {
+    pub symbol: &'a str,
+    pub symbol_roles: i32,
+    range: RangeBuf,
+    /// Span of the whole definition (e.g. a function body), when given
+    enclosing_range: RangeBuf,
+}
+
+impl<'a> OccurrenceView<'a> {
+    fn decode(bytes: &'a [u8]) -> Result<Self> {
+        let mut occ = Self::default();
+        let mut reader = Reader::new(bytes);
+        while !reader.is_empty() {
+            match reader.tag()? {
+                (OCCURRENCE_RANGE, wire) => occ.range.read(&mut reader, wire)?,
+                (OCCURRENCE_ENCLOSING_RANGE, wire) => occ.enclosing_range.read(&mut reader, wire)?,
+                (OCCURRENCE_SYMBOL, LEN) => occ.symbol = reader.str()?,
+                (OCCURRENCE_SYMBOL_ROLES, VARINT) => occ.symbol_roles = reader.varint()? as i32,
+                (_, wire) => reader.skip(wire)?,
+            }
+        }
+        Ok(occ)
+    }
+
+    /// `[start_line, start_col, end_col]` or `[start_line, start_col,
+    /// end_line, end_col]`; empty when the range was malformed.
+    pub fn range(&self) -> &[i32] {
+        self.range.as_slice()
+    }
+
+    /// Same layout as `range`; empty when absent.
+    pub fn enclosing_range(&self) -> &[i32] {
+        self.enclosing_range.as_slice()
+    }
+
+    pub fn is_definition(&self) -> bool {
+        self.symbol_roles & 1 != 0
+    }
+}
+
+/// A repeated `int32` range field, without allocating.
+#[derive(Debug, Clone, Copy, Default)]
+struct RangeBuf {
+    values: [i32; 4],
+    /// Values seen, which may exceed the four kept
+    len: usize,
+}
+
+impl RangeBuf {
+    /// Append one occurrence of the field, packed or not.
+    fn read(&mut self, reader: &mut Reader<'_>, wire: u8) -> Result<()> {
+        match wire {
+            LEN => {
+                let mut packed = Reader::new(reader.bytes()?);
+                while !packed.is_empty() {
+                    self.push(packed.varint()? as i32);
+                }
+            }
+            VARINT => self.push(reader.varint()? as i32),
+            _ => reader.skip(wire)?,
+        }
+        Ok(())
+    }
+
+    fn push(&mut self, value: i32) {
+        if let Some(slot) = self.values.get_mut(self.len) {
+            *slot = value;
+        }
+        self.len += 1;
+    }
+
+    fn as_slice(&self) -> &[i32] {
+        self.values.get(..self.len).unwrap_or(&[])
+    }
+}
+
+/// Cursor over protobuf wire data.
+struct Reader<'a> {
+    buf: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn new(buf: &'a [u8]) -> Self {
+        Self { buf, pos: 0 }
+    }
+
+    fn is_empty(&self) -> bool {
+        self.pos >= self.buf.len()
+    }
+
+    fn finish(&mut self) {
+        self.pos = self.buf.len();
+    }
+
+    fn varint(&mut self) -> Result<u64> {
+        let mut value = 0u64;
+        for shift in (0..64).step_by(7) {
+            let byte = match self.buf.get(self.pos) {
+                Some(&b) => b,
+                None => bail!("Truncated varint at byte {}", self.pos),
+            };
+            self.pos += 1;
+            value |= u64::from(byte & 0x7f) << shift;
+            if byte & 0x80 == 0 {
+                return Ok(value);
+            }
+        }
+        bail!("Varint longer than 10 bytes at byte {}", self.pos)
+    }
+
+    fn tag(&mut self) -> Result<(u32, u8)> {
+        let tag = self.varint()?;
+        let field = (tag >> 3) as u32;
+        if field == 0 {
+            bail!("Invalid field number 0 at byte {}", self.pos);
+        }
+        Ok((field, (tag & 7) as u8))
+    }
+
+    fn advance(&mut self, len: usize) -> Result<&'a [u8]> {
+        let end = self.pos.checked_add(len).filter(|&end| end <= self.buf.len());
+        let end = match end {
+            Some(end) => end,
+            None => bail!("Field of {} bytes runs past the end at byte {}", len, self.pos),
+        };
+        let bytes = &self.buf[self.pos..end];
+        self.pos = end;
+        Ok(bytes)
+    }
+
+    fn bytes(&mut self) -> Result<&'a [u8]> {
+        let len = self.varint()? as usize;
+        self.advance(len)
+    }
+
+    fn str(&mut self) -> Result<&'a str> {
+        let at = self.pos;
+        std::str::from_utf8(self.bytes()?).with_context(|| format!("Invalid UTF-8 string at byte {}", at))
+    }
+
+    fn skip(&mut self, wire: u8) -> Result<()> {
+        match wire {
+            VARINT => self.varint().map(drop),
+            FIXED64 => self.advance(8).map(drop),
+            LEN => self.bytes().map(drop),
+            FIXED32 => self.advance(4).map(drop),
+            _ => bail!("Unsupported wire type {} at byte {}", wire, self.pos),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use protobuf::Message;
+
+    fn occurrence(symbol: &str, range: Vec<i32>, roles: i32) -> scip::types::Occurrence {
+        let mut occ = scip::types::Occurrence::new();
+        occ.symbol = symbol.to_string();
+        occ.range = range;
+        occ.symbol_roles = roles;
+        occ.override_documentation = vec!["ignored".to_string()];
+        occ
+    }
+
+    #[test]
+    fn test_decodes_only_ingest_fields() {
+        let mut index = scip::types::Index::new();
+        for (path, symbol) in [("src/a.rs", "pkg::a"), ("src/b.rs", "pkg::b")] {
+            let mut doc = scip::types::Document::new();
+            doc.relative_path = path.to_string();
+            doc.text = "fn a() {}".to_string();
+            doc.occurrences.push(occurrence(symbol, vec![1, 0, 9, 1], 1));
+            doc.occurrences.push(occurrence("pkg::c", vec![3, 4, 10], 0));
+            let mut info = scip::types::SymbolInformation::new();
+            info.symbol = symbol.to_string();
+            info.documentation = vec!["docs we never read".to_string()];
+            doc.symbols.push(info);
+            index.documents.push(doc);
+        }
+        index.external_symbols.push(scip::types::SymbolInformation::new());
+        let bytes = index.write_to_bytes().unwrap();
+
+        let docs: Vec<DocumentView> = documents(&bytes)
+            .map(|d| DocumentView::decode(d.unwrap()).unwrap())
+            .collect();
+
+        assert_eq!(docs.len(), 2);
+        assert_eq!(docs[1].relative_path, "src/b.rs");
+        let occs = &docs[1].occurrences;
+        assert_eq!((occs[0].symbol, occs[0].range(), occs[0].is_definition()), ("pkg::b", &[1, 0, 9, 1][..], true));
+        assert_eq!((occs[1].symbol, occs[1].range(), occs[1].is_definition()), ("pkg::c", &[3, 4, 10][..], false));
+    }
+
+    #[test]
+    fn test_decodes_kinds_and_enclosing_ranges() {
+        let mut doc = scip::types::Document::new();
+        let mut occ = occurrence("pkg::f", vec![2, 3, 4], 1);
+        occ.enclosing_range = vec![1, 0, 9, 1];
+        doc.occurrences.push(occ);
+        let mut info = scip::types::SymbolInformation::new();
+        info.symbol = "pkg::f".to_string();
+        info.kind = protobuf::EnumOrUnknown::new(scip::types::symbol_information::Kind::Function);
+        doc.symbols.push(info);
+        let bytes = doc.write_to_bytes().unwrap();
+
+        let view = DocumentView::decode(&bytes).unwrap();
+        assert_eq!(view.occurrences[0].enclosing_range(), &[1, 0, 9, 1]);
+        assert_eq!((view.symbols[0].symbol, view.symbols[0].kind), ("pkg::f", 17));
+        let symbols = document_symbols(&bytes).unwrap();
+        assert_eq!((symbols.len(), symbols[0].symbol, symbols[0].kind), (1, "pkg::f", 17));
+    }
+
+    #[test]
+    fn test_overlong_range_is_empty() {
+        let mut doc = scip::types::Document::new();
+        doc.occurrences.push(occurrence("pkg::x", vec![1, 2, 3, 4, 5], 0));
+        let bytes = doc.write_to_bytes().unwrap();
+
+        let view = DocumentView::decode(&bytes).unwrap();
+        assert!(view.occurrences[0].range().is_empty());
+    }
+
+    #[test]
+    fn test_malformed_input_is_an_error() {
+        let mut doc = scip::types::Document::new();
+        doc.relative_path = "src/lib.rs".to_string();
+        let mut index = scip::types::Index::new();
+        index.documents.push(doc);
+        let bytes = index.write_to_bytes().unwrap();
+
+        // Cut inside the document's length-delimited payload
+        let truncated = &bytes[..bytes.len() - 3];
+        let results: Vec<Result<&[u8]>> = documents(truncated).collect();
+        assert_eq!(results.len(), 1);
+        assert!(results[0].is_err());
+
+        assert!(documents(b"this is not a valid protobuf").any(|d| d.is_err()));
+    }
+}
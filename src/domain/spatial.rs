@@ -0,0 +1,243 @@
+//! Spatial Index
+//!
+//! A static R-tree bulk-loaded with Sort-Tile-Recursive packing. Layouts are
+//! computed once per graph version, so the tree is built in one pass and
+//! never updated; queries return every entry whose box intersects a window.
+
+/// Axis-aligned rectangle in layout coordinates.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct Rect {
+    pub x0: f64,
+    pub y0: f64,
+    pub x1: f64,
+    pub y1: f64,
+}
+
+impl Rect {
+    pub fn new(x0: f64, y0: f64, x1: f64, y1: f64) -> Self {
+        Self {
+            x0: x0.min(x1),
+            y0: y0.min(y1),
+            x1: x0.max(x1),
+            y1: y0.max(y1),
+        }
+    }
+
+    /// Degenerate rectangle covering a single point.
+    pub fn point(x: f64, y: f64) -> Self {
+        Self { x0: x, y0: y, x1: x, y1: y }
+    }
+
+    /// Closed-interval overlap test (touching edges count).
+    pub fn intersects(&self, other: &Rect) -> bool {
+        self.x0 <= other.x1 && other.x0 <= self.x1 && self.y0 <= other.y1 && other.y0 <= self.y1
+    }
+
+    /// Half-open containment, so a point on a shared tile border belongs to
+    /// exactly one tile.
+    pub fn contains_point(&self, x: f64, y: f64) -> bool {
+        x >= self.x0 && x < self.x1 && y >= self.y0 && y < self.y1
+    }
+
+    pub fn union(&self, other: &Rect) -> Rect {
+        Rect {
+            x0: self.x0.min(other.x0),
+            y0: self.y0.min(other.y0),
+            x1: self.x1.max(other.x1),
+            y1: self.y1.max(other.y1),
+        }
+    }
+
+    fn center(&self) -> (f64, f64) {
+        ((self.x0 + self.x1) * 0.5, (self.y0 + self.y1) * 0.5)
+    }
+}
+
+/// Maximum children per tree node.
+const NODE_CAPACITY: usize = 16;
+
+#[derive(Debug, Clone)]
+struct TreeNode {
+    bounds: Rect,
+    /// Range into `entries` (leaf) or `nodes` (internal)
+    first: u32,
+    len: u32,
+    leaf: bool,
+}
+
+/// Immutable R-tree mapping rectangles to `u32` payloads.
+#[derive(Debug, Clone, Default)]
+pub struct RTree {
+    entries: Vec<(Rect, u32)>,
+    nodes: Vec<TreeNode>,
+    root: Option<u32>,
+}
+
+impl RTree {
+    /// Build the tree from all entries at once (STR packing).
+    pub fn bulk_load(mut entries: Vec<(Rect, u32)>) -> Self {
+        if entries.is_empty() {
+            return Self::default();
+        }
+
+        str_sort(&mut entries, |e| e.0.center());
+
+        let mut nodes: Vec<TreeNode> = entries
+            .chunks(NODE_CAPACITY)
+            .enumerate()
+            .map(|(i, chunk)| TreeNode {
+                bounds: bounds_of(chunk.iter().map(|e| &e.0)),
+                first: (i * NODE_CAPACITY) as u32,
+                len: chunk.len() as u32,
+                leaf: true,
+            })
+            .collect();
+
+        // Pack each level into parents until a single root remains
+        let mut level_start = 0usize;
+        let mut level_len = nodes.len();
+        while level_len > 1 {
+            let mut level: Vec<TreeNode> = nodes[level_start..level_start + level_len].to_vec();
+            str_sort(&mut level, |n| n.bounds.center());
+            nodes.truncate(level_start);
+            nodes.extend(level);
+
+            let parents: Vec<TreeNode> = nodes[level_start..]
+                .chunks(NODE_CAPACITY)
+                .enumerate()
+                .map(|(i, chunk)| TreeNode {
+                    bounds: bounds_of(chunk.iter().map(|n| &n.bounds)),
+                    first: (level_start + i * NODE_CAPACITY) as u32,
+                    len: chunk.len() as u32,
+                    leaf: false,
+                })
+                .collect();
+
+            level_start = nodes.len();
+            level_len = parents.len();
+            nodes.extend(parents);
+        }
+
+        let root = Some((nodes.len() - 1) as u32);
+        Self { entries, nodes, root }
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Bounding box of everything in the tree.
+    pub fn bounds(&self) -> Option<Rect> {
+        self.root.map(|r| self.nodes[r as usize].bounds)
+    }
+
+    /// Append the payload of every entry intersecting `window` to `out`.
+    pub fn query(&self, window: &Rect, out: &mut Vec<u32>) {
+        let root = match self.root {
+            Some(r) => r,
+            None => return,
+        };
+
+        let mut stack = vec![root];
+        while let Some(idx) = stack.pop() {
+            let node = &self.nodes[idx as usize];
+            if !node.bounds.intersects(window) {
+                continue;
+            }
+            let range = node.first as usize..(node.first + node.len) as usize;
+            if node.leaf {
+                out.extend(
+                    self.entries[range]
+                        .iter()
+                        .filter(|(rect, _)| rect.intersects(window))
+                        .map(|(_, payload)| *payload),
+                );
+            } else {
+                stack.extend(range.map(|i| i as u32));
+            }
+        }
+    }
+}
+
+fn bounds_of<'a>(mut rects: impl Iterator<Item = &'a Rect>) -> Rect {
+    let first = *rects.next().expect("bounds of empty slice");
+    rects.fold(first, |acc, r| acc.union(r))
+}
+
+/// Sort-Tile-Recursive ordering: split into vertical slabs by x, then sort
+/// each slab by y, so consecutive runs of `NODE_CAPACITY` items are compact.
+fn str_sort<T>(items: &mut [T], center: impl Fn(&T) -> (f64, f64)) {
+    let leaf_count = (items.len() + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    let slabs = (leaf_count as f64).sqrt().ceil().max(1.0) as usize;
+    let slab_size = slabs * NODE_CAPACITY;
+
+    items.sort_by(|a, b| center(a).0.total_cmp(&center(b).0));
+    for slab in items.chunks_mut(slab_size) {
+        slab.sort_by(|a, b| center(a).1.total_cmp(&center(b).1));
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn brute_force(entries: &[(Rect, u32)], window: &Rect) -> Vec<u32> {
+        let mut hits: Vec<u32> = entries
+            .iter()
+            .filter(|(r, _)| r.intersects(window))
+            .map(|(_, p)| *p)
+            .collect();
+        hits.sort();
+        hits
+    }
+
+    #[test]
+    fn test_empty_tree() {
+        let tree = RTree::bulk_load(Vec::new());
+        let mut out = Vec::new();
+        tree.query(&Rect::new(0.0, 0.0, 10.0, 10.0), &mut out);
+        assert!(out.is_empty());
+        assert!(tree.bounds().is_none());
+    }
+
+    #[test]
+    fn test_query_matches_brute_force() {
+        // 40x40 grid of points plus some wide boxes, enough for three levels
+        let mut entries = Vec::new();
+        for i in 0..1600u32 {
+            let x = (i % 40) as f64 * 10.0;
+            let y = (i / 40) as f64 * 10.0;
+            entries.push((Rect::point(x, y), i));
+        }
+        entries.push((Rect::new(-5.0, 15.0, 500.0, 16.0), 5000));
+        entries.push((Rect::new(95.0, -10.0, 96.0, 420.0), 5001));
+
+        let tree = RTree::bulk_load(entries.clone());
+        assert_eq!(tree.len(), entries.len());
+
+        for window in [
+            Rect::new(0.0, 0.0, 35.0, 35.0),
+            Rect::new(100.0, 100.0, 100.0, 100.0),
+            Rect::new(-50.0, -50.0, -1.0, -1.0),
+            Rect::new(50.0, 10.0, 300.0, 20.0),
+            Rect::new(-1000.0, -1000.0, 1000.0, 1000.0),
+        ] {
+            let mut out = Vec::new();
+            tree.query(&window, &mut out);
+            out.sort();
+            assert_eq!(out, brute_force(&entries, &window), "window {:?}", window);
+        }
+    }
+
+    #[test]
+    fn test_contains_point_is_half_open() {
+        let tile = Rect::new(0.0, 0.0, 100.0, 100.0);
+        assert!(tile.contains_point(0.0, 0.0));
+        assert!(!tile.contains_point(100.0, 50.0));
+        assert!(!tile.contains_point(50.0, 100.0));
+    }
+}
@@ -1,4 +1,5 @@
 use crate::domain::index::FunctionSignature;
+use crate::domain::symbol::Symbol;
 use dashmap::DashMap;
 use sled::Db;
 
@@ -17,10 +18,12 @@ pub trait SymbolStore: Send + Sync {
 // MemorySymbolStore - Fast in-memory storage using DashMap
 // ============================================================================
 
+/// Keys are interned, so probing for a name that was never indexed costs
+/// no allocation and stays out of the maps.
 pub struct MemorySymbolStore {
-    pub global_functions: DashMap<String, FunctionSignature>,
-    pub type_methods: DashMap<(String, String), FunctionSignature>,
-    pub method_lookup: DashMap<String, Vec<String>>, // method_name -> Vec<type_name>
+    pub global_functions: DashMap<Symbol, FunctionSignature>,
+    pub type_methods: DashMap<(Symbol, Symbol), FunctionSignature>,
+    pub method_lookup: DashMap<Symbol, Vec<Symbol>>, // method_name -> Vec<type_name>
 }
 
 impl Default for MemorySymbolStore {
@@ -35,26 +38,32 @@ impl Default for MemorySymbolStore {
 
 impl SymbolStore for MemorySymbolStore {
     fn insert_function(&self, key: String, sig: FunctionSignature) {
-        self.global_functions.insert(key, sig);
+        self.global_functions.insert(Symbol::intern(&key), sig);
     }
 
     fn insert_method(&self, type_name: String, method_name: String, sig: FunctionSignature) {
-        self.type_methods.insert((type_name, method_name), sig);
+        self.type_methods.insert((Symbol::intern(&type_name), Symbol::intern(&method_name)), sig);
     }
 
     fn get_function(&self, key: &str) -> Option<FunctionSignature> {
-        self.global_functions.get(key).map(|r| r.clone())
+        let key = Symbol::lookup(key)?;
+        self.global_functions.get(&key).map(|r| r.clone())
     }
 
     fn get_method(&self, type_name: &str, method_name: &str) -> Option<FunctionSignature> {
-        self.type_methods.get(&(type_name.to_string(), method_name.to_string())).map(|r| r.clone())
+        let key = (Symbol::lookup(type_name)?, Symbol::lookup(method_name)?);
+        self.type_methods.get(&key).map(|r| r.clone())
     }
 
     fn find_methods_by_name(&self, method_name: &str) -> Vec<FunctionSignature> {
-        if let Some(type_names) = self.method_lookup.get(method_name) {
+        let method = match Symbol::lookup(method_name) {
+            Some(method) => method,
+            None => return Vec::new(),
+        };
+        if let Some(type_names) = self.method_lookup.get(&method) {
             type_names
                 .iter()
-                .filter_map(|tn| self.get_method(tn, method_name))
+                .filter_map(|&tn| self.type_methods.get(&(tn, method)).map(|r| r.clone()))
                 .collect()
         } else {
             Vec::new()
@@ -62,7 +71,7 @@ impl SymbolStore for MemorySymbolStore {
     }
 
     fn register_method_lookup(&self, method_name: String, type_name: String) {
-        self.method_lookup.entry(method_name).or_default().push(type_name);
+        self.method_lookup.entry(Symbol::intern(&method_name)).or_default().push(Symbol::intern(&type_name));
     }
 }
 
@@ -173,11 +182,11 @@ mod tests {
 
     fn sample_sig(name: &str) -> FunctionSignature {
         FunctionSignature {
-            name: name.to_string(),
+            name: Symbol::intern(name),
             is_public: true,
             receiver: Some("&self".to_string()),
             location: "test.rs:1".to_string(),
-            crate_name: "test_crate".to_string(),
+            crate_name: Symbol::intern("test_crate"),
         }
     }
 
@@ -0,0 +1,244 @@
+//! Symbol Interner
+//!
+//! Every analysis stage names functions by long strings (SCIP symbols such
+//! as `rust-analyzer cargo crate 0.1.0 path/Type#method().`, or syn ids like
+//! `Type::method@crate`). The same string used to be cloned into node ids,
+//! every callee list and every map key. Interning stores each distinct
+//! string once in a process-wide table and hands out 4-byte `Symbol`
+//! handles that compare and hash as integers; strings are resolved only
+//! when output is written.
+//!
+//! The table is append-only: interned strings live until process exit, so
+//! only names go in (symbols, labels, file paths), never values that change
+//! with each edit. Definition sites, for one, are a file `Symbol` plus a
+//! plain line number. A watching daemon then grows only with the distinct
+//! names and files it has seen, not with the edits made to them.
+
+use dashmap::DashMap;
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
+use std::fmt;
+use std::sync::{OnceLock, RwLock};
+
+/// Bytes per arena chunk. Longer strings get a chunk of their own.
+const ARENA_CHUNK_BYTES: usize = 64 * 1024;
+
+/// Handle to an interned string.
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+pub struct Symbol(u32);
+
+impl Symbol {
+    /// Intern `s` in the global table.
+    pub fn intern(s: &str) -> Symbol {
+        Interner::global().intern(s)
+    }
+
+    /// The symbol for `s` if it was ever interned, without inserting it.
+    /// Lookups use this so that probing for unknown names does not grow the
+    /// table.
+    pub fn lookup(s: &str) -> Option<Symbol> {
+        Interner::global().get(s)
+    }
+
+    pub fn as_str(self) -> &'static str {
+        Interner::global().resolve(self)
+    }
+
+    pub fn index(self) -> u32 {
+        self.0
+    }
+}
+
+impl From<&str> for Symbol {
+    fn from(s: &str) -> Self {
+        Symbol::intern(s)
+    }
+}
+
+impl From<&String> for Symbol {
+    fn from(s: &String) -> Self {
+        Symbol::intern(s)
+    }
+}
+
+impl PartialEq<str> for Symbol {
+    fn eq(&self, other: &str) -> bool {
+        self.as_str() == other
+    }
+}
+
+impl PartialEq<&str> for Symbol {
+    fn eq(&self, other: &&str) -> bool {
+        self.as_str() == *other
+    }
+}
+
+impl fmt::Display for Symbol {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(self.as_str())
+    }
+}
+
+impl fmt::Debug for Symbol {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(self.as_str(), f)
+    }
+}
+
+/// Serialized as the string itself: handles are only meaningful inside
+/// one process, so persisted stores must not see the raw index.
+impl Serialize for Symbol {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_str(self.as_str())
+    }
+}
+
+impl<'de> Deserialize<'de> for Symbol {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        let s = String::deserialize(deserializer)?;
+        Ok(Symbol::intern(&s))
+    }
+}
+
+/// Concurrent string table behind `Symbol`.
+///
+/// Lookups of already-interned strings go through the sharded map only;
+/// inserts serialize on the arena lock.
+pub struct Interner {
+    map: DashMap<&'static str, Symbol>,
+    arena: RwLock<Arena>,
+}
+
+#[derive(Default)]
+struct Arena {
+    /// Fixed-capacity buffers; never grown past capacity, so slices handed
+    /// out stay valid.
+    chunks: Vec<String>,
+    strings: Vec<&'static str>,
+}
+
+impl Arena {
+    fn alloc(&mut self, s: &str) -> &'static str {
+        let fits = self
+            .chunks
+            .last()
+            .map_or(false, |c| c.capacity() - c.len() >= s.len());
+        if !fits {
+            self.chunks.push(String::with_capacity(ARENA_CHUNK_BYTES.max(s.len())));
+        }
+        let chunk = self.chunks.last_mut().unwrap();
+        let start = chunk.len();
+        chunk.push_str(s);
+        // SAFETY: the chunk never reallocates (we checked capacity) and is
+        // never dropped or truncated while the interner lives; the global
+        // interner lives for the whole process.
+        unsafe { &*(&chunk[start..] as *const str) }
+    }
+}
+
+static GLOBAL: OnceLock<Interner> = OnceLock::new();
+
+impl Interner {
+    /// The process-wide interner shared by every analysis stage.
+    pub fn global() -> &'static Interner {
+        GLOBAL.get_or_init(Interner::new)
+    }
+
+    fn new() -> Self {
+        Self {
+            map: DashMap::new(),
+            arena: RwLock::new(Arena::default()),
+        }
+    }
+
+    pub fn intern(&self, s: &str) -> Symbol {
+        if let Some(sym) = self.map.get(s) {
+            return *sym;
+        }
+
+        let mut arena = self.arena.write().unwrap();
+        // Another thread may have won the race while we waited
+        if let Some(sym) = self.map.get(s) {
+            return *sym;
+        }
+        let stored = arena.alloc(s);
+        let sym = Symbol(arena.strings.len() as u32);
+        arena.strings.push(stored);
+        self.map.insert(stored, sym);
+        sym
+    }
+
+    pub fn get(&self, s: &str) -> Option<Symbol> {
+        self.map.get(s).map(|sym| *sym)
+    }
+
+    pub fn resolve(&self, sym: Symbol) -> &'static str {
+        self.arena.read().unwrap().strings[sym.0 as usize]
+    }
+
+    /// Number of distinct strings interned so far.
+    pub fn len(&self) -> usize {
+        self.arena.read().unwrap().strings.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_intern_is_idempotent() {
+        let a = Symbol::intern("rust-analyzer cargo demo 0.1.0 lib/Foo#bar().");
+        let b = Symbol::intern(&String::from("rust-analyzer cargo demo 0.1.0 lib/Foo#bar()."));
+        assert_eq!(a, b);
+        assert_eq!(a.as_str(), "rust-analyzer cargo demo 0.1.0 lib/Foo#bar().");
+        assert_ne!(a, Symbol::intern("rust-analyzer cargo demo 0.1.0 lib/Foo#baz()."));
+    }
+
+    #[test]
+    fn test_lookup_does_not_insert() {
+        assert!(Symbol::lookup("symbol::test::probe").is_none());
+        assert!(Symbol::lookup("symbol::test::probe").is_none());
+        let sym = Symbol::intern("symbol::test::probe");
+        assert_eq!(Symbol::lookup("symbol::test::probe"), Some(sym));
+    }
+
+    #[test]
+    fn test_long_strings_get_their_own_chunk() {
+        let long = "x".repeat(ARENA_CHUNK_BYTES * 2);
+        let sym = Symbol::intern(&long);
+        let short = Symbol::intern("symbol::test::after_long");
+        assert_eq!(sym.as_str().len(), long.len());
+        assert_eq!(short.as_str(), "symbol::test::after_long");
+    }
+
+    #[test]
+    fn test_concurrent_interning_agrees() {
+        let handles: Vec<_> = (0..4)
+            .map(|_| {
+                std::thread::spawn(|| {
+                    (0..200)
+                        .map(|i| Symbol::intern(&format!("symbol::test::concurrent{}", i)))
+                        .collect::<Vec<_>>()
+                })
+            })
+            .collect();
+        let results: Vec<Vec<Symbol>> = handles.into_iter().map(|h| h.join().unwrap()).collect();
+        for other in &results[1..] {
+            assert_eq!(&results[0], other);
+        }
+        assert_eq!(results[0][7], "symbol::test::concurrent7");
+    }
+
+    #[test]
+    fn test_serializes_as_string() {
+        let sym = Symbol::intern("pkg::main");
+        let json = serde_json::to_string(&sym).unwrap();
+        assert_eq!(json, "\"pkg::main\"");
+        let back: Symbol = serde_json::from_str(&json).unwrap();
+        assert_eq!(back, sym);
+    }
+}
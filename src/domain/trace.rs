@@ -1,6 +1,16 @@
-use crate::domain::callgraph::CallGraph;
+use crate::domain::callgraph::{CallGraph, NodeIdx};
 use crate::infrastructure::source_manager::SourceManager;
+use rayon::prelude::*;
 use std::collections::HashSet;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// Default cap on path length (steps below the root).
+pub const DEFAULT_TRACE_DEPTH: usize = 30;
+/// Default cap on the number of paths returned.
+pub const DEFAULT_MAX_PATHS: usize = 50;
+
+/// Parent pointer of a trie root.
+const NO_PARENT: u32 = u32::MAX;
 
 #[derive(Debug, Clone)]
 pub struct TraceStep {
@@ -16,115 +26,420 @@ pub struct TracePath {
     pub steps: Vec<TraceStep>,
 }
 
+/// Bounds for path enumeration.
+#[derive(Debug, Clone, Copy)]
+pub struct TraceLimits {
+    pub max_depth: usize,
+    pub max_paths: usize,
+}
+
+impl Default for TraceLimits {
+    fn default() -> Self {
+        Self {
+            max_depth: DEFAULT_TRACE_DEPTH,
+            max_paths: DEFAULT_MAX_PATHS,
+        }
+    }
+}
+
+/// First node that looks like a program entry (`main@crate` or `crate::main`).
+pub fn find_main(graph: &CallGraph) -> Option<NodeIdx> {
+    graph.nodes().find(|&n| {
+        let id = graph.id(n);
+        id.starts_with("main@") || id.contains("::main")
+    })
+}
+
+/// One step in the path trie: a graph vertex plus a pointer to the step
+/// before it. Paths sharing a prefix share its entries.
+#[derive(Debug, Clone, Copy)]
+struct TrieEntry {
+    vertex: NodeIdx,
+    parent: u32,
+    depth: u32,
+    cycle: bool,
+}
+
+/// Enumerated paths, stored as a parent-pointer trie of node indices.
+///
+/// Nothing is resolved to strings during enumeration; `iter()` walks the
+/// paths lazily and snippets are read only when a step asks for one.
+pub struct TraceSet<'a> {
+    graph: &'a CallGraph,
+    source_manager: &'a SourceManager,
+    trie: Vec<TrieEntry>,
+    /// Trie entry of each path's last step, in output order
+    leaves: Vec<u32>,
+}
+
+impl<'a> TraceSet<'a> {
+    pub fn len(&self) -> usize {
+        self.leaves.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.leaves.is_empty()
+    }
+
+    /// Number of trie entries backing all paths (shared prefixes counted once).
+    pub fn trie_len(&self) -> usize {
+        self.trie.len()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = PathView<'_, 'a>> + '_ {
+        self.leaves.iter().map(move |&leaf| PathView { set: self, leaf })
+    }
+
+    /// Materialize every path, snippets included.
+    pub fn to_paths(&self) -> Vec<TracePath> {
+        self.iter().map(|path| path.to_trace_path()).collect()
+    }
+}
+
+/// A path in a `TraceSet`, resolved on demand.
+#[derive(Clone, Copy)]
+pub struct PathView<'s, 'a> {
+    set: &'s TraceSet<'a>,
+    leaf: u32,
+}
+
+impl<'s, 'a> PathView<'s, 'a> {
+    /// Steps from the root, following parent pointers back from the leaf.
+    pub fn steps(&self) -> Vec<StepView<'s, 'a>> {
+        let mut steps = Vec::new();
+        let mut entry = self.leaf;
+        while entry != NO_PARENT {
+            let e = self.set.trie[entry as usize];
+            steps.push(StepView { set: self.set, entry: e });
+            entry = e.parent;
+        }
+        steps.reverse();
+        steps
+    }
+
+    pub fn to_trace_path(&self) -> TracePath {
+        TracePath {
+            steps: self.steps().iter().map(|s| s.to_trace_step()).collect(),
+        }
+    }
+}
+
+/// One step of a `PathView`.
+#[derive(Clone, Copy)]
+pub struct StepView<'s, 'a> {
+    set: &'s TraceSet<'a>,
+    entry: TrieEntry,
+}
+
+impl<'s, 'a> StepView<'s, 'a> {
+    pub fn id(&self) -> &'static str {
+        self.set.graph.id(self.entry.vertex)
+    }
+
+    pub fn depth(&self) -> usize {
+        self.entry.depth as usize
+    }
+
+    /// "file:line" of the definition, falling back to the node label.
+    pub fn location(&self) -> Option<String> {
+        let graph = self.set.graph;
+        graph.location(self.entry.vertex)
+            .map(|l| l.to_string())
+            .or_else(|| graph.label(self.entry.vertex).map(str::to_string))
+    }
+
+    pub fn note(&self) -> Option<&'static str> {
+        if self.entry.cycle { Some("[Cycle Detected]") } else { None }
+    }
+
+    /// Source line at `location()`, read from the source manager now.
+    pub fn snippet(&self) -> Option<String> {
+        let site = self.set.graph.location(self.entry.vertex)?;
+        self.set.source_manager.get_snippet(site.file(), site.line as usize)
+    }
+
+    pub fn to_trace_step(&self) -> TraceStep {
+        TraceStep {
+            id: self.id().to_string(),
+            location: self.location(),
+            depth: self.depth(),
+            snippet: self.snippet(),
+            note: self.note().map(str::to_string),
+        }
+    }
+}
+
 pub struct TraceGenerator<'a> {
     graph: &'a CallGraph,
     source_manager: &'a SourceManager,
-    max_depth: usize,
-    max_paths: usize,
+    limits: TraceLimits,
+}
+
+/// Per-branch enumeration state.
+struct Branch {
+    trie: Vec<TrieEntry>,
+    leaves: Vec<u32>,
+    on_path: HashSet<NodeIdx>,
 }
 
 impl<'a> TraceGenerator<'a> {
     pub fn new(graph: &'a CallGraph, source_manager: &'a SourceManager) -> Self {
+        Self::with_limits(graph, source_manager, TraceLimits::default())
+    }
+
+    pub fn with_limits(graph: &'a CallGraph, source_manager: &'a SourceManager, limits: TraceLimits) -> Self {
         Self {
             graph,
             source_manager,
-            max_depth: 30, // Hardcap depth
-            max_paths: 50, // Hardcap paths
+            limits,
         }
     }
 
+    /// Materialized form of `enumerate`.
     pub fn generate_paths(&self, start_node_id: &str) -> Vec<TracePath> {
-        let mut results = Vec::new();
-        let mut current_path = Vec::new();
-        let mut visited = HashSet::new();
-
-        self.dfs(
-            start_node_id,
-            0,
-            &mut current_path,
-            &mut visited,
-            &mut results,
-        );
-
-        results
-    }
-
-    fn dfs(
-        &self,
-        current_id: &str,
-        depth: usize,
-        path_stack: &mut Vec<TraceStep>,
-        visited: &mut HashSet<String>,
-        results: &mut Vec<TracePath>,
-    ) {
-        if results.len() >= self.max_paths {
+        self.enumerate(start_node_id).to_paths()
+    }
+
+    /// Enumerate call paths from `start_node_id` to leaves, cycles or the
+    /// depth limit. An unknown start yields no paths.
+    ///
+    /// The root's callees are explored in parallel, each branch by a
+    /// sequential DFS; branches draw from one shared budget of
+    /// `max_paths`. Results are ordered by branch, so output is stable
+    /// whenever the budget is not exhausted.
+    ///
+    /// Each branch appends to its own trie and truncates entries that
+    /// ended up on no recorded path, so memory follows the distinct
+    /// prefixes of the returned paths rather than paths x depth.
+    pub fn enumerate(&self, start_node_id: &str) -> TraceSet<'a> {
+        let mut set = TraceSet {
+            graph: self.graph,
+            source_manager: self.source_manager,
+            trie: Vec::new(),
+            leaves: Vec::new(),
+        };
+
+        let start = match self.graph.idx_of(start_node_id) {
+            Some(idx) => idx,
+            None => return set,
+        };
+        if self.limits.max_depth == 0 || self.limits.max_paths == 0 {
+            return set;
+        }
+
+        let budget = AtomicUsize::new(0);
+        let root = TrieEntry { vertex: start, parent: NO_PARENT, depth: 0, cycle: false };
+
+        let callees = self.graph.callees(start);
+        if callees.is_empty() {
+            set.trie.push(root);
+            set.leaves.push(0);
+            return set;
+        }
+
+        let branches: Vec<Branch> = callees
+            .par_iter()
+            .map(|&callee| {
+                let mut branch = Branch {
+                    trie: vec![root],
+                    leaves: Vec::new(),
+                    on_path: HashSet::new(),
+                };
+                branch.on_path.insert(start);
+                self.dfs(callee, 0, 1, &mut branch, &budget);
+                branch
+            })
+            .collect();
+
+        // Concatenate branch tries, rebasing their parent pointers
+        for branch in branches {
+            if branch.leaves.is_empty() {
+                continue;
+            }
+            let base = set.trie.len() as u32;
+            set.trie.extend(branch.trie.into_iter().map(|mut e| {
+                if e.parent != NO_PARENT {
+                    e.parent += base;
+                }
+                e
+            }));
+            set.leaves.extend(branch.leaves.into_iter().map(|leaf| leaf + base));
+        }
+        set
+    }
+
+    fn exhausted(&self, budget: &AtomicUsize) -> bool {
+        budget.load(Ordering::Relaxed) >= self.limits.max_paths
+    }
+
+    /// Claim a slot from the shared budget and record `leaf` if granted.
+    fn record(&self, leaf: u32, branch: &mut Branch, budget: &AtomicUsize) {
+        if budget.fetch_add(1, Ordering::Relaxed) < self.limits.max_paths {
+            branch.leaves.push(leaf);
+        }
+    }
+
+    fn dfs(&self, current: NodeIdx, parent: u32, depth: usize, branch: &mut Branch, budget: &AtomicUsize) {
+        if self.exhausted(budget) {
             return;
         }
 
-        if depth >= self.max_depth {
-            // Reached max depth, save current path and stop
-            results.push(TracePath { steps: path_stack.clone() });
+        if depth >= self.limits.max_depth {
+            // Reached max depth: the path ends at the parent
+            self.record(parent, branch, budget);
             return;
         }
 
-        // Find node in graph
-        let node_opt = self.graph.nodes.iter().find(|n| n.id == current_id);
-        
-        // Prepare trace step
-        let location = node_opt.and_then(|n| n.label.clone());
-        let snippet = location.as_ref().and_then(|loc| {
-             // Location format "file:line"
-             let parts: Vec<&str> = loc.split(':').collect();
-             if parts.len() >= 2 {
-                 let file = parts[0];
-                 let line = parts[1].parse::<usize>().ok()?;
-                 self.source_manager.get_snippet(file, line)
-             } else {
-                 None
-             }
-        });
-
-        let step = TraceStep {
-            id: current_id.to_string(),
-            location,
-            depth,
-            snippet,
-            note: if visited.contains(current_id) { Some("[Cycle Detected]".to_string()) } else { None },
-        };
+        // `on_path` holds the ancestors of this step: revisiting one is a
+        // cycle, while reaching a node again via another branch is not.
+        let cycle = branch.on_path.contains(&current);
+        let mark = branch.trie.len();
+        let recorded = branch.leaves.len();
+        branch.trie.push(TrieEntry { vertex: current, parent, depth: depth as u32, cycle });
+        let entry = mark as u32;
 
-        path_stack.push(step);
-        
-        // Cycle check: If current node is already in the recursion stack (represented here by `path_stack` IDs? No, usually separate set)
-        // Actually for DFS path enumeration, `visited` usually tracks nodes in the *current path* to detect cycles.
-        // If we want to allow visiting same node via different branches, we strictly check if it's in ancestors.
-        if visited.contains(current_id) {
-             // Cycle detected. Commit path and back off.
-             results.push(TracePath { steps: path_stack.clone() });
-             path_stack.pop();
-             return;
-        }
-        
-        visited.insert(current_id.to_string());
-
-        // Recurse
-        if let Some(node) = node_opt {
-            if node.callees.is_empty() {
-                // Leaf node
-                results.push(TracePath { steps: path_stack.clone() });
+        if cycle {
+            // Cycle detected. Commit path and back off.
+            self.record(entry, branch, budget);
+        } else {
+            branch.on_path.insert(current);
+
+            // Recurse (external callees have no outgoing edges)
+            let callees = self.graph.callees(current);
+            if callees.is_empty() {
+                // Leaf node, or external/phantom node
+                self.record(entry, branch, budget);
             } else {
-                for callee in &node.callees {
-                    self.dfs(callee, depth + 1, path_stack, visited, results);
-                    if results.len() >= self.max_paths {
+                for &callee in callees {
+                    self.dfs(callee, entry, depth + 1, branch, budget);
+                    if self.exhausted(budget) {
                         break;
                     }
                 }
             }
-        } else {
-            // Node not found in graph (external or phantom?)
-            results.push(TracePath { steps: path_stack.clone() });
+
+            branch.on_path.remove(&current);
         }
 
-        visited.remove(current_id);
-        path_stack.pop();
+        // Nothing below this step made it into the results: drop the subtree
+        if branch.leaves.len() == recorded {
+            branch.trie.truncate(mark);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    fn ids(path: &TracePath) -> Vec<&str> {
+        path.steps.iter().map(|s| s.id.as_str()).collect()
+    }
+
+    /// A binary fan-out 10 levels deep: 1024 leaf paths
+    fn binary_tree() -> CallGraph {
+        let mut nodes = Vec::new();
+        for level in 0..10 {
+            for i in 0..(1 << level) {
+                let l = format!("n{}_{}", level + 1, 2 * i);
+                let r = format!("n{}_{}", level + 1, 2 * i + 1);
+                nodes.push(node(&format!("n{}_{}", level, i), &[&l, &r]));
+            }
+        }
+        CallGraph::new(nodes)
+    }
+
+    #[test]
+    fn test_paths_follow_branches_in_order() {
+        let graph = CallGraph::new(vec![
+            node("main", &["a", "b"]),
+            node("a", &["c", "main"]),
+            node("b", &[]),
+            node("c", &[]),
+        ]);
+        let sm = SourceManager::new(&[]);
+        let paths = TraceGenerator::new(&graph, &sm).generate_paths("main");
+
+        assert_eq!(paths.len(), 3);
+        assert_eq!(ids(&paths[0]), vec!["main", "a", "c"]);
+        assert_eq!(ids(&paths[1]), vec!["main", "a", "main"]);
+        assert_eq!(paths[1].steps[2].note.as_deref(), Some("[Cycle Detected]"));
+        assert_eq!(ids(&paths[2]), vec!["main", "b"]);
+    }
+
+    #[test]
+    fn test_limits_bound_depth_and_count() {
+        let graph = binary_tree();
+        let sm = SourceManager::new(&[]);
+
+        let limits = TraceLimits { max_depth: 30, max_paths: 7 };
+        let paths = TraceGenerator::with_limits(&graph, &sm, limits).generate_paths("n0_0");
+        assert_eq!(paths.len(), 7);
+
+        let limits = TraceLimits { max_depth: 3, max_paths: 1000 };
+        let paths = TraceGenerator::with_limits(&graph, &sm, limits).generate_paths("n0_0");
+        assert_eq!(paths.len(), 8);
+        assert!(paths.iter().all(|p| p.steps.len() == 3));
+    }
+
+    #[test]
+    fn test_trie_shares_prefixes() {
+        let graph = binary_tree();
+        let sm = SourceManager::new(&[]);
+        let limits = TraceLimits { max_depth: 30, max_paths: 1024 };
+        let set = TraceGenerator::with_limits(&graph, &sm, limits).enumerate("n0_0");
+
+        // 1024 paths of 11 steps, but only 2047 distinct steps (+1 root copy
+        // for the second branch)
+        assert_eq!(set.len(), 1024);
+        assert_eq!(set.trie_len(), 2048);
+        let last = set.iter().last().unwrap().steps();
+        assert_eq!(last.len(), 11);
+        assert_eq!(last[10].id(), "n10_1023");
+        assert_eq!(last[10].depth(), 10);
+    }
+
+    #[test]
+    fn test_snippets_resolve_from_location() {
+        use crate::ports::CallGraphBuilder;
+
+        let files = vec![(
+            "app".to_string(),
+            "src/main.rs".to_string(),
+            "fn main() {\n    helper();\n}\nfn helper() {}\n".to_string(),
+        )];
+        let graph = crate::infrastructure::SimpleCallGraphBuilder::new().build_call_graph(&files);
+        let sm = SourceManager::new(&files);
+        let set = TraceGenerator::new(&graph, &sm).enumerate("app::main");
+
+        let path = set.iter().next().unwrap();
+        let steps = path.steps();
+        assert_eq!(steps[0].location().as_deref(), Some("src/main.rs:1"));
+        assert_eq!(steps[0].snippet().as_deref(), Some("fn main() {"));
+    }
+
+    #[test]
+    fn test_unknown_start_yields_nothing() {
+        let graph = CallGraph::new(vec![node("main", &[])]);
+        let sm = SourceManager::new(&[]);
+        assert!(TraceGenerator::new(&graph, &sm).enumerate("nowhere").is_empty());
+    }
+
+    #[test]
+    fn test_find_main_needs_crate_qualified_id() {
+        let bare = CallGraph::new(vec![node("main", &[])]);
+        assert!(find_main(&bare).is_none());
+
+        let graph = CallGraph::new(vec![node("app::helper", &[]), node("app::main", &[])]);
+        assert_eq!(find_main(&graph), graph.idx_of("app::main"));
     }
 }
@@ -0,0 +1,225 @@
+//! Unreachable Functions
+//!
+//! Reports the defined functions that no entry point (main, tests, async
+//! main, web routes) can reach. One multi-source BFS marks everything
+//! reachable from all entries at once, expanding each level's frontier in
+//! parallel against an atomic bitset, so the cost is O(V + E) regardless of
+//! how many entries a monorepo has.
+
+use crate::domain::bitset::AtomicBitSet;
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use crate::domain::entry_point::EntryPoint;
+use rayon::prelude::*;
+use std::collections::{BTreeMap, HashMap, HashSet};
+
+/// Unreachable functions of one file.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct UnreachableGroup {
+    pub crate_name: String,
+    /// Definition file, or `<unknown>` when the graph has no location
+    pub file: String,
+    /// Ascending node indices
+    pub functions: Vec<NodeIdx>,
+}
+
+#[derive(Debug, Clone)]
+pub struct UnreachableReport {
+    /// Entry nodes the search started from
+    pub roots: Vec<NodeIdx>,
+    /// Defined functions reached from the roots (roots included)
+    pub reachable: usize,
+    /// Defined functions in the graph
+    pub total: usize,
+    /// Sorted by crate, then file
+    pub groups: Vec<UnreachableGroup>,
+}
+
+impl UnreachableReport {
+    pub fn compute(graph: &CallGraph, roots: &[NodeIdx]) -> Self {
+        let reached = reached_from(graph, roots);
+
+        let unreachable: Vec<NodeIdx> = graph
+            .nodes()
+            .into_par_iter()
+            .filter(|&v| !reached.contains(v as usize))
+            .collect();
+
+        let mut by_file: BTreeMap<(String, String), Vec<NodeIdx>> = BTreeMap::new();
+        for v in unreachable {
+            let file = graph
+                .location(v)
+                .map(|l| l.file())
+                .unwrap_or("<unknown>");
+            by_file
+                .entry((crate_of(graph.id(v)).to_string(), file.to_string()))
+                .or_default()
+                .push(v);
+        }
+
+        let total = graph.node_count();
+        let reachable = graph.nodes().filter(|&v| reached.contains(v as usize)).count();
+        Self {
+            roots: roots.to_vec(),
+            reachable,
+            total,
+            groups: by_file
+                .into_iter()
+                .map(|((crate_name, file), functions)| UnreachableGroup { crate_name, file, functions })
+                .collect(),
+        }
+    }
+
+    /// Number of unreachable functions.
+    pub fn count(&self) -> usize {
+        self.total - self.reachable
+    }
+}
+
+/// Every vertex reachable from `roots`, by level-synchronous BFS.
+pub fn reached_from(graph: &CallGraph, roots: &[NodeIdx]) -> AtomicBitSet {
+    let seen = AtomicBitSet::new(graph.vertex_count());
+    let mut frontier: Vec<NodeIdx> = roots.iter().copied().filter(|&r| seen.claim(r as usize)).collect();
+
+    while !frontier.is_empty() {
+        let seen = &seen;
+        frontier = frontier
+            .par_iter()
+            .flat_map_iter(|&u| {
+                graph.callees(u).iter().copied().filter(move |&v| seen.claim(v as usize))
+            })
+            .collect();
+    }
+    seen
+}
+
+/// Map detected entry points onto graph nodes: by id where the detector's
+/// id is a graph id, otherwise by definition site. Detector paths may be
+/// absolute while the graph's are workspace-relative (SCIP), so files match
+/// when one path ends with the other. Unmatched entries are dropped.
+pub fn resolve_entries(graph: &CallGraph, entries: &[EntryPoint]) -> Vec<NodeIdx> {
+    resolve_entry_points(graph, entries).into_iter().map(|(v, _)| v).collect()
+}
+
+/// `resolve_entries`, keeping the entry point each node was matched from.
+pub fn resolve_entry_points<'e>(graph: &CallGraph, entries: &'e [EntryPoint]) -> Vec<(NodeIdx, &'e EntryPoint)> {
+    // Defined nodes by definition line
+    let mut by_line: HashMap<usize, Vec<(&str, NodeIdx)>> = HashMap::new();
+    for v in graph.nodes() {
+        if let Some(site) = graph.location(v) {
+            by_line.entry(site.line as usize).or_default().push((site.file(), v));
+        }
+    }
+
+    let mut seen = HashSet::new();
+    entries
+        .iter()
+        .filter_map(|entry| {
+            graph.idx_of(&entry.id).or_else(|| {
+                let candidates = by_line.get(&entry.line?)?;
+                candidates
+                    .iter()
+                    .find(|(file, _)| same_file(file, &entry.file_path))
+                    .map(|&(_, v)| v)
+            })
+            .map(|v| (v, entry))
+        })
+        .filter(|&(v, _)| seen.insert(v))
+        .collect()
+}
+
+/// One path is the other, or ends with it at a component boundary.
+fn same_file(a: &str, b: &str) -> bool {
+    let (long, short) = if a.len() >= b.len() { (a, b) } else { (b, a) };
+    long.strip_suffix(short)
+        .map_or(false, |head| head.is_empty() || head.ends_with('/') || head.ends_with('\\'))
+}
+
+/// Crate (or package) a node id belongs to:
+/// SCIP symbols (`scheme manager package version descriptors`) carry it as
+/// the package field, syn method ids as `Type::method@crate`, syn function
+/// ids as `crate::function`.
+pub fn crate_of(id: &str) -> &str {
+    let fields: Vec<&str> = id.splitn(5, ' ').collect();
+    if fields.len() == 5 {
+        return fields[2];
+    }
+    if let Some((_, krate)) = id.rsplit_once('@') {
+        return krate;
+    }
+    id.split("::").next().unwrap_or(id)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::{CallGraphNode, GraphBuilder, Location};
+    use crate::domain::entry_point::EntryPointKind;
+    use crate::domain::symbol::Symbol;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    fn entry(id: &str, file: &str, line: usize) -> EntryPoint {
+        EntryPoint {
+            id: id.to_string(),
+            name: id.to_string(),
+            kind: EntryPointKind::Test,
+            file_path: file.to_string(),
+            line: Some(line),
+        }
+    }
+
+    #[test]
+    fn test_reports_what_no_entry_reaches() {
+        let graph = CallGraph::new(vec![
+            node("app::main", &["app::run"]),
+            node("app::run", &["std::println"]),
+            node("app::test_parse", &["app::parse"]),
+            node("app::parse", &[]),
+            node("app::dead", &["app::also_dead"]),
+            node("app::also_dead", &[]),
+            node("Cache::evict@store", &[]),
+        ]);
+        let roots = [graph.idx_of("app::main").unwrap(), graph.idx_of("app::test_parse").unwrap()];
+        let report = UnreachableReport::compute(&graph, &roots);
+
+        assert_eq!((report.total, report.reachable, report.count()), (7, 4, 3));
+        let groups: Vec<(&str, Vec<&str>)> = report.groups.iter()
+            .map(|g| (g.crate_name.as_str(), g.functions.iter().map(|&v| graph.id(v)).collect()))
+            .collect();
+        assert_eq!(groups, vec![
+            ("app", vec!["app::dead", "app::also_dead"]),
+            ("store", vec!["Cache::evict@store"]),
+        ]);
+    }
+
+    #[test]
+    fn test_entries_resolve_by_definition_site() {
+        let mut builder = GraphBuilder::new();
+        let main = builder.add_node(Symbol::intern("app::main"), None);
+        builder.set_location(main, Location::new(Symbol::intern("src/main.rs"), 3));
+        let check = builder.add_node(Symbol::intern("app::test_check"), None);
+        builder.set_location(check, Location::new(Symbol::intern("src/lib.rs"), 40));
+        let graph = builder.build();
+
+        let entries = [
+            entry("/ws/app/src/main.rs::main", "/ws/app/src/main.rs", 3),
+            entry("app::test_check", "src/lib.rs", 40),
+            entry("/ws/app/xsrc/main.rs::main", "/ws/app/xsrc/main.rs", 3),
+            entry("/ws/app/src/main.rs::other", "/ws/app/src/main.rs", 9),
+        ];
+        assert_eq!(resolve_entries(&graph, &entries), vec![main, check]);
+    }
+
+    #[test]
+    fn test_crate_of_each_id_style() {
+        assert_eq!(crate_of("rust-analyzer cargo mylib 0.1.0 util/parse()."), "mylib");
+        assert_eq!(crate_of("Parser::next@syntax"), "syntax");
+        assert_eq!(crate_of("app::main"), "app");
+    }
+}
@@ -0,0 +1,356 @@
+//! Viewport Queries
+//!
+//! Answers "what is visible in this rectangle at this zoom" against a cached
+//! layout. Zoomed in, nodes and edges come straight from R-trees over node
+//! boxes and edge bounding boxes. Zoomed out, nodes collapse into grid-cell
+//! clusters and edges into weighted cell-to-cell edges, so a view never
+//! carries more items than fit on screen.
+
+use crate::domain::callgraph::CallGraph;
+use crate::domain::layout::GraphLayout;
+use crate::domain::spatial::{RTree, Rect};
+use std::collections::{HashMap, HashSet};
+use std::sync::{Arc, Mutex};
+
+/// Node box size used for hit testing (matches the GUI's node ellipse).
+pub const NODE_WIDTH: f64 = 150.0;
+pub const NODE_HEIGHT: f64 = 40.0;
+
+/// Below this zoom factor, views are aggregated into clusters.
+pub const AGGREGATE_BELOW_ZOOM: f64 = 0.5;
+/// On-screen size of one aggregation cell, in pixels.
+pub const CELL_PIXELS: f64 = 64.0;
+
+/// Grid cell coordinate at some zoom level.
+pub type Cell = (i64, i64);
+
+/// A visible item: a real node, or a cluster of nodes in one cell.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum ViewportItem {
+    Node(u32),
+    Cluster { level: i32, cell: Cell },
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct ViewportNode {
+    pub item: ViewportItem,
+    /// Top-left corner in layout coordinates
+    pub x: f64,
+    pub y: f64,
+    /// Number of graph nodes represented (1 for a plain node)
+    pub count: usize,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct ViewportEdge {
+    pub from: ViewportItem,
+    pub to: ViewportItem,
+    /// Endpoints (top-left corners) so the client can draw edges whose
+    /// other end is off screen
+    pub from_pos: (f64, f64),
+    pub to_pos: (f64, f64),
+    /// Number of call edges represented
+    pub count: usize,
+}
+
+/// Result of a viewport query.
+#[derive(Debug, Clone, Default)]
+pub struct Viewport {
+    pub aggregated: bool,
+    pub nodes: Vec<ViewportNode>,
+    pub edges: Vec<ViewportEdge>,
+}
+
+/// Clusters and cell-to-cell edge weights for one zoom level.
+#[derive(Debug, Default)]
+struct CellLevel {
+    cell_size: f64,
+    counts: HashMap<Cell, usize>,
+    /// Per cell: `(other cell, edge count, outgoing?)`
+    links: HashMap<Cell, Vec<(Cell, usize, bool)>>,
+}
+
+/// Layout plus spatial indexes for one version of a graph.
+pub struct ViewportIndex {
+    layout: GraphLayout,
+    nodes: RTree,
+    edges: RTree,
+    bounds: Option<Rect>,
+    levels: Mutex<HashMap<i32, Arc<CellLevel>>>,
+}
+
+impl ViewportIndex {
+    pub fn build(graph: &CallGraph) -> Self {
+        let layout = GraphLayout::compute(graph);
+
+        let node_entries = layout
+            .positions
+            .iter()
+            .enumerate()
+            .map(|(i, &(x, y))| (node_box(x, y), i as u32))
+            .collect();
+
+        let edge_entries = layout
+            .edges
+            .iter()
+            .enumerate()
+            .map(|(i, &(from, to))| {
+                let (fx, fy) = layout.positions[from as usize];
+                let (tx, ty) = layout.positions[to as usize];
+                (node_box(fx, fy).union(&node_box(tx, ty)), i as u32)
+            })
+            .collect();
+
+        let nodes = RTree::bulk_load(node_entries);
+        let edges = RTree::bulk_load(edge_entries);
+        let bounds = nodes.bounds();
+
+        Self {
+            layout,
+            nodes,
+            edges,
+            bounds,
+            levels: Mutex::new(HashMap::new()),
+        }
+    }
+
+    /// Extent of the whole layout, or `None` for an empty graph.
+    pub fn bounds(&self) -> Option<Rect> {
+        self.bounds
+    }
+
+    pub fn position(&self, node: u32) -> (f64, f64) {
+        self.layout.positions[node as usize]
+    }
+
+    /// Everything visible in `window` at `zoom` (1.0 = one layout unit per pixel).
+    pub fn query(&self, window: &Rect, zoom: f64) -> Viewport {
+        if zoom < AGGREGATE_BELOW_ZOOM {
+            self.query_aggregated(window, zoom_level(zoom))
+        } else {
+            self.query_detailed(window)
+        }
+    }
+
+    fn query_detailed(&self, window: &Rect) -> Viewport {
+        let mut hits = Vec::new();
+        self.nodes.query(window, &mut hits);
+        hits.sort_unstable();
+
+        let nodes = hits
+            .iter()
+            .map(|&i| {
+                let (x, y) = self.position(i);
+                ViewportNode { item: ViewportItem::Node(i), x, y, count: 1 }
+            })
+            .collect();
+
+        hits.clear();
+        self.edges.query(window, &mut hits);
+        hits.sort_unstable();
+
+        let edges = hits
+            .iter()
+            .map(|&e| {
+                let (from, to) = self.layout.edges[e as usize];
+                ViewportEdge {
+                    from: ViewportItem::Node(from),
+                    to: ViewportItem::Node(to),
+                    from_pos: self.position(from),
+                    to_pos: self.position(to),
+                    count: 1,
+                }
+            })
+            .collect();
+
+        Viewport { aggregated: false, nodes, edges }
+    }
+
+    fn query_aggregated(&self, window: &Rect, level: i32) -> Viewport {
+        let cells = self.cell_level(level);
+        let size = cells.cell_size;
+        let cell_pos = |(cx, cy): Cell| (cx as f64 * size, cy as f64 * size);
+        let cluster = |cell: Cell| ViewportItem::Cluster { level, cell };
+
+        // A cell is visible when its origin lies in the window, so adjacent
+        // tiles partition the clusters between them
+        let (cx0, cy0) = cell_of(window.x0, window.y0, size);
+        let (cx1, cy1) = cell_of(window.x1, window.y1, size);
+        let span = ((cx1 - cx0 + 1) as u128) * ((cy1 - cy0 + 1) as u128);
+
+        let mut visible: Vec<Cell> = if span <= cells.counts.len() as u128 {
+            (cx0..=cx1)
+                .flat_map(|cx| (cy0..=cy1).map(move |cy| (cx, cy)))
+                .filter(|c| cells.counts.contains_key(c))
+                .collect()
+        } else {
+            cells.counts.keys().copied().collect()
+        };
+        visible.retain(|&c| {
+            let (x, y) = cell_pos(c);
+            window.contains_point(x, y)
+        });
+        visible.sort_unstable();
+
+        let nodes = visible
+            .iter()
+            .map(|&c| {
+                let (x, y) = cell_pos(c);
+                ViewportNode { item: cluster(c), x, y, count: cells.counts[&c] }
+            })
+            .collect();
+
+        let mut seen: HashSet<(Cell, Cell)> = HashSet::new();
+        let mut edges = Vec::new();
+        for &cell in &visible {
+            for &(other, count, outgoing) in cells.links.get(&cell).into_iter().flatten() {
+                let (from, to) = if outgoing { (cell, other) } else { (other, cell) };
+                if seen.insert((from, to)) {
+                    edges.push(ViewportEdge {
+                        from: cluster(from),
+                        to: cluster(to),
+                        from_pos: cell_pos(from),
+                        to_pos: cell_pos(to),
+                        count,
+                    });
+                }
+            }
+        }
+
+        Viewport { aggregated: true, nodes, edges }
+    }
+
+    /// Cluster counts and edge weights for `level`, computed once and cached.
+    fn cell_level(&self, level: i32) -> Arc<CellLevel> {
+        if let Some(cached) = self.levels.lock().unwrap().get(&level) {
+            return cached.clone();
+        }
+
+        let cell_size = CELL_PIXELS / 2f64.powi(level);
+        let cell_of_node = |n: u32| {
+            let (x, y) = self.position(n);
+            cell_of(x, y, cell_size)
+        };
+
+        let mut counts: HashMap<Cell, usize> = HashMap::new();
+        for &(x, y) in &self.layout.positions {
+            *counts.entry(cell_of(x, y, cell_size)).or_insert(0) += 1;
+        }
+
+        let mut weights: HashMap<(Cell, Cell), usize> = HashMap::new();
+        for &(from, to) in &self.layout.edges {
+            let (a, b) = (cell_of_node(from), cell_of_node(to));
+            if a != b {
+                *weights.entry((a, b)).or_insert(0) += 1;
+            }
+        }
+
+        let mut links: HashMap<Cell, Vec<(Cell, usize, bool)>> = HashMap::new();
+        for (&(a, b), &count) in &weights {
+            links.entry(a).or_default().push((b, count, true));
+            links.entry(b).or_default().push((a, count, false));
+        }
+        for list in links.values_mut() {
+            list.sort_unstable();
+        }
+
+        let computed = Arc::new(CellLevel { cell_size, counts, links });
+        self.levels.lock().unwrap().insert(level, computed.clone());
+        computed
+    }
+}
+
+/// Power-of-two zoom level: 0 at 1.0, -1 at 0.5, -2 at 0.25, ...
+pub fn zoom_level(zoom: f64) -> i32 {
+    if !(zoom > 0.0) {
+        return -30;
+    }
+    zoom.log2().floor().clamp(-30.0, 8.0) as i32
+}
+
+fn cell_of(x: f64, y: f64, size: f64) -> Cell {
+    ((x / size).floor() as i64, (y / size).floor() as i64)
+}
+
+fn node_box(x: f64, y: f64) -> Rect {
+    Rect::new(x, y, x + NODE_WIDTH, y + NODE_HEIGHT)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+    use crate::domain::layout::{MAX_ROW_NODES, NODE_SPACING_X};
+
+    /// A root calling `n` leaves: one row of roots, then wrapped leaf rows.
+    fn fan_out(n: usize) -> CallGraph {
+        let leaves: Vec<String> = (0..n).map(|i| format!("leaf{}", i)).collect();
+        let mut nodes = vec![CallGraphNode {
+            id: "main".to_string(),
+            callees: leaves.clone(),
+            label: None,
+        }];
+        nodes.extend(leaves.into_iter().map(|id| CallGraphNode { id, callees: vec![], label: None }));
+        CallGraph::new(nodes)
+    }
+
+    #[test]
+    fn test_detailed_query_returns_visible_nodes_and_edges() {
+        let index = ViewportIndex::build(&fan_out(10));
+
+        // Just the root row: only main, plus every edge leaving it
+        let view = index.query(&Rect::new(-10.0, -10.0, 160.0, 45.0), 1.0);
+        assert!(!view.aggregated);
+        assert_eq!(view.nodes.len(), 1);
+        assert_eq!(view.nodes[0].item, ViewportItem::Node(0));
+        // Only edges whose bounding box reaches the window
+        assert!(view.edges.iter().all(|e| e.from == ViewportItem::Node(0)));
+        assert!(!view.edges.is_empty());
+
+        // Far away: nothing
+        let empty = index.query(&Rect::new(1e6, 1e6, 1e6 + 100.0, 1e6 + 100.0), 1.0);
+        assert!(empty.nodes.is_empty() && empty.edges.is_empty());
+    }
+
+    #[test]
+    fn test_aggregated_counts_cover_graph() {
+        let n = MAX_ROW_NODES * 3;
+        let index = ViewportIndex::build(&fan_out(n));
+        let bounds = index.bounds().unwrap();
+        let window = Rect::new(bounds.x0, bounds.y0, bounds.x1 + 1.0, bounds.y1 + 1.0);
+
+        let view = index.query(&window, 0.01);
+        assert!(view.aggregated);
+        let total: usize = view.nodes.iter().map(|c| c.count).sum();
+        assert_eq!(total, n + 1);
+
+        // Far fewer items than the detailed view
+        assert!(view.nodes.len() < n / 4);
+        // Intra-cell edges are folded away, and cross-cell edges keep weights
+        let weight: usize = view.edges.iter().map(|e| e.count).sum();
+        assert!(weight <= n);
+    }
+
+    #[test]
+    fn test_aggregated_tiles_partition_clusters() {
+        let index = ViewportIndex::build(&fan_out(MAX_ROW_NODES * 2));
+        let zoom = 0.125;
+        let tile = 512.0 / zoom;
+        let width = MAX_ROW_NODES as f64 * NODE_SPACING_X;
+
+        let whole = index.query(&Rect::new(0.0, 0.0, 2.0 * width, tile), zoom);
+        let left = index.query(&Rect::new(0.0, 0.0, tile, tile), zoom);
+        let right = index.query(&Rect::new(tile, 0.0, 2.0 * width, tile), zoom);
+
+        assert_eq!(left.nodes.len() + right.nodes.len(), whole.nodes.len());
+    }
+
+    #[test]
+    fn test_zoom_level() {
+        assert_eq!(zoom_level(1.0), 0);
+        assert_eq!(zoom_level(0.5), -1);
+        assert_eq!(zoom_level(0.3), -2);
+        assert_eq!(zoom_level(2.0), 1);
+        assert_eq!(zoom_level(0.0), -30);
+    }
+}
@@ -1,5 +1,8 @@
 /// Concurrency management for Mr. Hedgehog.
 /// Configures thread pools to reserve system capacity for UI/LSP.
+///
+/// The global pool serves CLI runs; the daemon schedules its work on the
+/// priority pools in `scheduler`.
 
 use anyhow::Result;
 
@@ -1,13 +1,19 @@
 use syn::{Item, Stmt, Expr};
-use crate::domain::callgraph::{CallGraph, CallGraphNode};
+use crate::domain::callgraph::{CallGraph, GraphBuilder, Location};
+use crate::domain::symbol::Symbol;
 use crate::domain::index::SymbolIndex;
 
 pub mod project_loader;
 pub mod source_manager;
 pub mod expander;
 pub mod concurrency;
+pub mod scheduler;
+pub mod profiler;
 pub mod scip_runner;
 pub mod scip_cache;
+pub mod snapshot;
+pub mod shards;
+pub mod watcher;
 
 use std::sync::Arc;
 
@@ -42,7 +48,7 @@ impl crate::ports::CallGraphBuilder for SimpleCallGraphBuilder {
              }
         }
 
-        let mut func_defs = Vec::new();
+        let mut graph = GraphBuilder::new();
 
         // Step 2: Re-parse files to collect nodes (since we can't share ASTs across threads efficiently yet)
         let asts: Vec<(String, String, syn::File)> = files.iter().filter_map(|(crate_name, file_path, code)| {
@@ -53,19 +59,15 @@ impl crate::ports::CallGraphBuilder for SimpleCallGraphBuilder {
         }).collect();
 
         // Step 3: Collect Nodes
-        for (crate_name, _file, ast) in &asts {
+        for (crate_name, file, ast) in &asts {
             for item in &ast.items {
                  if let Item::Fn(func) = item {
                      let name = func.sig.ident.to_string();
-                     let id = format!("{}::{}", crate_name, name);
-                     let label = Some(format!("{}::{}", crate_name, name));
-                     
-                     func_defs.push(CallGraphNode {
-                         id,
-                         callees: Vec::new(),
-                         label,
-                         // We could store file/line in CallGraphNode if expanded, for now sticking to struct definition
-                     });
+                     // Label and id coincide (crate::fn)
+                     let id = Symbol::intern(&format!("{}::{}", crate_name, name));
+                     let idx = graph.add_node(id, Some(id));
+                     let line = func.sig.ident.span().start().line;
+                     graph.set_location(idx, Location::new(Symbol::intern(file), line as u32));
                  }
                  if let Item::Impl(imp) = item {
                      if let syn::Type::Path(tp) = &*imp.self_ty {
@@ -74,14 +76,12 @@ impl crate::ports::CallGraphBuilder for SimpleCallGraphBuilder {
                              for item in &imp.items {
                                  if let syn::ImplItem::Fn(method) = item {
                                      let method_name = method.sig.ident.to_string();
-                                     let id = format!("{}::{}@{}", type_name, method_name, crate_name);
-                                     let label = Some(format!("{}::{}", type_name, method_name));
+                                     let id = Symbol::intern(&format!("{}::{}@{}", type_name, method_name, crate_name));
+                                     let label = Symbol::intern(&format!("{}::{}", type_name, method_name));
                                      
-                                     func_defs.push(CallGraphNode {
-                                         id, 
-                                         callees: Vec::new(),
-                                         label,
-                                     });
+                                     let idx = graph.add_node(id, Some(label));
+                                     let line = method.sig.ident.span().start().line;
+                                     graph.set_location(idx, Location::new(Symbol::intern(file), line as u32));
                                  }
                              }
                          }
@@ -90,29 +90,27 @@ impl crate::ports::CallGraphBuilder for SimpleCallGraphBuilder {
             }
         }
 
-        let mut graph = CallGraph::new(func_defs);
-
         // Step 4: Add Edges
         for (crate_name, _, ast) in &asts {
              self.visit_ast_items(&ast.items, &mut graph, &index, crate_name);
         }
 
-        graph
+        graph.build()
     }
 }
 
 impl SimpleCallGraphBuilder {
-    fn visit_ast_items(&self, items: &[Item], graph: &mut CallGraph, index: &SymbolIndex, crate_name: &str) {
+    fn visit_ast_items(&self, items: &[Item], graph: &mut GraphBuilder, index: &SymbolIndex, crate_name: &str) {
         for item in items {
             match item {
                 Item::Fn(func) => {
-                     let caller_id = format!("{}::{}", crate_name, func.sig.ident);
+                     let caller_id = Symbol::intern(&format!("{}::{}", crate_name, func.sig.ident));
                      let mut callees = Vec::new();
                      for stmt in &func.block.stmts {
                          visit_stmt(stmt, &mut callees, index, crate_name);
                      }
                      for callee in callees {
-                         graph.add_edge(&caller_id, &callee);
+                         graph.add_edge(caller_id, callee);
                      }
                 }
                 Item::Impl(imp) => {
@@ -122,13 +120,13 @@ impl SimpleCallGraphBuilder {
                              for item in &imp.items {
                                  if let syn::ImplItem::Fn(method) = item {
                                      let method_name = method.sig.ident.to_string();
-                                     let caller_id = format!("{}::{}@{}", type_name, method_name, crate_name);
+                                     let caller_id = Symbol::intern(&format!("{}::{}@{}", type_name, method_name, crate_name));
                                      let mut callees = Vec::new();
                                      for stmt in &method.block.stmts {
                                          visit_stmt(stmt, &mut callees, index, crate_name);
                                      }
                                      for callee in callees {
-                                         graph.add_edge(&caller_id, &callee);
+                                         graph.add_edge(caller_id, callee);
                                      }
                                  }
                              }
@@ -149,7 +147,7 @@ impl SimpleCallGraphBuilder {
 // 遍歷語法樹、分析函式呼叫
 fn visit_stmt(
     stmt: &Stmt,
-    callees: &mut Vec<String>,
+    callees: &mut Vec<Symbol>,
     index: &SymbolIndex,
     crate_name: &str,
 ) {
@@ -166,7 +164,7 @@ fn visit_stmt(
 
 fn visit_expr(
     expr: &Expr,
-    callees: &mut Vec<String>,
+    callees: &mut Vec<Symbol>,
     index: &SymbolIndex,
     crate_name: &str,
 ) {
@@ -184,7 +182,7 @@ fn visit_expr(
                     // If "mod::func", we check if we can resolve it.
                     // For Stage 2, let's keep the existing logic:
                     // format!("{}@{}", segments.join("::"), crate_name)
-                    callees.push(format!("{}@{}", segments.join("::"), crate_name));
+                    callees.push(Symbol::intern(&format!("{}@{}", segments.join("::"), crate_name)));
                 }
             }
             for arg in &expr_call.args {
@@ -206,7 +204,7 @@ fn visit_expr(
                 if let Some(sig_ref) = index.store.get_method(rt, &method_name) {
                      // Found it! Use canonical ID.
                      let callee_id = format!("{}::{}@{}", rt, method_name, sig_ref.crate_name);
-                     callees.push(callee_id);
+                     callees.push(Symbol::intern(&callee_id));
                      resolved = true;
                 }
             }
@@ -218,7 +216,7 @@ fn visit_expr(
                     // Link to ALL matching methods (conservative approach)
                     for sig in candidates {
                         let callee_id = format!("{}::{}@{}", sig.name, method_name, sig.crate_name);
-                        callees.push(callee_id);
+                        callees.push(Symbol::intern(&callee_id));
                     }
                     resolved = true;
                 }
@@ -227,9 +225,9 @@ fn visit_expr(
             // Strategy 3: Fallback (Unknown local call)
             if !resolved {
                 if let Some(rt) = receiver_type {
-                    callees.push(format!("{}::{}@{}", rt, method_name, crate_name));
+                    callees.push(Symbol::intern(&format!("{}::{}@{}", rt, method_name, crate_name)));
                 } else {
-                    callees.push(format!("{}@{}", method_name, crate_name));
+                    callees.push(Symbol::intern(&format!("{}@{}", method_name, crate_name)));
                 }
             }
             
@@ -240,7 +238,7 @@ fn visit_expr(
         }
         Expr::Block(expr_block) => visit_block(&expr_block.block, callees, index, crate_name),
         Expr::If(expr_if) => {
-            callees.push("if(...)".to_string());
+            callees.push(Symbol::intern("if(...)"));
             visit_expr(&expr_if.cond, callees, index, crate_name);
             visit_block(&expr_if.then_branch, callees, index, crate_name);
             if let Some((_, else_branch)) = &expr_if.else_branch {
@@ -248,11 +246,10 @@ fn visit_expr(
             }
         }
         Expr::Match(expr_match) => {
-            callees.push("match(...)".to_string());
+            callees.push(Symbol::intern("match(...)"));
             visit_expr(&expr_match.expr, callees, index, crate_name);
             for (i, arm) in expr_match.arms.iter().enumerate() {
-                let label = format!("match_arm_{}", i);
-                callees.push(label.clone());
+                callees.push(Symbol::intern(&format!("match_arm_{}", i)));
                 visit_expr(&arm.body, callees, index, crate_name);
             }
         }
@@ -262,7 +259,7 @@ fn visit_expr(
 
 fn visit_block(
     block: &syn::Block,
-    callees: &mut Vec<String>,
+    callees: &mut Vec<Symbol>,
     index: &SymbolIndex,
     crate_name: &str,
 ) {
@@ -273,18 +270,26 @@ fn visit_block(
 
 pub struct DotExporter;
 
+impl DotExporter {
+    /// Defined nodes (with their call edges) formatted per parallel task.
+    const CHUNK_NODES: usize = 2048;
+}
+
 impl crate::ports::OutputExporter for DotExporter {
-    fn export(&self, cg: &CallGraph, path: &str) -> std::io::Result<()> {
-        let mut out = vec![];
-        out.push("digraph G {".to_string());
-        for n in &cg.nodes {
-            let lbl = n.label.clone().unwrap_or_else(|| n.id.clone());
-            out.push(format!("    \"{}\" [label=\"{}\"];", n.id, lbl.replace('\"', "\\\"")));
-            for c in &n.callees {
-                out.push(format!("    \"{}\" -> \"{}\";", n.id, c));
+    fn write(&self, cg: &CallGraph, out: &mut dyn std::io::Write) -> std::io::Result<()> {
+        use std::fmt::Write as _;
+
+        writeln!(out, "digraph G {{")?;
+        crate::ports::write_chunked(out, cg.node_count(), Self::CHUNK_NODES, |range, buf| {
+            for n in range.start as u32..range.end as u32 {
+                let id = cg.id(n);
+                let lbl = cg.display_label(n);
+                let _ = writeln!(buf, "    \"{}\" [label=\"{}\"];", id, lbl.replace('\"', "\\\""));
+                for &c in cg.callees(n) {
+                    let _ = writeln!(buf, "    \"{}\" -> \"{}\";", id, cg.id(c));
+                }
             }
-        }
-        out.push("}".to_string());
-        std::fs::write(path, out.join("\n"))
+        })?;
+        writeln!(out, "}}")
     }
 }
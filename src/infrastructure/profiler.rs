@@ -0,0 +1,427 @@
+/// In-Process CPU Sampler.
+///
+/// Samples the daemon's own threads with `SIGPROF` (driven by
+/// `setitimer(ITIMER_PROF)`, so only threads burning CPU are sampled) and
+/// reports folded stacks (`thread;root;...;leaf count`), the format consumed
+/// by flamegraph.pl, inferno and speedscope. No external profiler needed.
+///
+/// The signal handler only unwinds into a preallocated buffer; symbol
+/// resolution happens after sampling stops.
+
+use std::collections::HashMap;
+use std::time::Duration;
+use anyhow::Result;
+
+/// Default sampling rate; deliberately off 100 Hz to avoid lockstep with
+/// periodic work.
+pub const DEFAULT_FREQUENCY_HZ: u32 = 99;
+/// Highest accepted sampling rate.
+pub const MAX_FREQUENCY_HZ: u32 = 1000;
+/// Deepest stack recorded per sample.
+const MAX_DEPTH: usize = 128;
+/// Most samples buffered per session (about 1 KiB each); later samples
+/// are counted as dropped.
+const MAX_SLOTS: usize = 64 * 1024;
+
+/// Result of one profiling session.
+#[derive(Debug, Clone, Default)]
+pub struct Profile {
+    /// Samples captured (excluding any dropped when the buffer filled)
+    pub samples: usize,
+    /// Samples lost because the buffer was full
+    pub dropped: usize,
+    pub duration: Duration,
+    pub frequency_hz: u32,
+    /// `(folded stack, count)`, most frequent first
+    pub stacks: Vec<(String, usize)>,
+}
+
+impl Profile {
+    /// Render in the folded-stack text format, one stack per line.
+    pub fn to_folded(&self) -> String {
+        let mut out = String::new();
+        for (stack, count) in &self.stacks {
+            out.push_str(stack);
+            out.push(' ');
+            out.push_str(&count.to_string());
+            out.push('\n');
+        }
+        out
+    }
+}
+
+/// Merge identical stacks and order them by count (ties by name).
+fn fold(stacks: impl IntoIterator<Item = String>) -> Vec<(String, usize)> {
+    let mut counts: HashMap<String, usize> = HashMap::new();
+    for stack in stacks {
+        *counts.entry(stack).or_insert(0) += 1;
+    }
+    let mut folded: Vec<(String, usize)> = counts.into_iter().collect();
+    folded.sort_by(|a, b| b.1.cmp(&a.1).then_with(|| a.0.cmp(&b.0)));
+    folded
+}
+
+/// Frames belonging to the sampler itself rather than the sampled code.
+fn is_sampler_frame(name: &str) -> bool {
+    name.starts_with("backtrace::")
+        || name.contains("profiler::sampler::")
+        || name.contains("__restore_rt")
+        || name.contains("sigreturn")
+}
+
+/// Sample the whole process for `duration` at `frequency_hz`.
+///
+/// Blocks the calling thread for the duration. Only one session may run at
+/// a time; a concurrent call fails instead of waiting.
+#[cfg(unix)]
+pub fn profile(duration: Duration, frequency_hz: u32) -> Result<Profile> {
+    sampler::run(duration, frequency_hz)
+}
+
+#[cfg(not(unix))]
+pub fn profile(_duration: Duration, _frequency_hz: u32) -> Result<Profile> {
+    anyhow::bail!("PROFILE is only supported on Unix platforms")
+}
+
+#[cfg(unix)]
+mod sampler {
+    use super::*;
+    use std::cell::UnsafeCell;
+    use std::ffi::c_void;
+    use std::sync::atomic::{AtomicBool, AtomicPtr, AtomicUsize, Ordering};
+    use std::time::Instant;
+    use anyhow::Context;
+
+    /// One recorded stack. Written only by the handler that claimed it.
+    struct Slot {
+        ready: AtomicBool,
+        data: UnsafeCell<SlotData>,
+    }
+
+    struct SlotData {
+        tid: i64,
+        depth: usize,
+        frames: [usize; MAX_DEPTH],
+    }
+
+    // SAFETY: each slot is written by exactly one handler (claimed through
+    // `NEXT_SLOT`) and read only after `ready` is published.
+    unsafe impl Sync for Slot {}
+
+    static ACTIVE: AtomicBool = AtomicBool::new(false);
+    static SLOTS: AtomicPtr<Slot> = AtomicPtr::new(std::ptr::null_mut());
+    static CAPACITY: AtomicUsize = AtomicUsize::new(0);
+    static NEXT_SLOT: AtomicUsize = AtomicUsize::new(0);
+    /// Handlers between entry and exit; the buffer is freed only at zero.
+    static IN_FLIGHT: AtomicUsize = AtomicUsize::new(0);
+
+    /// Counts a handler as in flight for as long as it runs.
+    struct InFlight;
+
+    impl InFlight {
+        fn enter() -> Self {
+            IN_FLIGHT.fetch_add(1, Ordering::SeqCst);
+            Self
+        }
+    }
+
+    impl Drop for InFlight {
+        fn drop(&mut self) {
+            IN_FLIGHT.fetch_sub(1, Ordering::SeqCst);
+        }
+    }
+
+    extern "C" fn on_sigprof(_sig: libc::c_int, _info: *mut libc::siginfo_t, _ctx: *mut c_void) {
+        // Registered before `SLOTS` is read, so teardown either sees this
+        // handler in flight or this handler sees the null buffer
+        let _in_flight = InFlight::enter();
+        let slots = SLOTS.load(Ordering::SeqCst);
+        if slots.is_null() {
+            return;
+        }
+        let index = NEXT_SLOT.fetch_add(1, Ordering::Relaxed);
+        if index >= CAPACITY.load(Ordering::Relaxed) {
+            return; // Full; counted as dropped
+        }
+
+        // SAFETY: index < capacity and the slot is exclusively ours.
+        let slot = unsafe { &*slots.add(index) };
+        let data = unsafe { &mut *slot.data.get() };
+        data.tid = current_tid();
+        data.depth = 0;
+
+        // SAFETY: the callback itself neither allocates nor locks, and no
+        // other unwind of this sampler runs concurrently. The unwinder
+        // underneath is not async-signal-safe: `_Unwind_Backtrace` may take
+        // the loader lock, so a sample landing inside `dlopen` or another
+        // unwind can deadlock. Accepted for an opt-in diagnostic.
+        unsafe {
+            backtrace::trace_unsynchronized(|frame| {
+                if data.depth >= MAX_DEPTH {
+                    return false;
+                }
+                data.frames[data.depth] = frame.ip() as usize;
+                data.depth += 1;
+                true
+            });
+        }
+        slot.ready.store(true, Ordering::Release);
+    }
+
+    #[cfg(target_os = "linux")]
+    fn current_tid() -> i64 {
+        unsafe { libc::syscall(libc::SYS_gettid) as i64 }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn current_tid() -> i64 {
+        unsafe { libc::pthread_self() as usize as i64 }
+    }
+
+    /// Clears the session flag and buffer even if setup fails midway.
+    struct Session {
+        slots: Vec<Slot>,
+        previous: Option<libc::sigaction>,
+    }
+
+    impl Drop for Session {
+        fn drop(&mut self) {
+            stop_timer();
+            if let Some(previous) = self.previous.take() {
+                unsafe {
+                    libc::sigaction(libc::SIGPROF, &previous, std::ptr::null_mut());
+                }
+            }
+            quiesce();
+            ACTIVE.store(false, Ordering::Release);
+        }
+    }
+
+    /// Stop handing out the buffer and wait until no handler still uses it.
+    fn quiesce() {
+        SLOTS.store(std::ptr::null_mut(), Ordering::SeqCst);
+        while IN_FLIGHT.load(Ordering::SeqCst) != 0 {
+            std::thread::yield_now();
+        }
+    }
+
+    // Not exported by the `libc` crate on every target
+    extern "C" {
+        fn setitimer(which: libc::c_int, new: *const libc::itimerval, old: *mut libc::itimerval) -> libc::c_int;
+    }
+
+    fn set_timer(interval: Duration) -> std::io::Result<()> {
+        let tv = libc::timeval {
+            tv_sec: interval.as_secs() as libc::time_t,
+            tv_usec: interval.subsec_micros() as libc::suseconds_t,
+        };
+        let timer = libc::itimerval { it_interval: tv, it_value: tv };
+        if unsafe { setitimer(libc::ITIMER_PROF, &timer, std::ptr::null_mut()) } != 0 {
+            return Err(std::io::Error::last_os_error());
+        }
+        Ok(())
+    }
+
+    fn stop_timer() {
+        let _ = set_timer(Duration::ZERO);
+    }
+
+    pub fn run(duration: Duration, frequency_hz: u32) -> Result<Profile> {
+        let frequency_hz = frequency_hz.clamp(1, MAX_FREQUENCY_HZ);
+        if ACTIVE.swap(true, Ordering::AcqRel) {
+            anyhow::bail!("A profiling session is already running");
+        }
+
+        // Enough room for every thread to be sampled on each tick, within
+        // a fixed bound so a long, fast session on a big host stays small
+        let threads = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(4);
+        let wanted = (duration.as_secs_f64() * frequency_hz as f64 * threads as f64).ceil() as usize + 16;
+        let capacity = wanted.min(MAX_SLOTS);
+
+        let mut session = Session {
+            slots: (0..capacity)
+                .map(|_| Slot {
+                    ready: AtomicBool::new(false),
+                    data: UnsafeCell::new(SlotData { tid: 0, depth: 0, frames: [0; MAX_DEPTH] }),
+                })
+                .collect(),
+            previous: None,
+        };
+
+        NEXT_SLOT.store(0, Ordering::Relaxed);
+        CAPACITY.store(capacity, Ordering::Relaxed);
+        SLOTS.store(session.slots.as_mut_ptr(), Ordering::SeqCst);
+
+        unsafe {
+            let mut action: libc::sigaction = std::mem::zeroed();
+            action.sa_sigaction = on_sigprof as usize;
+            action.sa_flags = libc::SA_SIGINFO | libc::SA_RESTART;
+            libc::sigemptyset(&mut action.sa_mask);
+
+            let mut previous: libc::sigaction = std::mem::zeroed();
+            if libc::sigaction(libc::SIGPROF, &action, &mut previous) != 0 {
+                return Err(std::io::Error::last_os_error()).context("Failed to install SIGPROF handler");
+            }
+            session.previous = Some(previous);
+        }
+
+        let interval = Duration::from_micros(1_000_000 / frequency_hz as u64);
+        set_timer(interval).context("Failed to start profiling timer")?;
+
+        println!("[Profiler] Sampling for {:?} at {} Hz", duration, frequency_hz);
+        let start = Instant::now();
+        std::thread::sleep(duration);
+        stop_timer();
+        let elapsed = start.elapsed();
+
+        // Signals already queued may still arrive; let them finish
+        quiesce();
+
+        let claimed = NEXT_SLOT.load(Ordering::Relaxed);
+        let profile = symbolize(&session.slots, claimed, elapsed, frequency_hz);
+        drop(session);
+
+        println!("[Profiler] Captured {} samples ({} dropped)", profile.samples, profile.dropped);
+        Ok(profile)
+    }
+
+    fn symbolize(slots: &[Slot], claimed: usize, duration: Duration, frequency_hz: u32) -> Profile {
+        let mut symbols: HashMap<usize, Vec<String>> = HashMap::new();
+        let mut thread_names: HashMap<i64, String> = HashMap::new();
+        let mut stacks = Vec::new();
+
+        for slot in slots.iter().take(claimed) {
+            if !slot.ready.load(Ordering::Acquire) {
+                continue;
+            }
+            let data = unsafe { &*slot.data.get() };
+
+            let thread = thread_names
+                .entry(data.tid)
+                .or_insert_with(|| thread_name(data.tid))
+                .clone();
+
+            // Unwind order is leaf first: the sampler's own frames, the
+            // signal trampoline, then the interrupted code
+            let ips: Vec<usize> = data.frames[..data.depth].iter().copied().filter(|&ip| ip != 0).collect();
+            for &ip in &ips {
+                symbols.entry(ip).or_insert_with(|| resolve(ip));
+            }
+            let names = |ip: &usize| &symbols[ip];
+
+            let mut start = ips
+                .iter()
+                .rposition(|ip| names(ip).iter().any(|n| is_sampler_frame(n)))
+                .map(|p| p + 1)
+                .unwrap_or(0);
+            if let Some(ip) = ips.get(start) {
+                if start > 0 && names(ip).iter().all(|n| n.starts_with("0x") || is_sampler_frame(n)) {
+                    start += 1; // Unsymbolized trampoline
+                }
+            }
+
+            // Folded stacks are root first
+            let frames: Vec<String> = ips[start.min(ips.len())..]
+                .iter()
+                .rev()
+                .flat_map(|ip| names(ip).iter().cloned())
+                .collect();
+
+            let mut stack = thread;
+            for frame in frames {
+                stack.push(';');
+                stack.push_str(&frame);
+            }
+            stacks.push(stack);
+        }
+
+        let samples = stacks.len();
+        Profile {
+            samples,
+            dropped: claimed.saturating_sub(slots.len()),
+            duration,
+            frequency_hz,
+            stacks: fold(stacks),
+        }
+    }
+
+    /// Function names at `ip`, outermost inlined frame first.
+    fn resolve(ip: usize) -> Vec<String> {
+        let mut names = Vec::new();
+        backtrace::resolve(ip as *mut c_void, |symbol| {
+            let name = symbol
+                .name()
+                .map(|n| format!("{:#}", n))
+                .unwrap_or_else(|| format!("{:#x}", ip));
+            // Separators and spaces would break the folded format
+            names.push(name.replace(';', ":").replace(' ', "_"));
+        });
+        if names.is_empty() {
+            names.push(format!("{:#x}", ip));
+        }
+        // `resolve` reports the innermost inlined function first
+        names.reverse();
+        names
+    }
+
+    fn thread_name(tid: i64) -> String {
+        std::fs::read_to_string(format!("/proc/self/task/{}/comm", tid))
+            .map(|s| s.trim().replace(';', ":").replace(' ', "_"))
+            .ok()
+            .filter(|s| !s.is_empty())
+            .unwrap_or_else(|| format!("thread-{}", tid))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_fold_merges_and_orders() {
+        let folded = fold(vec![
+            "main;a;b".to_string(),
+            "main;a".to_string(),
+            "main;a;b".to_string(),
+        ]);
+        assert_eq!(folded, vec![("main;a;b".to_string(), 2), ("main;a".to_string(), 1)]);
+
+        let profile = Profile { stacks: folded, ..Default::default() };
+        assert_eq!(profile.to_folded(), "main;a;b 2\nmain;a 1\n");
+    }
+
+    #[test]
+    fn test_sampler_frames_are_recognized() {
+        assert!(is_sampler_frame("backtrace::backtrace::trace_unsynchronized"));
+        assert!(is_sampler_frame("mr_hedgehog::infrastructure::profiler::sampler::on_sigprof"));
+        assert!(!is_sampler_frame("mr_hedgehog::domain::scip_ingest::ScipIngestor::ingest_and_build_graph"));
+    }
+
+    #[cfg(target_os = "linux")]
+    #[test]
+    fn test_profile_captures_busy_thread() {
+        use std::sync::atomic::{AtomicBool, Ordering};
+        use std::sync::Arc;
+
+        let stop = Arc::new(AtomicBool::new(false));
+        let flag = stop.clone();
+        let worker = std::thread::Builder::new()
+            .name("busy-worker".to_string())
+            .spawn(move || {
+                let mut x = 0u64;
+                while !flag.load(Ordering::Relaxed) {
+                    x = x.wrapping_mul(6364136223846793005).wrapping_add(1);
+                    std::hint::black_box(x);
+                }
+            })
+            .unwrap();
+
+        let profile = profile(Duration::from_millis(300), 199).unwrap();
+        stop.store(true, Ordering::Relaxed);
+        worker.join().unwrap();
+
+        assert!(profile.samples > 0, "no samples captured");
+        assert!(profile.stacks.iter().any(|(stack, _)| stack.starts_with("busy-worker")));
+        assert!(profile.to_folded().lines().all(|l| l.rsplit_once(' ').is_some()));
+    }
+}
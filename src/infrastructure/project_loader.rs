@@ -123,7 +123,7 @@ impl ProjectLoader {
     }
 
     /// Attempts to find the cargo binary in several common locations.
-    fn find_cargo_binary() -> String {
+    pub(crate) fn find_cargo_binary() -> String {
         if let Ok(bin) = std::env::var("CARGO") { return bin; }
         if which::which("cargo").is_ok() { return "cargo".to_string(); }
         let home = std::env::var("HOME").unwrap_or_else(|_| "/".to_string());
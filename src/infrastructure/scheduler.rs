@@ -0,0 +1,220 @@
+/// Priority-aware job scheduling for the daemon.
+///
+/// Interactive queries (neighbors, traces) and background work (indexing,
+/// re-analysis after file changes) run on separate rayon pools, so a long
+/// reindex can never occupy the workers an interactive query needs.
+/// Background jobs additionally process their input in chunks and pause
+/// between chunks while interactive work is in flight, which frees the CPU
+/// cores the two pools share.
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::OnceLock;
+use std::thread;
+use std::time::{Duration, Instant};
+use anyhow::Result;
+use rayon::prelude::*;
+
+/// Scheduling class of a job.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Priority {
+    /// Latency-sensitive request from a client; never waits for indexing
+    Interactive,
+    /// Throughput work such as a full workspace index
+    Background,
+}
+
+/// Upper bound on a single background pause, so a steady stream of
+/// interactive requests slows indexing down but cannot stall it forever.
+const MAX_BACKGROUND_PAUSE: Duration = Duration::from_millis(200);
+
+/// Polling interval while a background chunk waits for interactive work.
+const PAUSE_POLL: Duration = Duration::from_millis(1);
+
+static SCHEDULER: OnceLock<Scheduler> = OnceLock::new();
+
+/// Two work-stealing pools plus a count of in-flight interactive jobs.
+pub struct Scheduler {
+    interactive: rayon::ThreadPool,
+    background: rayon::ThreadPool,
+    interactive_active: AtomicUsize,
+}
+
+impl Scheduler {
+    /// The process-wide scheduler, created on first use.
+    pub fn global() -> &'static Scheduler {
+        SCHEDULER.get_or_init(|| {
+            let (interactive, background) = pool_sizes(num_cpus::get());
+            let scheduler = Scheduler::with_threads(interactive, background)
+                .expect("Failed to build scheduler thread pools");
+            println!(
+                "[Scheduler] Interactive pool: {} workers, background pool: {} workers",
+                interactive, background
+            );
+            scheduler
+        })
+    }
+
+    /// Build a scheduler with explicit pool sizes.
+    pub fn with_threads(interactive: usize, background: usize) -> Result<Self> {
+        let interactive = rayon::ThreadPoolBuilder::new()
+            .num_threads(interactive.max(1))
+            .thread_name(|i| format!("mr-hedgehog-interactive-{}", i))
+            .build()?;
+        let background = rayon::ThreadPoolBuilder::new()
+            .num_threads(background.max(1))
+            .thread_name(|i| format!("mr-hedgehog-background-{}", i))
+            .build()?;
+
+        Ok(Self {
+            interactive,
+            background,
+            interactive_active: AtomicUsize::new(0),
+        })
+    }
+
+    /// Run `job` to completion on the pool for `priority`.
+    ///
+    /// Parallel iterators inside `job` use that pool's workers.
+    pub fn run<R, F>(&self, priority: Priority, job: F) -> R
+    where
+        R: Send,
+        F: FnOnce() -> R + Send,
+    {
+        match priority {
+            Priority::Interactive => {
+                let _active = InteractiveGuard::new(&self.interactive_active);
+                self.interactive.install(job)
+            }
+            Priority::Background => self.background.install(job),
+        }
+    }
+
+    /// Number of interactive jobs currently running.
+    pub fn interactive_pending(&self) -> usize {
+        self.interactive_active.load(Ordering::Acquire)
+    }
+
+    /// Called by background jobs between chunks: waits (bounded) while
+    /// interactive jobs are running. A no-op anywhere but on the
+    /// background pool, so CLI runs and interactive jobs never pause.
+    pub fn yield_to_interactive(&self) {
+        if self.background.current_thread_index().is_none() {
+            return;
+        }
+        self.wait_for_interactive(MAX_BACKGROUND_PAUSE);
+    }
+
+    /// Wait until no interactive job is running or `limit` has elapsed.
+    /// Returns whether the wait ended because interactive work drained.
+    fn wait_for_interactive(&self, limit: Duration) -> bool {
+        let start = Instant::now();
+        while self.interactive_pending() > 0 {
+            if start.elapsed() >= limit {
+                return false;
+            }
+            thread::sleep(PAUSE_POLL);
+        }
+        true
+    }
+}
+
+/// Split `cores` between the pools: background keeps the existing 50%
+/// reservation, interactive gets a small dedicated pool of its own.
+pub fn pool_sizes(cores: usize) -> (usize, usize) {
+    let background = std::cmp::max(1, cores / 2);
+    let interactive = std::cmp::max(2, cores / 4);
+    (interactive, background)
+}
+
+/// Pause the current background job if interactive work is waiting.
+///
+/// Cheap when no scheduler exists (CLI mode).
+pub fn cooperative_yield() {
+    if let Some(scheduler) = SCHEDULER.get() {
+        scheduler.yield_to_interactive();
+    }
+}
+
+/// Fold every item into per-task accumulators in parallel, `chunk_size`
+/// items at a time, yielding to interactive work between chunks. Returns
+/// the accumulators in item order, for the caller to merge.
+pub fn fold_chunked<T, A, ID, F>(items: &[T], chunk_size: usize, identity: ID, fold: F) -> Vec<A>
+where
+    T: Sync,
+    A: Send,
+    ID: Fn() -> A + Sync + Send,
+    F: Fn(A, &T) -> A + Sync + Send,
+{
+    let mut partials = Vec::new();
+    for chunk in items.chunks(chunk_size.max(1)) {
+        cooperative_yield();
+        partials.extend(chunk.par_iter().fold(&identity, &fold).collect::<Vec<A>>());
+    }
+    partials
+}
+
+/// Decrements the in-flight counter even if the job panics.
+struct InteractiveGuard<'a>(&'a AtomicUsize);
+
+impl<'a> InteractiveGuard<'a> {
+    fn new(counter: &'a AtomicUsize) -> Self {
+        counter.fetch_add(1, Ordering::AcqRel);
+        Self(counter)
+    }
+}
+
+impl Drop for InteractiveGuard<'_> {
+    fn drop(&mut self) {
+        self.0.fetch_sub(1, Ordering::AcqRel);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_pool_sizes() {
+        assert_eq!(pool_sizes(1), (2, 1));
+        assert_eq!(pool_sizes(8), (2, 4));
+        assert_eq!(pool_sizes(32), (8, 16));
+    }
+
+    #[test]
+    fn test_run_returns_result_and_tracks_interactive() {
+        let scheduler = Scheduler::with_threads(2, 2).unwrap();
+
+        let seen = scheduler.run(Priority::Interactive, || scheduler.interactive_pending());
+        assert_eq!(seen, 1);
+        assert_eq!(scheduler.interactive_pending(), 0);
+
+        let bg = scheduler.run(Priority::Background, || scheduler.interactive_pending());
+        assert_eq!(bg, 0);
+    }
+
+    #[test]
+    fn test_wait_for_interactive_is_bounded() {
+        let scheduler = Scheduler::with_threads(1, 1).unwrap();
+
+        // Nothing running: returns immediately
+        assert!(scheduler.wait_for_interactive(Duration::from_millis(50)));
+
+        // A stuck interactive job cannot stall background work forever
+        let _busy = InteractiveGuard::new(&scheduler.interactive_active);
+        let start = Instant::now();
+        assert!(!scheduler.wait_for_interactive(Duration::from_millis(20)));
+        assert!(start.elapsed() >= Duration::from_millis(20));
+    }
+
+    #[test]
+    fn test_fold_chunked_keeps_item_order() {
+        let items: Vec<u64> = (1..=1000).collect();
+
+        let partials = fold_chunked(&items, 64, Vec::new, |mut acc, x| {
+            acc.push(*x);
+            acc
+        });
+
+        assert_eq!(partials.concat(), items);
+    }
+}
@@ -6,6 +6,8 @@
 /// Cache structure:
 /// - `index.scip` - The SCIP protobuf index
 /// - `index.scip.meta` - JSON metadata for cache validation
+/// - `.scip/<crate>.scip` (+ `.meta`) - Per-crate indices when workspace
+///   members are indexed separately
 
 use std::collections::HashMap;
 use std::fs::{self, File};
@@ -40,6 +42,9 @@ pub struct ScipCache {
 }
 
 impl ScipCache {
+    /// Directory holding per-crate indices.
+    pub const CRATE_CACHE_DIR: &'static str = ".scip";
+
     /// Create a new cache manager for the given workspace.
     pub fn new(workspace_root: &Path) -> Self {
         let index_path = workspace_root.join("index.scip");
@@ -52,6 +57,35 @@ impl ScipCache {
         }
     }
 
+    /// Cache for one workspace member's index, under `CRATE_CACHE_DIR`.
+    /// Cargo.lock is still read from the workspace root.
+    pub fn for_crate(workspace_root: &Path, crate_name: &str) -> Self {
+        let file: String = crate_name
+            .chars()
+            .map(|c| if c.is_ascii_alphanumeric() || c == '-' || c == '_' { c } else { '_' })
+            .collect();
+        let dir = workspace_root.join(Self::CRATE_CACHE_DIR);
+        Self {
+            workspace_root: workspace_root.to_path_buf(),
+            index_path: dir.join(format!("{}.scip", file)),
+            meta_path: dir.join(format!("{}.scip.meta", file)),
+        }
+    }
+
+    /// Like `get_valid_cache`, but also requires the cache to have been
+    /// built from exactly `source_files`, so added files invalidate it too.
+    pub fn get_valid_cache_for(&self, source_files: &[String]) -> Option<PathBuf> {
+        let path = self.get_valid_cache()?;
+        let meta = self.load_metadata().ok()?;
+        let same_files = meta.source_files.len() == source_files.len()
+            && source_files.iter().all(|f| meta.source_files.contains_key(f));
+        if !same_files {
+            println!("[SCIP Cache] Source files were added or removed");
+            return None;
+        }
+        Some(path)
+    }
+
     /// Check if a valid cache exists and is up-to-date.
     /// Returns the path to the cached index if valid.
     pub fn get_valid_cache(&self) -> Option<PathBuf> {
@@ -267,6 +301,24 @@ mod tests {
         assert!(cache.get_valid_cache().is_none());
     }
 
+    #[test]
+    fn test_crate_cache_notices_new_files() {
+        let dir = tempdir().unwrap();
+        let cache = ScipCache::for_crate(dir.path(), "my-crate");
+        assert!(cache.index_path().ends_with(".scip/my-crate.scip"));
+
+        fs::create_dir_all(dir.path().join(ScipCache::CRATE_CACHE_DIR)).unwrap();
+        let lib = dir.path().join("lib.rs").to_string_lossy().to_string();
+        fs::write(&lib, "fn a() {}").unwrap();
+        fs::write(cache.index_path(), b"fake scip data").unwrap();
+        cache.update_metadata(&[lib.clone()]).unwrap();
+        assert!(cache.get_valid_cache_for(&[lib.clone()]).is_some());
+
+        let added = dir.path().join("new.rs").to_string_lossy().to_string();
+        fs::write(&added, "fn b() {}").unwrap();
+        assert!(cache.get_valid_cache_for(&[lib, added]).is_none());
+    }
+
     #[test]
     fn test_explicit_invalidation() {
         let dir = tempdir().unwrap();
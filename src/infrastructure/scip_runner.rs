@@ -6,12 +6,24 @@
 /// 
 /// Phase 3.2: Caching integration for incremental regeneration.
 /// Phase 3 v2: Multi-language support (Rust + Python).
+///
+/// Rust workspaces can also be indexed per member: one indexer process per
+/// crate, a bounded number at a time, each with its own cache, so a change
+/// re-indexes only the crates it touches.
 
+use std::fs;
 use std::path::{Path, PathBuf};
 use std::process::Command;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Mutex;
+use std::thread;
 use anyhow::{Context, Result, bail};
+use cargo_metadata::MetadataCommand;
+use super::project_loader::ProjectLoader;
 use super::scip_cache::ScipCache;
+use super::watcher;
 use crate::domain::language::Language;
+use crate::domain::scip_ingest::ScipInput;
 
 // ═══════════════════════════════════════════════════════════════════════════
 // Public API
@@ -76,10 +88,216 @@ pub fn generate_fresh_index(
     Ok(output_file)
 }
 
+/// A workspace member indexed on its own.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CrateUnit {
+    pub name: String,
+    /// Directory holding the member's Cargo.toml
+    pub dir: PathBuf,
+}
+
+/// Members of the Cargo workspace at `workspace_root`.
+pub fn workspace_crates(workspace_root: &Path) -> Result<Vec<CrateUnit>> {
+    let metadata = MetadataCommand::new()
+        .manifest_path(workspace_root.join("Cargo.toml"))
+        .cargo_path(ProjectLoader::find_cargo_binary())
+        .no_deps()
+        .exec()
+        .context("Failed to execute cargo metadata")?;
+
+    let mut crates: Vec<CrateUnit> = metadata
+        .workspace_packages()
+        .into_iter()
+        .filter_map(|package| {
+            let dir = package.manifest_path.as_std_path().parent()?;
+            Some(CrateUnit { name: package.name.clone(), dir: dir.to_path_buf() })
+        })
+        .collect();
+    crates.sort_by(|a, b| a.name.cmp(&b.name));
+    Ok(crates)
+}
+
+/// Generate one SCIP index per workspace member, running at most `jobs`
+/// indexers at once. Members whose cached index still matches their
+/// sources are not re-indexed. Returns the indices as ingest inputs, each
+/// prefixed with its member's directory relative to the workspace.
+///
+/// A member may contain others (a root package whose workspace lists
+/// `crates/*`). Its indexer still sees their files, so those are left out
+/// of its cache key and of its ingest input; each file is ingested from
+/// the most specific member only.
+///
+/// Indexers run from each member's directory, so every path handed to them
+/// or compared with cargo's absolute member paths is made absolute first.
+pub fn generate_crate_indices(workspace_root: &Path, language: Language, jobs: usize) -> Result<Vec<ScipInput>> {
+    if language != Language::Rust {
+        bail!("Per-crate indexing needs a Cargo workspace; {} is indexed as a whole", language);
+    }
+    check_indexer_available(language)?;
+
+    let crates = workspace_crates(workspace_root)?;
+    let units = plan_crate_jobs(workspace_root, &crates, language)?;
+    let stale: Vec<&CrateJob> = units
+        .iter()
+        .filter(|job| job.cache.get_valid_cache_for(&job.sources).is_none())
+        .collect();
+
+    println!(
+        "[SCIP] Indexing {} of {} crates, {} at a time",
+        stale.len(),
+        units.len(),
+        jobs.max(1).min(stale.len().max(1))
+    );
+
+    // Indexers are separate processes; threads here only wait on them
+    let next = AtomicUsize::new(0);
+    let failures = Mutex::new(Vec::new());
+    thread::scope(|scope| {
+        for _ in 0..jobs.max(1).min(stale.len()) {
+            scope.spawn(|| loop {
+                let i = next.fetch_add(1, Ordering::Relaxed);
+                let Some(job) = stale.get(i) else { break };
+                match index_crate(&job.unit, language, job.cache.index_path()) {
+                    Ok(()) => {
+                        if let Err(e) = job.cache.update_metadata(&job.sources) {
+                            eprintln!("[SCIP Cache] Warning: Failed to update metadata for {}: {}", job.unit.name, e);
+                        }
+                    }
+                    Err(e) => failures.lock().unwrap().push(format!("{}: {:#}", job.unit.name, e)),
+                }
+            });
+        }
+    });
+
+    let failures = failures.into_inner().unwrap();
+    if !failures.is_empty() {
+        bail!("SCIP indexing failed for {} crate(s):\n  {}", failures.len(), failures.join("\n  "));
+    }
+
+    Ok(units
+        .iter()
+        .map(|job| ScipInput {
+            path: job.cache.index_path().to_path_buf(),
+            path_prefix: job.prefix.clone(),
+            exclude: job.exclude.clone(),
+        })
+        .collect())
+}
+
+/// One member's share of a per-crate run.
+struct CrateJob {
+    /// The member, with an absolute directory
+    unit: CrateUnit,
+    /// Cache under the absolute workspace root
+    cache: ScipCache,
+    /// Member directory relative to the workspace root, with a trailing slash
+    prefix: String,
+    /// Source files owned by this member, nested members excluded
+    sources: Vec<String>,
+    /// Nested members' directories relative to this one, with a trailing slash
+    exclude: Vec<String>,
+}
+
+/// Resolve `workspace_root` and the member directories to absolute paths
+/// and work out each member's cache, sources and ingest prefix. Creates
+/// the cache directory.
+fn plan_crate_jobs(workspace_root: &Path, crates: &[CrateUnit], language: Language) -> Result<Vec<CrateJob>> {
+    let root = workspace_root
+        .canonicalize()
+        .with_context(|| format!("Failed to resolve workspace root: {}", workspace_root.display()))?;
+    fs::create_dir_all(root.join(ScipCache::CRATE_CACHE_DIR))
+        .context("Failed to create per-crate SCIP cache directory")?;
+
+    let crates: Vec<CrateUnit> = crates
+        .iter()
+        .map(|unit| CrateUnit {
+            name: unit.name.clone(),
+            dir: unit.dir.canonicalize().unwrap_or_else(|_| root.join(&unit.dir)),
+        })
+        .collect();
+
+    Ok(crates
+        .iter()
+        .map(|unit| {
+            let nested = nested_members(unit, &crates);
+            CrateJob {
+                cache: ScipCache::for_crate(&root, &unit.name),
+                prefix: path_prefix(&root, &unit.dir),
+                sources: crate_sources(&unit.dir, &nested, language),
+                exclude: nested.iter().map(|dir| path_prefix(&unit.dir, dir)).collect(),
+                unit: unit.clone(),
+            }
+        })
+        .collect())
+}
+
+/// Directories of the other members inside `unit`'s directory.
+fn nested_members(unit: &CrateUnit, crates: &[CrateUnit]) -> Vec<PathBuf> {
+    crates
+        .iter()
+        .filter(|other| other.dir != unit.dir && other.dir.starts_with(&unit.dir))
+        .map(|other| other.dir.clone())
+        .collect()
+}
+
 // ═══════════════════════════════════════════════════════════════════════════
 // Internal Implementation
 // ═══════════════════════════════════════════════════════════════════════════
 
+/// Index one member into `output_file`. Document paths in the result are
+/// relative to the member's directory.
+fn index_crate(unit: &CrateUnit, language: Language, output_file: &Path) -> Result<()> {
+    println!("[SCIP] Indexing crate {} ({})", unit.name, unit.dir.display());
+    let status = Command::new(language.scip_command())
+        .arg("scip")
+        .arg(".")
+        .arg("--output")
+        .arg(output_file)
+        .current_dir(&unit.dir)
+        .status()
+        .with_context(|| format!("Failed to execute {} scip", language.scip_command()))?;
+
+    if !status.success() {
+        bail!("indexer exited with code {:?}", status.code());
+    }
+    if !output_file.exists() {
+        bail!("no index was written to {}", output_file.display());
+    }
+    Ok(())
+}
+
+/// Source files of a member, for its cache metadata. Directories in
+/// `nested` belong to other members and are not walked.
+fn crate_sources(dir: &Path, nested: &[PathBuf], language: Language) -> Vec<String> {
+    let mut files = Vec::new();
+    let mut dirs = vec![dir.to_path_buf()];
+    while let Some(current) = dirs.pop() {
+        let listing = match fs::read_dir(&current) {
+            Ok(listing) => listing,
+            Err(_) => continue,
+        };
+        for path in listing.filter_map(|e| e.ok()).map(|e| e.path()) {
+            if path.is_dir() {
+                if !path.ends_with("target") && !path.ends_with(".git") && !nested.contains(&path) {
+                    dirs.push(path);
+                }
+            } else if watcher::is_relevant(dir, &path, language.extensions()) || path.ends_with("Cargo.toml") {
+                files.push(path.to_string_lossy().to_string());
+            }
+        }
+    }
+    files.sort();
+    files
+}
+
+/// `dir` relative to `root` with a trailing slash, or empty for the root.
+fn path_prefix(root: &Path, dir: &Path) -> String {
+    match dir.strip_prefix(root) {
+        Ok(rel) if !rel.as_os_str().is_empty() => format!("{}/", rel.to_string_lossy().replace('\\', "/")),
+        _ => String::new(),
+    }
+}
+
 /// Check if the language-specific SCIP indexer is available.
 fn check_indexer_available(language: Language) -> Result<()> {
     let command = language.scip_command();
@@ -199,6 +417,71 @@ mod tests {
         assert_ne!(rust_spec.args[0], python_spec.args[0]); // "scip" vs "index"
     }
 
+    #[test]
+    fn test_path_prefix_and_crate_sources() {
+        let dir = tempfile::tempdir().unwrap();
+        let member = dir.path().join("crates").join("core");
+        fs::create_dir_all(member.join("src")).unwrap();
+        fs::create_dir_all(member.join("target")).unwrap();
+        fs::write(member.join("Cargo.toml"), "[package]").unwrap();
+        fs::write(member.join("src").join("lib.rs"), "").unwrap();
+        fs::write(member.join("target").join("gen.rs"), "").unwrap();
+
+        assert_eq!(path_prefix(dir.path(), &member), "crates/core/");
+        assert_eq!(path_prefix(dir.path(), dir.path()), "");
+
+        let sources = crate_sources(&member, &[], Language::Rust);
+        assert_eq!(sources.len(), 2);
+        assert!(sources.iter().all(|s| !s.contains("target")));
+    }
+
+    #[test]
+    fn test_crate_jobs_resolve_a_relative_root() {
+        // A relative root, as `--workspace ./Cargo.toml` produces
+        let dir = tempfile::tempdir_in(".").unwrap();
+        let relative = Path::new(".").join(dir.path().file_name().unwrap());
+        let member = dir.path().join("crates").join("b");
+        fs::create_dir_all(member.join("src")).unwrap();
+        fs::write(member.join("src").join("lib.rs"), "").unwrap();
+
+        let crates = vec![
+            CrateUnit { name: "a".to_string(), dir: dir.path().canonicalize().unwrap() },
+            CrateUnit { name: "b".to_string(), dir: member.canonicalize().unwrap() },
+        ];
+        let jobs = plan_crate_jobs(&relative, &crates, Language::Rust).unwrap();
+
+        assert!(jobs.iter().all(|job| job.cache.index_path().is_absolute()));
+        assert!(dir.path().join(ScipCache::CRATE_CACHE_DIR).is_dir());
+        let prefixes: Vec<&str> = jobs.iter().map(|job| job.prefix.as_str()).collect();
+        assert_eq!(prefixes, vec!["", "crates/b/"]);
+        assert_eq!(jobs[0].exclude, vec!["crates/b/".to_string()]);
+    }
+
+    #[test]
+    fn test_root_package_leaves_nested_member_out() {
+        let dir = tempfile::tempdir().unwrap();
+        let nested = dir.path().join("repos").join("b");
+        fs::create_dir_all(dir.path().join("src")).unwrap();
+        fs::create_dir_all(nested.join("src")).unwrap();
+        fs::write(dir.path().join("Cargo.toml"), "[package]\n[workspace]").unwrap();
+        fs::write(dir.path().join("src").join("main.rs"), "").unwrap();
+        fs::write(nested.join("Cargo.toml"), "[package]").unwrap();
+        fs::write(nested.join("src").join("lib.rs"), "").unwrap();
+
+        let root = CrateUnit { name: "a".to_string(), dir: dir.path().to_path_buf() };
+        let member = CrateUnit { name: "b".to_string(), dir: nested.clone() };
+        let crates = vec![root.clone(), member.clone()];
+
+        let inside = nested_members(&root, &crates);
+        assert_eq!(inside, vec![nested.clone()]);
+        assert!(nested_members(&member, &crates).is_empty());
+        assert_eq!(path_prefix(&root.dir, &inside[0]), "repos/b/");
+
+        let sources = crate_sources(&root.dir, &inside, Language::Rust);
+        assert_eq!(sources.len(), 2);
+        assert!(sources.iter().all(|s| !s.contains("repos")));
+    }
+
     #[test]
     #[ignore] // Requires rust-analyzer to be installed
     fn test_generate_scip_index() {
@@ -0,0 +1,232 @@
+/// Sharded Graph Output
+///
+/// Writes a call graph as one DOT file per crate (its nodes and their
+/// outgoing edges) plus a small `manifest.json` with per-shard counts and
+/// crate-to-crate edge totals, so a viewer can show crates as clusters and
+/// load a shard only when its cluster is expanded.
+///
+/// Every edge line carries a `shard` attribute naming the shard that owns
+/// its target (`-1` for callees defined nowhere), so a loaded shard knows
+/// where each outgoing call lands without loading anything else.
+
+use std::collections::HashMap;
+use std::fs::{self, File};
+use std::io::{BufWriter, Write};
+use std::path::Path;
+use anyhow::{Context, Result};
+use rayon::prelude::*;
+use serde::{Deserialize, Serialize};
+
+use crate::domain::callgraph::{CallGraph, NodeIdx};
+use crate::domain::unreachable::crate_of;
+
+pub const MANIFEST_FILE: &str = "manifest.json";
+
+const MANIFEST_VERSION: u32 = 1;
+
+/// Target shard of calls to functions defined nowhere.
+const EXTERNAL: i32 = -1;
+
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct ShardEntry {
+    #[serde(rename = "crate")]
+    pub crate_name: String,
+    /// File name inside the shard directory
+    pub file: String,
+    pub nodes: usize,
+    /// Outgoing call edges, external ones included
+    pub edges: usize,
+    /// Calls to functions defined in no shard
+    pub external_edges: usize,
+}
+
+/// Number of calls from shard `from` into shard `to`.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct CrossEdge {
+    pub from: usize,
+    pub to: usize,
+    pub count: usize,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ShardManifest {
+    version: u32,
+    pub node_count: usize,
+    pub edge_count: usize,
+    /// Sorted by crate name
+    pub shards: Vec<ShardEntry>,
+    pub cross_edges: Vec<CrossEdge>,
+}
+
+impl ShardManifest {
+    /// Write `graph` into `dir` (created if missing), one shard per crate
+    /// in parallel, and the manifest last.
+    pub fn write(graph: &CallGraph, dir: &Path) -> Result<Self> {
+        fs::create_dir_all(dir)
+            .with_context(|| format!("Failed to create shard directory: {}", dir.display()))?;
+
+        // Group defined nodes by crate; shards are numbered in name order
+        let mut by_crate: HashMap<&str, Vec<NodeIdx>> = HashMap::new();
+        for v in graph.nodes() {
+            by_crate.entry(crate_of(graph.id(v))).or_default().push(v);
+        }
+        let mut groups: Vec<(&str, Vec<NodeIdx>)> = by_crate.into_iter().collect();
+        groups.sort_unstable_by_key(|&(name, _)| name);
+
+        let mut shard_of = vec![EXTERNAL; graph.vertex_count()];
+        for (k, (_, members)) in groups.iter().enumerate() {
+            for &v in members {
+                shard_of[v as usize] = k as i32;
+            }
+        }
+
+        let written: Vec<(ShardEntry, Vec<CrossEdge>)> = groups
+            .par_iter()
+            .enumerate()
+            .map(|(k, (name, members))| write_shard(graph, dir, k, name, members, &shard_of))
+            .collect::<Result<_>>()?;
+
+        let mut shards = Vec::with_capacity(written.len());
+        let mut cross_edges = Vec::new();
+        for (entry, cross) in written {
+            shards.push(entry);
+            cross_edges.extend(cross);
+        }
+
+        let manifest = Self {
+            version: MANIFEST_VERSION,
+            node_count: graph.node_count(),
+            edge_count: shards.iter().map(|s| s.edges).sum(),
+            shards,
+            cross_edges,
+        };
+        let path = dir.join(MANIFEST_FILE);
+        fs::write(&path, serde_json::to_vec_pretty(&manifest)?)
+            .with_context(|| format!("Failed to write manifest: {}", path.display()))?;
+        Ok(manifest)
+    }
+
+    pub fn load(dir: &Path) -> Result<Self> {
+        let path = dir.join(MANIFEST_FILE);
+        let bytes = fs::read(&path)
+            .with_context(|| format!("Failed to read manifest: {}", path.display()))?;
+        let manifest: Self = serde_json::from_slice(&bytes)
+            .with_context(|| format!("Failed to parse manifest: {}", path.display()))?;
+        if manifest.version != MANIFEST_VERSION {
+            anyhow::bail!("Manifest version mismatch: {} (expected {})", manifest.version, MANIFEST_VERSION);
+        }
+        Ok(manifest)
+    }
+
+    /// Shard holding node `id`, found from the crate its id names.
+    pub fn shard_of(&self, id: &str) -> Option<usize> {
+        let name = crate_of(id);
+        self.shards.binary_search_by(|s| s.crate_name.as_str().cmp(name)).ok()
+    }
+}
+
+/// Write one crate's shard; returns its entry and its cross-crate totals.
+fn write_shard(
+    graph: &CallGraph,
+    dir: &Path,
+    k: usize,
+    name: &str,
+    members: &[NodeIdx],
+    shard_of: &[i32],
+) -> Result<(ShardEntry, Vec<CrossEdge>)> {
+    let file = format!("{:04}_{}.dot", k, sanitize(name));
+    let path = dir.join(&file);
+    let mut out = BufWriter::new(
+        File::create(&path).with_context(|| format!("Failed to create shard: {}", path.display()))?,
+    );
+
+    let mut edges = 0;
+    let mut external_edges = 0;
+    let mut cross: HashMap<usize, usize> = HashMap::new();
+
+    writeln!(out, "digraph \"{}\" {{", escape(name))?;
+    for &v in members {
+        writeln!(out, "    \"{}\" [label=\"{}\"];", escape(graph.id(v)), escape(graph.display_label(v)))?;
+    }
+    for &v in members {
+        for &c in graph.callees(v) {
+            let target = shard_of[c as usize];
+            writeln!(out, "    \"{}\" -> \"{}\" [shard={}];", escape(graph.id(v)), escape(graph.id(c)), target)?;
+            edges += 1;
+            if target == EXTERNAL {
+                external_edges += 1;
+            } else if target as usize != k {
+                *cross.entry(target as usize).or_default() += 1;
+            }
+        }
+    }
+    writeln!(out, "}}")?;
+    out.flush()?;
+
+    let mut cross: Vec<CrossEdge> = cross
+        .into_iter()
+        .map(|(to, count)| CrossEdge { from: k, to, count })
+        .collect();
+    cross.sort_unstable_by_key(|e| e.to);
+
+    let entry = ShardEntry {
+        crate_name: name.to_string(),
+        file,
+        nodes: members.len(),
+        edges,
+        external_edges,
+    };
+    Ok((entry, cross))
+}
+
+/// Crate name as a file name component.
+fn sanitize(name: &str) -> String {
+    name.chars()
+        .map(|c| if c.is_ascii_alphanumeric() || c == '-' || c == '_' { c } else { '_' })
+        .collect()
+}
+
+fn escape(s: &str) -> String {
+    s.replace('\\', "\\\\").replace('"', "\\\"")
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    fn node(id: &str, callees: &[&str]) -> CallGraphNode {
+        CallGraphNode {
+            id: id.to_string(),
+            callees: callees.iter().map(|c| c.to_string()).collect(),
+            label: None,
+        }
+    }
+
+    #[test]
+    fn test_writes_one_shard_per_crate_with_manifest() {
+        let graph = CallGraph::new(vec![
+            node("app::main", &["app::run", "core::parse"]),
+            node("app::run", &["core::parse", "std::println"]),
+            node("core::parse", &["core::lex"]),
+            node("core::lex", &[]),
+        ]);
+        let dir = tempfile::tempdir().unwrap();
+        let manifest = ShardManifest::write(&graph, dir.path()).unwrap();
+
+        let names: Vec<&str> = manifest.shards.iter().map(|s| s.crate_name.as_str()).collect();
+        assert_eq!(names, vec!["app", "core"]);
+        assert_eq!((manifest.shards[0].nodes, manifest.shards[0].edges, manifest.shards[0].external_edges), (2, 4, 1));
+        assert_eq!(manifest.cross_edges, vec![CrossEdge { from: 0, to: 1, count: 2 }]);
+        assert_eq!(manifest.edge_count, 5);
+
+        let app = fs::read_to_string(dir.path().join(&manifest.shards[0].file)).unwrap();
+        assert!(app.contains("\"app::run\" -> \"core::parse\" [shard=1];"));
+        assert!(app.contains("\"app::run\" -> \"std::println\" [shard=-1];"));
+        assert!(!app.contains("\"core::lex\" [label"));
+
+        let loaded = ShardManifest::load(dir.path()).unwrap();
+        assert_eq!(loaded.shard_of("core::lex"), Some(1));
+        assert_eq!(loaded.shard_of("std::println"), None);
+    }
+}
@@ -0,0 +1,129 @@
+/// Graph Snapshots
+///
+/// A frozen call graph and its reachability index written to disk with
+/// bincode, so a restarted daemon (or a later comparison) does not have to
+/// re-ingest the SCIP index and rebuild the index.
+
+use std::fs;
+use std::path::{Path, PathBuf};
+use anyhow::{Context, Result};
+use serde::{Deserialize, Serialize};
+
+use crate::domain::callgraph::CallGraph;
+use crate::domain::reachability::ReachabilityIndex;
+
+/// File name of a workspace's snapshot, next to its cached `index.scip`.
+pub const SNAPSHOT_FILE: &str = "index.graph";
+
+/// Format version; snapshots of another version are ignored. Bumped
+/// whenever ingest changes what a graph contains, not only its encoding:
+/// 2 = references resolve to the innermost definition and only callable
+/// symbols are nodes; 3 = locations are stored as file and line.
+const SNAPSHOT_VERSION: u32 = 3;
+
+#[derive(Serialize)]
+struct SnapshotRef<'a> {
+    version: u32,
+    graph: &'a CallGraph,
+    reachability: Option<&'a ReachabilityIndex>,
+}
+
+/// A loaded snapshot.
+#[derive(Deserialize)]
+pub struct GraphSnapshot {
+    version: u32,
+    pub graph: CallGraph,
+    pub reachability: Option<ReachabilityIndex>,
+}
+
+impl GraphSnapshot {
+    /// Snapshot location for a SCIP index: the same directory.
+    pub fn path_for_index(index_path: &Path) -> PathBuf {
+        index_path.with_file_name(SNAPSHOT_FILE)
+    }
+
+    /// Write `graph` (and its index, if built) to `path`. The file is
+    /// replaced atomically, so readers never see a partial snapshot.
+    pub fn save(path: &Path, graph: &CallGraph, reachability: Option<&ReachabilityIndex>) -> Result<()> {
+        let bytes = bincode::serialize(&SnapshotRef {
+            version: SNAPSHOT_VERSION,
+            graph,
+            reachability,
+        })
+        .context("Failed to serialize graph snapshot")?;
+
+        let tmp = path.with_extension("graph.tmp");
+        fs::write(&tmp, &bytes)
+            .with_context(|| format!("Failed to write snapshot: {}", tmp.display()))?;
+        fs::rename(&tmp, path)
+            .with_context(|| format!("Failed to move snapshot into place: {}", path.display()))?;
+
+        println!("[Snapshot] Saved {} ({} bytes)", path.display(), bytes.len());
+        Ok(())
+    }
+
+    pub fn load(path: &Path) -> Result<Self> {
+        let bytes = fs::read(path)
+            .with_context(|| format!("Failed to read snapshot: {}", path.display()))?;
+        let snapshot: GraphSnapshot = bincode::deserialize(&bytes)
+            .with_context(|| format!("Failed to parse snapshot: {}", path.display()))?;
+        if snapshot.version != SNAPSHOT_VERSION {
+            anyhow::bail!("Snapshot version mismatch: {} (expected {})", snapshot.version, SNAPSHOT_VERSION);
+        }
+        Ok(snapshot)
+    }
+
+    /// Load the snapshot at `path` if it is at least as new as `source`
+    /// (the SCIP index it was built from). Any failure just means the
+    /// caller rebuilds.
+    pub fn load_if_current(path: &Path, source: &Path) -> Option<Self> {
+        let modified = |p: &Path| fs::metadata(p).and_then(|m| m.modified()).ok();
+        match (modified(path), modified(source)) {
+            (Some(snapshot), Some(source)) if snapshot >= source => {}
+            _ => return None,
+        }
+
+        match Self::load(path) {
+            Ok(snapshot) => {
+                println!("[Snapshot] Loaded {}", path.display());
+                Some(snapshot)
+            }
+            Err(e) => {
+                println!("[Snapshot] Ignoring {}: {}", path.display(), e);
+                None
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::domain::callgraph::CallGraphNode;
+
+    #[test]
+    fn test_snapshot_round_trips_graph_and_index() {
+        let graph = CallGraph::new(vec![
+            CallGraphNode { id: "main".into(), callees: vec!["a".into()], label: None },
+            CallGraphNode { id: "a".into(), callees: vec!["b".into()], label: None },
+        ]);
+        let index = ReachabilityIndex::build(&graph);
+
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join(SNAPSHOT_FILE);
+        GraphSnapshot::save(&path, &graph, Some(&index)).unwrap();
+
+        let loaded = GraphSnapshot::load(&path).unwrap();
+        assert_eq!(loaded.graph.callees_of("a"), vec!["b"]);
+        let reach = loaded.reachability.unwrap();
+        let (main, b) = (loaded.graph.idx_of("main").unwrap(), loaded.graph.idx_of("b").unwrap());
+        assert!(reach.reaches(main, b));
+        assert!(!reach.reaches(b, main));
+
+        // A snapshot older than its source is not used
+        let source = dir.path().join("index.scip");
+        std::thread::sleep(std::time::Duration::from_millis(20));
+        fs::write(&source, b"newer").unwrap();
+        assert!(GraphSnapshot::load_if_current(&path, &source).is_none());
+    }
+}
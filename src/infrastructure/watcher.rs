@@ -0,0 +1,239 @@
+/// Workspace File Watcher.
+///
+/// Wraps the platform file-notification backend (`notify`: inotify on Linux,
+/// FSEvents on macOS) and coalesces bursts of save events into a single
+/// callback once the workspace has been quiet for the debounce interval.
+
+use std::collections::BTreeSet;
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError};
+use std::thread;
+use std::time::{Duration, Instant};
+use anyhow::{Context, Result};
+use notify::{Event, EventKind, RecommendedWatcher, RecursiveMode, Watcher};
+
+/// Default quiet period before a batch of changes is reported.
+pub const DEFAULT_DEBOUNCE: Duration = Duration::from_millis(300);
+
+/// A recursive watch on a workspace root.
+///
+/// Dropping the watcher stops the OS watch; the debounce thread then drains
+/// any pending batch and exits.
+pub struct WorkspaceWatcher {
+    _watcher: RecommendedWatcher,
+    root: PathBuf,
+}
+
+impl WorkspaceWatcher {
+    /// Start watching `root` recursively.
+    ///
+    /// Only files whose extension is in `extensions` are reported; build
+    /// output (`target/`) and VCS metadata (`.git/`) are ignored. `on_change`
+    /// runs on the debounce thread with the sorted, de-duplicated set of
+    /// changed paths. Events arriving while it runs are queued and form the
+    /// next batch.
+    pub fn start<F>(
+        root: &Path,
+        extensions: &'static [&'static str],
+        debounce: Duration,
+        on_change: F,
+    ) -> Result<Self>
+    where
+        F: Fn(Vec<PathBuf>) + Send + 'static,
+    {
+        let (tx, rx) = mpsc::channel::<PathBuf>();
+        let filter_root = root.to_path_buf();
+
+        let mut watcher = notify::recommended_watcher(move |res: notify::Result<Event>| {
+            if let Ok(event) = res {
+                // Reads never change the graph
+                if matches!(event.kind, EventKind::Access(_)) {
+                    return;
+                }
+                for path in event.paths {
+                    let _ = tx.send(path);
+                }
+            }
+        })
+        .context("Failed to create file watcher")?;
+
+        watcher
+            .watch(root, RecursiveMode::Recursive)
+            .with_context(|| format!("Failed to watch {}", root.display()))?;
+
+        thread::Builder::new()
+            .name("mr-hedgehog-watch".to_string())
+            .spawn(move || debounce_loop(rx, &filter_root, debounce, extensions, on_change))
+            .context("Failed to spawn debounce thread")?;
+
+        println!("[Watch] Watching {}", root.display());
+
+        Ok(Self {
+            _watcher: watcher,
+            root: root.to_path_buf(),
+        })
+    }
+
+    /// The watched workspace root.
+    pub fn root(&self) -> &Path {
+        &self.root
+    }
+}
+
+/// Collect events into batches separated by at least `debounce` of silence.
+/// Only relevant events open a batch or restart the quiet period, so a
+/// build writing to `target/` cannot hold a batch back.
+fn debounce_loop<F>(
+    rx: Receiver<PathBuf>,
+    root: &Path,
+    debounce: Duration,
+    extensions: &'static [&'static str],
+    on_change: F,
+) where
+    F: Fn(Vec<PathBuf>),
+{
+    loop {
+        // Block until the first relevant event of a new burst
+        let first = loop {
+            match rx.recv() {
+                Ok(path) if is_relevant(root, &path, extensions) => break path,
+                Ok(_) => continue,
+                Err(_) => return, // Watcher dropped
+            }
+        };
+
+        let mut batch = BTreeSet::new();
+        batch.insert(first);
+
+        let mut disconnected = false;
+        let mut deadline = Instant::now() + debounce;
+        loop {
+            match rx.recv_timeout(deadline.saturating_duration_since(Instant::now())) {
+                Ok(path) => {
+                    if is_relevant(root, &path, extensions) {
+                        batch.insert(path);
+                        deadline = Instant::now() + debounce;
+                    }
+                }
+                Err(RecvTimeoutError::Timeout) => break,
+                Err(RecvTimeoutError::Disconnected) => {
+                    disconnected = true;
+                    break;
+                }
+            }
+        }
+
+        on_change(batch.into_iter().collect());
+        if disconnected {
+            return;
+        }
+    }
+}
+
+/// Whether a changed path under the workspace `root` can affect the
+/// analysis result. Only components below `root` are checked against the
+/// ignored directories, so a workspace that itself lives under a `target`
+/// directory still counts.
+pub fn is_relevant(root: &Path, path: &Path, extensions: &[&str]) -> bool {
+    let inside = path.strip_prefix(root).unwrap_or(path);
+    let ignored_dir = inside.components().any(|c| {
+        let name = c.as_os_str();
+        name == "target" || name == ".git"
+    });
+    if ignored_dir {
+        return false;
+    }
+
+    path.extension()
+        .and_then(|ext| ext.to_str())
+        .map(|ext| extensions.iter().any(|e| e.eq_ignore_ascii_case(ext)))
+        .unwrap_or(false)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_is_relevant_filters_extensions() {
+        let root = Path::new("/ws");
+        assert!(is_relevant(root, Path::new("/ws/src/lib.rs"), &["rs"]));
+        assert!(!is_relevant(root, Path::new("/ws/index.scip"), &["rs"]));
+        assert!(!is_relevant(root, Path::new("/ws/README"), &["rs"]));
+        assert!(is_relevant(root, Path::new("/ws/app.py"), &["py"]));
+    }
+
+    #[test]
+    fn test_is_relevant_ignores_build_dirs() {
+        let root = Path::new("/ws");
+        assert!(!is_relevant(root, Path::new("/ws/target/debug/build/out.rs"), &["rs"]));
+        assert!(!is_relevant(root, Path::new("/ws/.git/hooks/x.rs"), &["rs"]));
+    }
+
+    #[test]
+    fn test_is_relevant_only_checks_below_root() {
+        let root = Path::new("/home/u/target/ws");
+        assert!(is_relevant(root, Path::new("/home/u/target/ws/src/lib.rs"), &["rs"]));
+        assert!(!is_relevant(root, Path::new("/home/u/target/ws/target/out.rs"), &["rs"]));
+    }
+
+    #[test]
+    fn test_debounce_coalesces_burst() {
+        use std::sync::{Arc, Mutex};
+
+        let (tx, rx) = mpsc::channel();
+        let batches: Arc<Mutex<Vec<Vec<PathBuf>>>> = Arc::new(Mutex::new(Vec::new()));
+        let sink = batches.clone();
+
+        let handle = thread::spawn(move || {
+            debounce_loop(rx, Path::new("/ws"), Duration::from_millis(50), &["rs"], move |b| {
+                sink.lock().unwrap().push(b);
+            })
+        });
+
+        // A burst of saves, including duplicates and noise
+        tx.send(PathBuf::from("/ws/src/a.rs")).unwrap();
+        tx.send(PathBuf::from("/ws/src/b.rs")).unwrap();
+        tx.send(PathBuf::from("/ws/src/a.rs")).unwrap();
+        tx.send(PathBuf::from("/ws/index.scip")).unwrap();
+        drop(tx);
+        handle.join().unwrap();
+
+        let batches = batches.lock().unwrap();
+        assert_eq!(batches.len(), 1);
+        assert_eq!(
+            batches[0],
+            vec![PathBuf::from("/ws/src/a.rs"), PathBuf::from("/ws/src/b.rs")]
+        );
+    }
+
+    #[test]
+    fn test_debounce_ignores_noise_when_timing() {
+        use std::sync::{Arc, Mutex};
+
+        let (tx, rx) = mpsc::channel();
+        let batches: Arc<Mutex<Vec<Vec<PathBuf>>>> = Arc::new(Mutex::new(Vec::new()));
+        let sink = batches.clone();
+
+        let handle = thread::spawn(move || {
+            debounce_loop(rx, Path::new("/ws"), Duration::from_millis(100), &["rs"], move |b| {
+                sink.lock().unwrap().push(b);
+            })
+        });
+
+        // A save, then a build that keeps writing to target/ for longer
+        // than the quiet period
+        tx.send(PathBuf::from("/ws/src/a.rs")).unwrap();
+        for _ in 0..10 {
+            thread::sleep(Duration::from_millis(30));
+            tx.send(PathBuf::from("/ws/target/debug/out.rs")).unwrap();
+        }
+        let delivered = batches.lock().unwrap().len();
+        drop(tx);
+        handle.join().unwrap();
+
+        // The save was reported while the build was still writing
+        assert_eq!(delivered, 1);
+        assert_eq!(batches.lock().unwrap()[0], vec![PathBuf::from("/ws/src/a.rs")]);
+    }
+}
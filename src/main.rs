@@ -1,13 +1,24 @@
 use clap::Parser;
-use std::collections::HashMap;
 
 use mr_hedgehog::infrastructure::{SimpleCallGraphBuilder, DotExporter};
 use mr_hedgehog::infrastructure::project_loader::ProjectLoader;
 use mr_hedgehog::infrastructure::source_manager::SourceManager;
 use mr_hedgehog::infrastructure::concurrency;
-use mr_hedgehog::domain::trace::TraceGenerator;
+use mr_hedgehog::domain::trace::{find_main, TraceGenerator, TraceLimits};
+use mr_hedgehog::domain::paths::KShortestPaths;
+use mr_hedgehog::domain::callgraph::NodeIdx;
+use rayon::prelude::*;
+use mr_hedgehog::domain::condense::{Condensation, PathStats};
 use mr_hedgehog::domain::language::Language;
-use mr_hedgehog::domain::entry_point::EntryPointDetector;
+use mr_hedgehog::domain::entry_point::{EntryPoint, EntryPointDetector};
+use mr_hedgehog::domain::dominators::Dominators;
+use mr_hedgehog::domain::reachability::ReachabilityIndex;
+use mr_hedgehog::domain::scip_ingest::{IngestOptions, ScipIngestor, ScipInput};
+use mr_hedgehog::domain::unreachable::{resolve_entries, UnreachableReport};
+use mr_hedgehog::infrastructure::snapshot::GraphSnapshot;
+use mr_hedgehog::infrastructure::shards::ShardManifest;
+use mr_hedgehog::domain::delta::GraphDelta;
+use mr_hedgehog::ports::delta_exporter::{DeltaExporter, DeltaFormat};
 use mr_hedgehog::domain::flowgraph::FlowGraph;
 use mr_hedgehog::ports::{CallGraphBuilder, OutputExporter};
 use mr_hedgehog::ports::flowchart_exporter::FlowchartExporter;
@@ -31,9 +42,13 @@ struct Cli {
     #[arg(short, long)]
     output: Option<String>,
 
-    /// output format (ignored for now)
-    #[arg(short, long, default_value="dot")]
-    format: String,
+    /// output format: dot, json or bin (only used by --diff; inferred from the output extension when omitted)
+    #[arg(short, long)]
+    format: Option<String>,
+
+    /// Compare two snapshots (see --snapshot) and write the call edges added and removed
+    #[arg(long, num_args = 2, value_names = ["OLD", "NEW"])]
+    diff: Vec<String>,
 
     /// 反向查詢（查詢所有能呼叫到此 function 的所有路徑，例 Type::func@crate）
     #[arg(long)]
@@ -43,6 +58,14 @@ struct Cli {
     #[arg(long)]
     expand_paths: bool,
 
+    /// Max paths printed by --expand-paths and --reverse
+    #[arg(long, default_value = "50")]
+    max_paths: usize,
+
+    /// Max call depth followed by --expand-paths
+    #[arg(long, default_value = "30")]
+    trace_depth: usize,
+
     /// 分支 event 摘要模式（if/match 分支遇到相同 event 只記一次，不重複展開）
     #[arg(long)]
     branch_summary: bool,
@@ -75,13 +98,29 @@ struct Cli {
     #[arg(long, default_value = "4545")]
     port: u16,
 
-    /// Output mode: "callgraph" (default) or "flowchart"
+    /// Output mode: "callgraph" (default), "flowchart", "reach" (path statistics), "dominators" (chokepoints), "unreachable" (dead functions) or "shards" (one DOT per crate in the --output directory)
     #[arg(long, default_value = "callgraph")]
     mode: String,
 
+    /// Node reported by --mode reach / dominators
+    #[arg(long)]
+    target: Option<String>,
+
     /// Max depth for flowchart expansion (default: 10)
     #[arg(long, default_value = "10")]
     max_depth: usize,
+
+    /// Save the graph and its reachability index to this snapshot file
+    #[arg(long)]
+    snapshot: Option<String>,
+
+    /// With --engine scip, also write function-to-type references (a layer separate from calls) to this DOT file
+    #[arg(long)]
+    type_refs: Option<String>,
+
+    /// With --engine scip on a Rust workspace, index each member crate separately, N indexers at a time (0 = one index for the whole workspace)
+    #[arg(long, default_value = "0")]
+    scip_jobs: usize,
 }
 
 fn main() {
@@ -105,7 +144,7 @@ fn main() {
     // ── Normal CLI Mode ───────────────────────
     
     // Validate required args for CLI mode
-    if cli.output.is_none() {
+    if cli.output.is_none() && cli.snapshot.is_none() && cli.diff.is_empty() && cli.mode != "reach" && cli.mode != "dominators" && cli.mode != "unreachable" {
         use clap::CommandFactory;
         let mut cmd = Cli::command();
         cmd.error(
@@ -118,6 +157,15 @@ fn main() {
         println!("[DEBUG] Config: {:?}", cli);
     }
 
+    // ── Snapshot diff (no analysis needed) ───────
+    if !cli.diff.is_empty() {
+        if let Err(e) = run_diff(&cli) {
+            eprintln!("Diff failed: {:#}", e);
+            std::process::exit(1);
+        }
+        return;
+    }
+
     // Branch based on engine selection
     let (callgraph, files) = match cli.engine.as_str() {
         "scip" => {
@@ -129,13 +177,24 @@ fn main() {
                 .map(|ws| std::path::Path::new(ws).parent().unwrap_or(std::path::Path::new(".")))
                 .unwrap_or(std::path::Path::new("."));
             
+            // 逐 crate 並行索引（僅 Rust），其他語言退回整體索引
+            let per_crate = cli.scip_jobs > 0 && language == Language::Rust;
+            if cli.scip_jobs > 0 && !per_crate {
+                eprintln!("Warning: --scip-jobs only applies to Rust workspaces; indexing {} as a whole", language);
+            }
+
             // Generate SCIP index for the specified language
-            let scip_path = match mr_hedgehog::infrastructure::scip_runner::generate_scip_index_for_language(
-                workspace_path, 
-                language,
-                &[]
-            ) {
-                Ok(path) => path,
+            let generated = if per_crate {
+                mr_hedgehog::infrastructure::scip_runner::generate_crate_indices(workspace_path, language, cli.scip_jobs)
+            } else {
+                mr_hedgehog::infrastructure::scip_runner::generate_scip_index_for_language(
+                    workspace_path,
+                    language,
+                    &[]
+                ).map(|path| vec![ScipInput::new(path)])
+            };
+            let inputs = match generated {
+                Ok(inputs) => inputs,
                 Err(e) => {
                     eprintln!("Error generating SCIP index: {}", e);
                     if language == Language::Rust {
@@ -149,8 +208,16 @@ fn main() {
             };
             
             // Ingest SCIP and build graph
-            match mr_hedgehog::domain::scip_ingest::ScipIngestor::ingest_and_build_graph(&scip_path) {
-                Ok(cg) => {
+            let options = IngestOptions { type_refs: cli.type_refs.is_some() };
+            match ScipIngestor::ingest_all(&inputs, options) {
+                Ok(graphs) => {
+                    if let (Some(path), Some(layer)) = (&cli.type_refs, &graphs.type_refs) {
+                        match DotExporter.export(layer, path) {
+                            Ok(()) => println!("[SCIP Ingest] Type references written to {}", path),
+                            Err(e) => eprintln!("Error writing type references: {}", e),
+                        }
+                    }
+                    let cg = graphs.calls;
                     // For SCIP engine, we still might want file contents for rich traces
                     let loaded_files = if let Some(ws) = &cli.workspace {
                         ProjectLoader::load_workspace(ws, cli.expand_macros).unwrap_or_default()
@@ -221,15 +288,15 @@ fn run_syn_engine(cli: &Cli) {
 /// Common post-processing: reverse queries, trace expansion, DOT export
 fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::CallGraph, files: &[(String, String, String)]) {
 
-    // for quick lookup
-    let mut map=HashMap::new(); 
-    for n in &callgraph.nodes {
-        map.insert(n.id.clone(), n);
+    if let Some(ref path) = cli.snapshot {
+        let index = ReachabilityIndex::build(callgraph);
+        if let Err(e) = GraphSnapshot::save(std::path::Path::new(path), callgraph, Some(&index)) {
+            eprintln!("Failed to save snapshot: {:#}", e);
+        }
     }
-    
-    let entry=callgraph.nodes.iter()
-        .find(|n| n.id.starts_with("main@") || n.id.contains("::main"))
-        .map(|n| n.id.clone())
+
+    let entry=find_main(callgraph)
+        .map(|n| callgraph.id(n).to_string())
         .unwrap_or_else(|| {
             eprintln!("WARN: no main() found in call graph");
             "".into()
@@ -238,51 +305,113 @@ fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::Ca
     // ── reverse call查詢 ──────────────────────
     if let Some(ref target_id) = cli.reverse {
         println!("=== Reverse call tracing: {} ===", target_id);
-        // 1. 構建 caller_map: callee_id → Vec<caller_id>
-        let mut caller_map: HashMap<String, Vec<String>> = HashMap::new();
-        for node in &callgraph.nodes {
-            for callee in &node.callees {
-                caller_map.entry(callee.clone()).or_default().push(node.id.clone());
+
+        // main 到 target 的最短路徑,依長度由短到長逐條輸出 (至多 --max-paths 條)
+        let mut found = 0;
+        if let (Some(start), Some(target)) = (callgraph.idx_of(&entry), callgraph.idx_of(target_id)) {
+            for path in KShortestPaths::new(callgraph, start, target).take(cli.max_paths) {
+                found += 1;
+                println!("路徑 {}:", found);
+                for seg in path {
+                    println!("  {}", callgraph.id(seg));
+                }
             }
         }
+        if found == 0 {
+            println!("找不到任何路徑從 main 到 {}", target_id);
+        }
+        return;
+    }
 
-        // 2. BFS/DFS 搜尋所有從 main@... 到 target_id 的完整呼叫路徑
-        let mut all_paths: Vec<Vec<String>> = vec![];
-        let mut stack = vec![(vec![entry.clone()], entry.clone())]; // (目前路徑, 當前節點)
-
-        while let Some((path, node_id)) = stack.pop() {
-            if node_id == *target_id {
-                all_paths.push(path.clone());
-                continue;
-            }
-            // 找 callee
-            if let Some(n) = map.get(&node_id) {
-                for callee in &n.callees {
-                    if !path.contains(callee) { // 防止循環
-                        let mut new_path = path.clone();
-                        new_path.push(callee.clone());
-                        stack.push((new_path, callee.clone()));
+    // ── reach: path 數量與深度統計 (不列出路徑) ──────────
+    if cli.mode == "reach" {
+        let start = match callgraph.idx_of(&entry) {
+            Some(start) => start,
+            None => return,
+        };
+        let condensation = Condensation::build(callgraph);
+        let stats = PathStats::compute(&condensation, &[start]);
+        println!("=== Reachability from {} ===", entry);
+        println!(
+            "{} of {} nodes reachable ({} SCCs, {} DAG edges)",
+            stats.reachable_count(),
+            callgraph.vertex_count(),
+            condensation.len(),
+            condensation.edge_count()
+        );
+
+        if let Some(ref target_id) = cli.target {
+            match callgraph.idx_of(target_id).map(|t| (t, stats.node(t))) {
+                None => println!("找不到節點 {}", target_id),
+                Some((_, None)) => println!("{}: unreachable from {}", target_id, entry),
+                Some((t, Some(node))) => {
+                    let bound = if node.saturated() { ">= " } else { "" };
+                    println!("{}:", target_id);
+                    println!("  paths:     {}{}", bound, node.paths);
+                    println!("  min depth: {}", node.min_depth);
+                    println!("  max depth: {}", node.max_depth);
+                    if node.recursive {
+                        println!("  recursive: {} functions in its cycle", condensation.members(condensation.component(t)).len());
                     }
                 }
             }
         }
-        if all_paths.is_empty() {
-            println!("找不到任何路徑從 main 到 {}", target_id);
-        } else {
-            for (i, path) in all_paths.iter().enumerate() {
-                println!("路徑 {}:", i+1);
-                for seg in path {
-                    println!("  {}", seg);
+        return;
+    }
+
+    // ── dominators: 每條路徑必經的函式 (chokepoints) ──────────
+    if cli.mode == "dominators" {
+        // Detected entry points that exist in the graph, else main
+        let mut roots: Vec<NodeIdx> = resolve_entries(callgraph, &detect_entries(cli, files));
+        if roots.is_empty() {
+            roots.extend(callgraph.idx_of(&entry));
+        }
+
+        let trees: Vec<Dominators> = roots.par_iter().map(|&r| Dominators::compute(callgraph, &[r])).collect();
+        let target = cli.target.as_ref().and_then(|t| callgraph.idx_of(t));
+        if let (Some(t), None) = (&cli.target, target) {
+            println!("找不到節點 {}", t);
+            return;
+        }
+
+        for (&root, dom) in roots.iter().zip(&trees) {
+            println!("=== Dominators from {} ===", callgraph.id(root));
+            match target {
+                Some(t) if !dom.is_reachable(t) => println!("  unreachable"),
+                Some(t) => {
+                    for d in dom.dominators(t) {
+                        println!("  {}", callgraph.id(d));
+                    }
+                    println!("  -> {}", callgraph.id(t));
+                }
+                None => {
+                    // Chokepoints guarding the most functions
+                    let counts = dom.dominated_counts();
+                    let mut ranked: Vec<NodeIdx> = callgraph.vertices()
+                        .filter(|&v| v != root && counts[v as usize] > 1)
+                        .collect();
+                    ranked.sort_by_key(|&v| (std::cmp::Reverse(counts[v as usize]), v));
+                    for &v in ranked.iter().take(10) {
+                        println!("  {:>6}  {}", counts[v as usize] - 1, callgraph.id(v));
+                    }
                 }
             }
         }
+
+        if let Some(t) = target {
+            let post = Dominators::compute_post(callgraph);
+            println!("=== Post-dominators of {} ===", callgraph.id(t));
+            for d in post.dominators(t).into_iter().rev() {
+                println!("  {}", callgraph.id(d));
+            }
+        }
         return;
     }
 
     // ── 3. trace from main ──────────────────
     if cli.debug {
         println!("\n==== [DEBUG nodes] ====");
-        for n in &callgraph.nodes{println!("{} -> {:?}",n.id,n.callees);}
+        for n in callgraph.nodes(){println!("{} -> {:?}",callgraph.id(n),callgraph.callees_of(callgraph.id(n)));}
         println!("========================");
     }
 
@@ -291,27 +420,29 @@ fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::Ca
         let source_manager = SourceManager::new(&files);
 
         println!("\n=== Rich Trace Paths from {} ===", entry);
-        let trace_gen = TraceGenerator::new(&callgraph, &source_manager);
-        let paths = trace_gen.generate_paths(&entry);
+        let limits = TraceLimits { max_depth: cli.trace_depth, max_paths: cli.max_paths };
+        let trace_gen = TraceGenerator::with_limits(&callgraph, &source_manager, limits);
+        let paths = trace_gen.enumerate(&entry);
 
         if paths.is_empty() {
              println!("No paths found.");
         }
 
+        // Steps and snippets are resolved as each path is printed
         for (i, path) in paths.iter().enumerate() {
             println!("Path {}:", i + 1);
-            for (step_idx, step) in path.steps.iter().enumerate() {
-                let location = step.location.as_deref().unwrap_or("?");
-                let note = step.note.as_deref().unwrap_or("");
+            for (step_idx, step) in path.steps().iter().enumerate() {
+                let location = step.location().unwrap_or_else(|| "?".to_string());
+                let note = step.note().unwrap_or("");
                 let note_str = if !note.is_empty() { format!(" {}", note) } else { "".to_string() };
                 
                 // Indentation based on depth (step.depth or just loop index? 
                 // trace.rs sets depth. Let's use it.)
-                let indent = "  ".repeat(step.depth);
+                let indent = "  ".repeat(step.depth());
                 
-                println!("{}[{}] {}{} ({})", indent, step_idx, step.id, note_str, location);
+                println!("{}[{}] {}{} ({})", indent, step_idx, step.id(), note_str, location);
                 
-                if let Some(code) = &step.snippet {
+                if let Some(code) = step.snippet() {
                     println!("{}    Code: {}", indent, code);
                 }
             }
@@ -319,19 +450,43 @@ fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::Ca
         }
     }
 
+    // ── unreachable: 任何入口都到不了的函式 ──────────
+    if cli.mode == "unreachable" {
+        let mut roots = resolve_entries(callgraph, &detect_entries(cli, files));
+        if roots.is_empty() {
+            roots.extend(callgraph.idx_of(&entry));
+        }
+        let report = UnreachableReport::compute(callgraph, &roots);
+
+        println!(
+            "=== Unreachable: {} of {} functions ({} entry points) ===",
+            report.count(),
+            report.total,
+            report.roots.len()
+        );
+        let mut current_crate = "";
+        for group in &report.groups {
+            if group.crate_name != current_crate {
+                current_crate = &group.crate_name;
+                println!("[{}]", current_crate);
+            }
+            println!("  {} ({})", group.file, group.functions.len());
+            for &f in &group.functions {
+                println!("    {}", callgraph.display_label(f));
+            }
+        }
+        return;
+    }
+
     // ── 4. export (callgraph or flowchart) ────────────────────────
-    let output_path = cli.output.as_ref().unwrap();
+    let output_path = match cli.output.as_ref() {
+        Some(p) => p,
+        None => return, // --snapshot only
+    };
     
     if cli.mode == "flowchart" {
         // Detect entry points
-        let lang = Language::from_str(&cli.lang).unwrap_or(Language::Rust);
-        let detector = EntryPointDetector::new(lang);
-        
-        let mut all_entries = Vec::new();
-        for (_, file_path, content) in files.iter() {
-            let entries = detector.detect(file_path, content);
-            all_entries.extend(entries);
-        }
+        let all_entries = detect_entries(cli, files);
         
         if all_entries.is_empty() {
             eprintln!("Warning: No entry points detected. Flowchart will be empty.");
@@ -349,6 +504,18 @@ fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::Ca
         // Export as flowchart DOT
         FlowchartExporter::export(&flow, output_path).unwrap();
         println!("Flowchart saved to {} ({} nodes, {} edges)", output_path, flow.nodes.len(), flow.edges.len());
+    } else if cli.mode == "shards" {
+        // 每個 crate 一個 shard,加上 manifest 供 GUI 延遲載入
+        match ShardManifest::write(callgraph, std::path::Path::new(output_path)) {
+            Ok(manifest) => println!(
+                "Sharded graph saved to {} ({} shards, {} nodes, {} cross-crate edge groups)",
+                output_path,
+                manifest.shards.len(),
+                manifest.node_count,
+                manifest.cross_edges.len()
+            ),
+            Err(e) => eprintln!("Failed to write shards: {:#}", e),
+        }
     } else {
         // Default: callgraph mode
         let exporter = DotExporter{};
@@ -357,3 +524,42 @@ fn run_post_processing(cli: &Cli, callgraph: &mr_hedgehog::domain::callgraph::Ca
     }
 }
 
+/// Diff two snapshots: print a summary, write the delta if --output is set.
+fn run_diff(cli: &Cli) -> anyhow::Result<()> {
+    let load = |path: &String| GraphSnapshot::load(std::path::Path::new(path));
+    let (old, new) = rayon::join(|| load(&cli.diff[0]), || load(&cli.diff[1]));
+    let (old, new) = (old?, new?);
+
+    let delta = GraphDelta::between(&old.graph, &new.graph);
+    println!(
+        "=== Diff {} -> {}: +{} / -{} nodes, +{} / -{} edges ===",
+        cli.diff[0],
+        cli.diff[1],
+        delta.added_nodes.len(),
+        delta.removed_nodes.len(),
+        delta.added_edges.len(),
+        delta.removed_edges.len()
+    );
+    for (from, to) in &delta.added_edges {
+        println!("  + {} -> {}", from, to);
+    }
+    for (from, to) in &delta.removed_edges {
+        println!("  - {} -> {}", from, to);
+    }
+
+    if let Some(ref path) = cli.output {
+        DeltaExporter::export(&delta, path, DeltaFormat::resolve(cli.format.as_deref(), path)?)?;
+        println!("Delta saved to {}", path);
+    }
+    Ok(())
+}
+
+/// Entry points detected in the loaded sources for `--lang`.
+fn detect_entries(cli: &Cli, files: &[(String, String, String)]) -> Vec<EntryPoint> {
+    let lang = Language::from_str(&cli.lang).unwrap_or(Language::Rust);
+    let detector = EntryPointDetector::new(lang);
+    files
+        .iter()
+        .flat_map(|(_, file_path, content)| detector.detect(file_path, content))
+        .collect()
+}
@@ -0,0 +1,146 @@
+//! Graph Delta Exporter
+//!
+//! Writes a `GraphDelta` as Graphviz DOT (added green, removed red and
+//! dashed, unchanged endpoints grey), as JSON in the daemon's delta shape,
+//! or as bincode for tools that diff snapshots in bulk.
+
+use crate::domain::delta::GraphDelta;
+use anyhow::{Context, Result};
+use serde_json::json;
+use std::collections::BTreeSet;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum DeltaFormat {
+    Dot,
+    Json,
+    Binary,
+}
+
+impl DeltaFormat {
+    /// Parse `dot`, `json` or `bin`; otherwise infer from the output
+    /// file's extension, defaulting to DOT.
+    pub fn resolve(format: Option<&str>, path: &str) -> Result<Self> {
+        let name = match format {
+            Some(f) => f.to_string(),
+            None => std::path::Path::new(path)
+                .extension()
+                .and_then(|e| e.to_str())
+                .unwrap_or("dot")
+                .to_ascii_lowercase(),
+        };
+        match name.as_str() {
+            "dot" | "gv" => Ok(Self::Dot),
+            "json" => Ok(Self::Json),
+            "bin" | "bincode" => Ok(Self::Binary),
+            other if format.is_some() => anyhow::bail!("Unknown delta format: {} (dot, json or bin)", other),
+            _ => Ok(Self::Dot),
+        }
+    }
+}
+
+pub struct DeltaExporter;
+
+impl DeltaExporter {
+    pub fn export(delta: &GraphDelta, path: &str, format: DeltaFormat) -> Result<()> {
+        let bytes = match format {
+            DeltaFormat::Dot => Self::to_dot(delta).into_bytes(),
+            DeltaFormat::Json => serde_json::to_vec_pretty(&Self::to_json(delta))?,
+            DeltaFormat::Binary => bincode::serialize(delta).context("Failed to encode delta")?,
+        };
+        std::fs::write(path, bytes).with_context(|| format!("Failed to write delta: {}", path))
+    }
+
+    /// The delta as DOT. Endpoints of changed edges that were neither added
+    /// nor removed are drawn grey for context.
+    pub fn to_dot(delta: &GraphDelta) -> String {
+        let added: BTreeSet<&str> = delta.added_nodes.iter().map(|(id, _)| id.as_str()).collect();
+        let removed: BTreeSet<&str> = delta.removed_nodes.iter().map(String::as_str).collect();
+        let context: BTreeSet<&str> = delta
+            .added_edges
+            .iter()
+            .chain(&delta.removed_edges)
+            .flat_map(|(a, b)| [a.as_str(), b.as_str()])
+            .filter(|id| !added.contains(id) && !removed.contains(id))
+            .collect();
+
+        let mut lines = vec!["digraph Delta {".to_string()];
+        lines.push("    node [fontname=\"Helvetica\", style=filled];".to_string());
+        for (id, label) in &delta.added_nodes {
+            let label = label.as_deref().unwrap_or(id);
+            lines.push(format!(
+                "    \"{}\" [label=\"{}\", fillcolor=\"#a6e3a1\", color=\"#40a02b\"];",
+                escape(id), escape(label)
+            ));
+        }
+        for id in &removed {
+            lines.push(format!(
+                "    \"{}\" [label=\"{}\", fillcolor=\"#f38ba8\", color=\"#d20f39\", style=\"filled,dashed\"];",
+                escape(id), escape(id)
+            ));
+        }
+        for id in &context {
+            lines.push(format!("    \"{}\" [label=\"{}\", fillcolor=\"#e6e9ef\"];", escape(id), escape(id)));
+        }
+        for (a, b) in &delta.added_edges {
+            lines.push(format!("    \"{}\" -> \"{}\" [color=\"#40a02b\", penwidth=2];", escape(a), escape(b)));
+        }
+        for (a, b) in &delta.removed_edges {
+            lines.push(format!("    \"{}\" -> \"{}\" [color=\"#d20f39\", style=dashed];", escape(a), escape(b)));
+        }
+        lines.push("}".to_string());
+        lines.join("\n")
+    }
+
+    /// The delta in the daemon's `GraphDeltaDto` shape.
+    pub fn to_json(delta: &GraphDelta) -> serde_json::Value {
+        let edges = |edges: &[(String, String)]| -> Vec<serde_json::Value> {
+            edges.iter().map(|(from, to)| json!({ "from": from, "to": to })).collect()
+        };
+        json!({
+            "added_nodes": delta.added_nodes.iter()
+                .map(|(id, label)| json!({ "id": id, "label": label.as_deref().unwrap_or(id) }))
+                .collect::<Vec<_>>(),
+            "removed_nodes": delta.removed_nodes,
+            "added_edges": edges(&delta.added_edges),
+            "removed_edges": edges(&delta.removed_edges),
+        })
+    }
+}
+
+fn escape(s: &str) -> String {
+    s.replace('\\', "\\\\").replace('"', "\\\"")
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn delta() -> GraphDelta {
+        GraphDelta {
+            added_nodes: vec![("bar".to_string(), None)],
+            removed_nodes: vec!["foo".to_string()],
+            added_edges: vec![("main".to_string(), "bar".to_string())],
+            removed_edges: vec![("main".to_string(), "foo".to_string())],
+        }
+    }
+
+    #[test]
+    fn test_dot_styles_added_removed_and_context() {
+        let dot = DeltaExporter::to_dot(&delta());
+        assert!(dot.contains("\"bar\" [label=\"bar\", fillcolor=\"#a6e3a1\""));
+        assert!(dot.contains("\"foo\" [label=\"foo\", fillcolor=\"#f38ba8\""));
+        assert!(dot.contains("\"main\" [label=\"main\", fillcolor=\"#e6e9ef\"]"));
+        assert!(dot.contains("\"main\" -> \"foo\" [color=\"#d20f39\", style=dashed]"));
+    }
+
+    #[test]
+    fn test_format_from_flag_or_extension() {
+        assert_eq!(DeltaFormat::resolve(None, "pr.json").unwrap(), DeltaFormat::Json);
+        assert_eq!(DeltaFormat::resolve(None, "pr.out").unwrap(), DeltaFormat::Dot);
+        assert_eq!(DeltaFormat::resolve(Some("bin"), "pr.dot").unwrap(), DeltaFormat::Binary);
+        assert!(DeltaFormat::resolve(Some("svg"), "pr.svg").is_err());
+
+        let json = DeltaExporter::to_json(&delta());
+        assert_eq!(json["added_edges"][0]["to"], "bar");
+    }
+}
@@ -3,68 +3,86 @@
 //! Exports FlowGraph as Graphviz DOT with flowchart styling.
 
 use crate::domain::flowgraph::{FlowGraph, FlowNodeType};
-use std::io::Result;
+use crate::ports::write_chunked;
+use std::fmt::Write as _;
+use std::fs::File;
+use std::io::{BufWriter, Result, Write};
+
+/// Nodes or edges formatted per parallel task.
+const CHUNK: usize = 1024;
 
 pub struct FlowchartExporter;
 
 impl FlowchartExporter {
     /// Export a FlowGraph to DOT format with flowchart styling.
     pub fn export(flow: &FlowGraph, path: &str) -> Result<()> {
-        let content = Self::to_dot(flow);
-        std::fs::write(path, content)
+        let mut out = BufWriter::new(File::create(path)?);
+        Self::write_dot(flow, &mut out)?;
+        out.flush()
     }
 
     /// Convert FlowGraph to DOT string.
     pub fn to_dot(flow: &FlowGraph) -> String {
-        let mut lines = Vec::new();
+        let mut buf = Vec::new();
+        Self::write_dot(flow, &mut buf).expect("writing to a Vec cannot fail");
+        String::from_utf8(buf).expect("DOT output is UTF-8")
+    }
 
+    /// Stream FlowGraph as DOT into `out`; node and edge lines are
+    /// formatted in parallel chunks and written in order.
+    pub fn write_dot(flow: &FlowGraph, out: &mut dyn Write) -> Result<()> {
         // Graph configuration for flowchart layout
-        lines.push("digraph FlowChart {".to_string());
-        lines.push("    rankdir=TB;".to_string()); // Top to bottom
-        lines.push("    splines=ortho;".to_string()); // Orthogonal edges
-        lines.push("    nodesep=0.8;".to_string());
-        lines.push("    ranksep=1.0;".to_string());
-        lines.push("    node [fontname=\"Helvetica\", fontsize=12];".to_string());
-        lines.push("    edge [fontname=\"Helvetica\", fontsize=10];".to_string());
-        lines.push("".to_string());
+        writeln!(out, "digraph FlowChart {{")?;
+        writeln!(out, "    rankdir=TB;")?; // Top to bottom
+        writeln!(out, "    splines=ortho;")?; // Orthogonal edges
+        writeln!(out, "    nodesep=0.8;")?;
+        writeln!(out, "    ranksep=1.0;")?;
+        writeln!(out, "    node [fontname=\"Helvetica\", fontsize=12];")?;
+        writeln!(out, "    edge [fontname=\"Helvetica\", fontsize=10];")?;
+        writeln!(out)?;
 
         // Node definitions with styling
-        for node in &flow.nodes {
-            let (shape, color, style) = Self::node_style(&node.node_type);
-            let label = Self::escape_label(&node.label);
-            lines.push(format!(
-                "    \"{}\" [label=\"{}\", shape={}, style=\"{}\", fillcolor=\"{}\", color=\"{}\"];",
-                node.id, label, shape, style, color, Self::border_color(&node.node_type)
-            ));
-        }
+        write_chunked(out, flow.nodes.len(), CHUNK, |range, buf| {
+            for node in &flow.nodes[range] {
+                let (shape, color, style) = Self::node_style(&node.node_type);
+                let _ = writeln!(
+                    buf,
+                    "    \"{}\" [label=\"{}\", shape={}, style=\"{}\", fillcolor=\"{}\", color=\"{}\"];",
+                    node.id, Self::escape_label(&node.label), shape, style, color, Self::border_color(&node.node_type)
+                );
+            }
+        })?;
 
-        lines.push("".to_string());
+        writeln!(out)?;
 
         // Edge definitions with sequence numbers
-        for edge in &flow.edges {
-            let label = edge
-                .label
-                .as_ref()
-                .map(|l| format!(" [{}]", l))
-                .unwrap_or_default();
-            lines.push(format!(
-                "    \"{}\" -> \"{}\" [label=\"{}{}\"];",
-                edge.from, edge.to, edge.sequence, label
-            ));
-        }
+        write_chunked(out, flow.edges.len(), CHUNK, |range, buf| {
+            for edge in &flow.edges[range] {
+                let label = edge
+                    .label
+                    .as_ref()
+                    .map(|l| format!(" [{}]", l))
+                    .unwrap_or_default();
+                let _ = writeln!(
+                    buf,
+                    "    \"{}\" -> \"{}\" [label=\"{}{}\"];",
+                    edge.from, edge.to, edge.sequence, label
+                );
+            }
+        })?;
 
         // Group nodes by depth for layered layout
-        let layers = flow.nodes_by_depth();
-        for (depth, layer) in layers.iter().enumerate() {
+        for layer in flow.nodes_by_depth() {
             if !layer.is_empty() {
-                let node_ids: Vec<String> = layer.iter().map(|n| format!("\"{}\"", n.id)).collect();
-                lines.push(format!("    {{ rank=same; {} }}", node_ids.join("; ")));
+                write!(out, "    {{ rank=same;")?;
+                for (i, n) in layer.iter().enumerate() {
+                    write!(out, "{} \"{}\"", if i == 0 { "" } else { ";" }, n.id)?;
+                }
+                writeln!(out, " }}")?;
             }
         }
 
-        lines.push("}".to_string());
-
-        lines.join("\n")
+        writeln!(out, "}}")
     }
 
     fn node_style(node_type: &FlowNodeType) -> (&'static str, &'static str, &'static str) {
@@ -1,11 +1,72 @@
 use crate::domain::callgraph::CallGraph;
+use rayon::prelude::*;
+use std::fs::File;
+use std::io::{BufWriter, Write};
+use std::ops::Range;
 
 pub mod flowchart_exporter;
+pub mod delta_exporter;
 
 pub trait CallGraphBuilder {
     fn build_call_graph(&self, sources: &[(String, String, String)]) -> CallGraph;
 }
 
 pub trait OutputExporter {
-    fn export(&self, cg: &CallGraph, path: &str) -> std::io::Result<()>;
+    /// Stream `cg` into `out` (a file, a socket, a buffer).
+    fn write(&self, cg: &CallGraph, out: &mut dyn Write) -> std::io::Result<()>;
+
+    fn export(&self, cg: &CallGraph, path: &str) -> std::io::Result<()> {
+        let mut out = BufWriter::new(File::create(path)?);
+        self.write(cg, &mut out)?;
+        out.flush()
+    }
+}
+
+/// Format items `0..len` in chunks of `chunk` on the thread pool and write
+/// the pieces to `out` in order. Only one batch of formatted chunks (a few
+/// per thread) is held at a time, so memory stays flat however large the
+/// output grows.
+pub fn write_chunked<F>(out: &mut dyn Write, len: usize, chunk: usize, format: F) -> std::io::Result<()>
+where
+    F: Fn(Range<usize>, &mut String) + Sync,
+{
+    let batch = chunk * rayon::current_num_threads().max(1) * 4;
+    let mut start = 0;
+    while start < len {
+        let end = (start + batch).min(len);
+        let pieces: Vec<String> = (start..end)
+            .step_by(chunk)
+            .collect::<Vec<_>>()
+            .into_par_iter()
+            .map(|lo| {
+                let mut buf = String::new();
+                format(lo..(lo + chunk).min(end), &mut buf);
+                buf
+            })
+            .collect();
+        for piece in &pieces {
+            out.write_all(piece.as_bytes())?;
+        }
+        start = end;
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_chunked_output_keeps_order() {
+        let mut out = Vec::new();
+        write_chunked(&mut out, 10_000, 7, |range, buf| {
+            for i in range {
+                buf.push_str(&format!("{}\n", i));
+            }
+        })
+        .unwrap();
+
+        let expected: String = (0..10_000).map(|i| format!("{}\n", i)).collect();
+        assert_eq!(String::from_utf8(out).unwrap(), expected);
+    }
 }
@@ -67,13 +67,13 @@ fn test_enclosing_range_basic() {
     let graph = result.unwrap();
 
     // Assert: main node should have target as callee
-    let main_node = graph.nodes.iter().find(|n| n.id == "pkg::main");
+    let main_node = graph.idx_of("pkg::main");
     assert!(main_node.is_some(), "main node not found");
     
-    let main_node = main_node.unwrap();
+    let callees = graph.callees_of("pkg::main");
     assert!(
-        main_node.callees.contains(&"pkg::target".to_string()),
-        "main should call target. Callees: {:?}", main_node.callees
+        callees.contains(&"pkg::target"),
+        "main should call target. Callees: {:?}", callees
     );
 }
 
@@ -100,14 +100,14 @@ fn test_reference_outside_function_ignored() {
     assert!(result.is_ok());
 
     let graph = result.unwrap();
-    let main_node = graph.nodes.iter().find(|n| n.id == "pkg::main");
+    let main_node = graph.idx_of("pkg::main");
     assert!(main_node.is_some());
     
     // The reference at line 5 should NOT be linked to main (it's before main starts)
-    let main_node = main_node.unwrap();
+    let callees = graph.callees_of("pkg::main");
     assert!(
-        !main_node.callees.contains(&"pkg::global_const".to_string()),
-        "main should NOT call global_const (reference is outside). Callees: {:?}", main_node.callees
+        !callees.contains(&"pkg::global_const"),
+        "main should NOT call global_const (reference is outside). Callees: {:?}", callees
     );
 }
 
@@ -137,14 +137,18 @@ fn test_nested_functions() {
 
     let graph = result.unwrap();
     
-    // The call at line 20 is inside both outer and inner.
-    // Our algorithm should find the SMALLEST enclosing range (inner).
-    // But currently we sort by LARGEST first and break on first match.
-    // This means outer will match first. This is a known limitation.
-    // For now, we just verify SOME caller is linked.
-    
-    let has_edge = graph.nodes.iter().any(|n| n.callees.contains(&"pkg::target".to_string()));
-    assert!(has_edge, "Expected at least one caller to target");
+    // The call at line 20 is inside both outer and inner; the innermost
+    // enclosing definition (inner) is the caller.
+    let inner_callees = graph.callees_of("pkg::inner");
+    assert!(
+        inner_callees.contains(&"pkg::target"),
+        "inner should call target. Callees: {:?}", inner_callees
+    );
+    let outer_callees = graph.callees_of("pkg::outer");
+    assert!(
+        !outer_callees.contains(&"pkg::target"),
+        "outer should NOT call target directly. Callees: {:?}", outer_callees
+    );
 }
 
 #[test]
@@ -170,11 +174,11 @@ fn test_self_reference_ignored() {
     assert!(result.is_ok());
 
     let graph = result.unwrap();
-    let main_node = graph.nodes.iter().find(|n| n.id == "pkg::main").unwrap();
+    assert!(graph.idx_of("pkg::main").is_some());
     
     // Self-references should be filtered out
     assert!(
-        !main_node.callees.contains(&"pkg::main".to_string()),
+        !graph.callees_of("pkg::main").contains(&"pkg::main"),
         "Self-references should be ignored"
     );
 }
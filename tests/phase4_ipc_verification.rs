@@ -51,7 +51,23 @@ fn test_ipc_server_lifecycle() {
     assert!(response.contains("error"));
     assert!(response.contains("Workspace path not found"));
 
-    // 5. Send SHUTDOWN
+    // 5. Send NEIGHBORS for a workspace that exists but was never analyzed.
+    // Interactive queries must answer immediately instead of starting an index run.
+    let neighbors_cmd = format!(
+        r#"{{"command": "NEIGHBORS", "params": {{"path": "{}", "id": "main"}}}}"#,
+        env!("CARGO_MANIFEST_DIR")
+    );
+    stream.write_all(neighbors_cmd.as_bytes()).unwrap();
+    stream.write_all(b"\n").unwrap();
+
+    response.clear();
+    reader.read_line(&mut response).unwrap();
+    println!("Response: {}", response);
+
+    assert!(response.contains("error"));
+    assert!(response.contains("not analyzed"));
+
+    // 6. Send SHUTDOWN
     // Note: SHUTDOWN triggers process exit, which kills the test process if running in same process space!
     // However, cargo test harness runs tests in threads. If server calls std::process::exit(0),
     // it will exit the ENTIRE test runner.
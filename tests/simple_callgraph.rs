@@ -19,7 +19,7 @@ fn node_ids_include_crate_names() {
 
     let builder = SimpleCallGraphBuilder::new();
     let cg = builder.build_call_graph(&sources);
-    let mut ids: Vec<String> = cg.nodes.iter().map(|n| n.id.clone()).collect();
+    let mut ids: Vec<String> = cg.nodes().map(|n| cg.id(n).to_string()).collect();
     ids.sort();
 
     assert!(ids.contains(&"crate_one::foo".to_string()), "Expected foo, found: {:?}", ids);